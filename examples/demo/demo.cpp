@@ -111,6 +111,8 @@ namespace animgui {
             layout.newline();
             text(layout, std::pmr::string{ "emit time " + std::to_string(static_cast<float>(m_statistics.emit_time) / 1000.0f) });
             layout.newline();
+            text(layout, std::pmr::string{ "cull time " + std::to_string(static_cast<float>(m_statistics.cull_time) / 1000.0f) });
+            layout.newline();
             text(layout,
                  std::pmr::string{ "fallback time " + std::to_string(static_cast<float>(m_statistics.fallback_time) / 1000.0f) });
             layout.newline();
@@ -120,10 +122,31 @@ namespace animgui {
             text(layout,
                  std::pmr::string{ "render time " + std::to_string(static_cast<float>(m_statistics.render_time) / 1000.0f) });
             layout.newline();
+            text(layout,
+                 std::pmr::string{ "upload time " + std::to_string(static_cast<float>(m_statistics.upload_time) / 1000.0f) });
+            layout.newline();
+            text(layout,
+                 std::pmr::string{ "input latency " +
+                                   std::to_string(static_cast<float>(m_statistics.input_latency) / 1000.0f) });
+            layout.newline();
+            text(layout,
+                 std::pmr::string{ "render latency " +
+                                   std::to_string(static_cast<float>(m_statistics.render_latency) / 1000.0f) });
+            layout.newline();
+            text(layout,
+                 std::pmr::string{ "latency p50/p99/max " +
+                                   std::to_string(static_cast<float>(m_statistics.latency_p50) / 1000.0f) + "/" +
+                                   std::to_string(static_cast<float>(m_statistics.latency_p99) / 1000.0f) + "/" +
+                                   std::to_string(static_cast<float>(m_statistics.latency_max) / 1000.0f) });
+            layout.newline();
             text(layout, std::pmr::string{ "generated operation " + std::to_string(m_statistics.generated_operation) });
             layout.newline();
             text(layout, std::pmr::string{ "emitted draw call " + std::to_string(m_statistics.emitted_draw_call) });
             layout.newline();
+            text(layout, std::pmr::string{ "culled vertex " + std::to_string(m_statistics.culled_vertex) });
+            layout.newline();
+            text(layout, std::pmr::string{ "culled pixel " + std::to_string(m_statistics.culled_pixel) });
+            layout.newline();
             text(layout, std::pmr::string{ "transformed draw call " + std::to_string(m_statistics.transformed_draw_call) });
             layout.newline();
             text(layout, std::pmr::string{ "optimized draw call " + std::to_string(m_statistics.optimized_draw_call) });
@@ -5,6 +5,7 @@
 #include <GLFW/glfw3.h>
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
+#include <algorithm>
 #include <animgui/backends/d3d11.hpp>
 #include <animgui/backends/glfw3.hpp>
 #include <animgui/backends/stbfont.hpp>
@@ -116,7 +117,8 @@ int main() {
             }
 
             const auto current = glfwGetTime();
-            const auto delta_t = static_cast<float>(current - last);
+            // a frame resumed from the idle mode should not skip the animations started by its input
+            const auto delta_t = static_cast<float>(std::min(current - last, 1.0 / 30.0));
             last = current;
 
             int window_w, window_h;
@@ -134,9 +136,13 @@ int main() {
             d3d11_backend->emit(animgui::uvec2{ static_cast<uint32_t>(w), static_cast<uint32_t>(h) });
 
             check_d3d11_error(swap_chain->Present(0, 0));
+            ctx->frame_presented();
         };
 
         while(!glfwWindowShouldClose(window)) {
+            // sleep until there is something to draw
+            if(!ctx->wait_for_work(1.0))
+                continue;
             glfw3_backend->new_frame();
             draw();
         }
@@ -5,6 +5,7 @@
 #include <GLFW/glfw3.h>
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
+#include <algorithm>
 #include <animgui/backends/d3d12.hpp>
 #include <animgui/backends/glfw3.hpp>
 #include <animgui/backends/stbfont.hpp>
@@ -208,7 +209,8 @@ int main() {
             }
 
             const auto current = glfwGetTime();
-            const auto delta_t = static_cast<float>(current - last);
+            // a frame resumed from the idle mode should not skip the animations started by its input
+            const auto delta_t = static_cast<float>(std::min(current - last, 1.0 / 30.0));
             last = current;
 
             int window_w, window_h;
@@ -257,9 +259,13 @@ int main() {
             check_d3d12_error(command_queue->Signal(fence, fence_count));
 
             check_d3d12_error(swap_chain->Present(0, 0));
+            ctx->frame_presented();
         };
 
         while(!glfwWindowShouldClose(window)) {
+            // sleep until there is something to draw
+            if(!ctx->wait_for_work(1.0))
+                continue;
             glfw3_backend->new_frame();
             draw();
         }
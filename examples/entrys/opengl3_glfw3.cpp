@@ -3,6 +3,7 @@
 #include "../application.hpp"
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <animgui/backends/glfw3.hpp>
 #include <animgui/backends/opengl3.hpp>
 #include <animgui/backends/stbfont.hpp>
@@ -170,7 +171,8 @@ int main() {
                 return;
 
             const auto current = glfwGetTime();
-            const auto delta_t = static_cast<float>(current - last);
+            // a frame resumed from the idle mode should not skip the animations started by its input
+            const auto delta_t = static_cast<float>(std::min(current - last, 1.0 / 30.0));
             last = current;
 
             int window_w, window_h;
@@ -185,9 +187,13 @@ int main() {
 
             ogl3_backend->emit(animgui::uvec2{ static_cast<uint32_t>(w), static_cast<uint32_t>(h) });
             glfwSwapBuffers(window);
+            ctx->frame_presented();
         };
 
         while(!glfwWindowShouldClose(window)) {
+            // sleep until there is something to draw
+            if(!ctx->wait_for_work(1.0))
+                continue;
             glfw3_backend->new_frame();
             draw();
         }
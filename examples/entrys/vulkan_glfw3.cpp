@@ -5,6 +5,7 @@
 #define GLFW_INCLUDE_NONE
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <animgui/backends/glfw3.hpp>
 #include <animgui/backends/stbfont.hpp>
 #include <animgui/builtins/animators.hpp>
@@ -197,9 +198,11 @@ int main() {
 
         std::function<void()> draw;
         const auto glfw3_backend = animgui::create_glfw3_backend(window, draw);
+        // new_frame is called before waiting for the fence of the frame, so one more frame may still be in flight
         const auto vulkan_backend =
-            animgui::create_vulkan_backend(physical_device, device.get(), render_pass.get(), current_command_buffer, sample_count,
-                                           sample_shading, transferer, check_vulkan_result);
+            animgui::create_vulkan_backend(physical_device, device.get(), render_pass.get(), current_command_buffer,
+                                           max_frames_in_flight + 1, sample_count, sample_shading, transferer,
+                                           check_vulkan_result);
         const auto stb_font_backend = animgui::create_stb_font_backend(8.0f);
         const auto animator = animgui::create_dummy_animator();
         const auto emitter = animgui::create_builtin_emitter(memory_resource);
@@ -363,7 +366,8 @@ int main() {
             }
 
             const auto current = glfwGetTime();
-            const auto delta_t = static_cast<float>(current - last);
+            // a frame resumed from the idle mode should not skip the animations started by its input
+            const auto delta_t = static_cast<float>(std::min(current - last, 1.0 / 30.0));
             last = current;
 
             int window_w, window_h;
@@ -417,10 +421,14 @@ int main() {
                 // reset_swap_chain(w, h);
                 return;
             }
+            ctx->frame_presented();
             current_idx = (current_idx + 1) % max_frames_in_flight;
         };
 
         while(!glfwWindowShouldClose(window)) {
+            // sleep until there is something to draw
+            if(!ctx->wait_for_work(1.0))
+                continue;
             glfw3_backend->new_frame();
             draw();
         }
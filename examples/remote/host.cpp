@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT
+
+#include "../application.hpp"
+#include <animgui/backends/stbfont.hpp>
+#include <animgui/builtins/animators.hpp>
+#include <animgui/builtins/command_optimizers.hpp>
+#include <animgui/builtins/emitters.hpp>
+#include <animgui/builtins/frame_capture.hpp>
+#include <animgui/builtins/image_compactors.hpp>
+#include <animgui/builtins/input_replay.hpp>
+#include <animgui/builtins/remote.hpp>
+#include <animgui/core/context.hpp>
+#include <animgui/core/render_backend.hpp>
+#include <iostream>
+
+// Runs the demo without a window and streams it to remote_viewer.
+int main(const int argc, const char** argv) {
+    const std::pmr::string address = argc > 1 ? argv[1] : "0.0.0.0:7000";
+    std::cout << "waiting for a viewer on " << address << std::endl;
+    const auto stream = animgui::accept_remote_viewer(address);
+
+    std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource();
+    const auto null_backend = animgui::create_null_render_backend();
+    // the writer goes first, the viewer waits for its header
+    const auto capture_backend = animgui::create_capture_render_backend(*null_backend, *stream);
+    const auto input_player = animgui::create_input_player(*stream);
+    const auto stb_font_backend = animgui::create_stb_font_backend(8.0f);
+    const auto animator = animgui::create_dummy_animator();
+    const auto emitter = animgui::create_builtin_emitter(memory_resource);
+    const auto command_optimizer = animgui::create_builtin_command_optimizer();
+    const auto image_compactor = animgui::create_builtin_image_compactor(*capture_backend, memory_resource);
+    auto ctx = animgui::create_animgui_context(*input_player, *capture_backend, *stb_font_backend, *emitter, *animator,
+                                               *command_optimizer, *image_compactor, memory_resource);
+    const auto app = animgui::create_demo_application(*ctx);
+
+    // the viewer sends one input frame and waits for exactly one frame back
+    while(true) {
+        input_player->new_frame();
+        if(input_player->finished())
+            break;
+        const auto [width, height] = input_player->window_size();
+        ctx->new_frame(width, height, input_player->delta_t(), [&](animgui::canvas& canvas_root) { app->render(canvas_root); });
+        capture_backend->emit(input_player->framebuffer_size());
+    }
+    std::cout << "viewer disconnected" << std::endl;
+    return 0;
+}
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: MIT
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <animgui/backends/glfw3.hpp>
+#include <animgui/backends/opengl3.hpp>
+#include <animgui/builtins/command_optimizers.hpp>
+#include <animgui/builtins/frame_capture.hpp>
+#include <animgui/builtins/input_replay.hpp>
+#include <animgui/builtins/remote.hpp>
+#include <animgui/core/command_optimizer.hpp>
+#include <animgui/core/render_backend.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+[[noreturn]] void fail(const std::string& str) {
+    std::cout << str << std::endl;
+    std::_Exit(EXIT_FAILURE);
+}
+
+// Shows an application running in remote_host. Any local render backend works the same way.
+int main(const int argc, const char** argv) {
+    const std::pmr::string address = argc > 1 ? argv[1] : "127.0.0.1:7000";
+
+    glfwSetErrorCallback([](const int id, const char* error) { fail("[GLFW:" + std::to_string(id) + "] " + error); });
+    if(!glfwInit())
+        fail("Failed to initialize glfw");
+
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    glfwWindowHint(GLFW_DECORATED, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_DEPTH_BITS, GL_FALSE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef ANIMGUI_MACOS
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+#endif
+    glfwWindowHint(GLFW_DOUBLEBUFFER, GLFW_TRUE);
+    glfwWindowHint(GLFW_SAMPLES, 8);
+
+    const int width = 1024, height = 768;
+    GLFWwindow* const window = glfwCreateWindow(width, height, "Animgui remote viewer", nullptr, nullptr);
+    glfwMakeContextCurrent(window);
+
+    if(glewInit() != GLEW_OK)
+        fail("Failed to initialize glew");
+
+    {
+        // frames are only drawn in the main loop, the host decides what to draw
+        const std::function<void()> redraw = [] {};
+        const auto glfw3_backend = animgui::create_glfw3_backend(window, redraw);
+        const auto ogl3_backend = animgui::create_opengl3_backend();
+        const auto stream = animgui::connect_remote_host(address);
+        // the writer goes first, the host waits for its header
+        const auto input_streamer = animgui::create_input_streamer(*glfw3_backend, *stream);
+        const auto command_optimizer = animgui::create_noop_command_optimizer();
+        const auto frame_player = animgui::create_frame_player(*stream, *ogl3_backend, *command_optimizer);
+
+        // one round trip per frame, paced by the display
+        glfwSwapInterval(1);
+
+        bool connected = true;
+        while(connected && !glfwWindowShouldClose(window)) {
+            int w, h;
+            glfwGetFramebufferSize(window, &w, &h);
+            if(w == 0 || h == 0) {
+                glfw3_backend->wait_events(0.1);
+                continue;
+            }
+            int window_w, window_h;
+            glfwGetWindowSize(window, &window_w, &window_h);
+
+            input_streamer->set_viewport(animgui::uvec2{ static_cast<uint32_t>(window_w), static_cast<uint32_t>(window_h) },
+                                         animgui::uvec2{ static_cast<uint32_t>(w), static_cast<uint32_t>(h) });
+            input_streamer->new_frame();
+
+            glViewport(0, 0, w, h);
+            glScissor(0, 0, w, h);
+            glClearColor(0, 0, 0, 1);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            connected = frame_player->replay_frame();
+            glfwSwapBuffers(window);
+        }
+    }
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <animgui/builtins/command_optimizers.hpp>
+#include <animgui/builtins/frame_capture.hpp>
+#include <animgui/core/command_optimizer.hpp>
+#include <animgui/core/render_backend.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+// Replays a frame capture into the null render backend and reports how long each frame takes to decode, translate and
+// optimize. Pass --builtin-optimizer to time the builtin command optimizer instead of the noop one.
+int main(const int argc, const char** argv) {
+    const char* path = nullptr;
+    bool builtin_optimizer = false;
+    for(int idx = 1; idx < argc; ++idx) {
+        if(std::string_view{ argv[idx] } == "--builtin-optimizer")
+            builtin_optimizer = true;
+        else
+            path = argv[idx];
+    }
+    if(!path) {
+        std::puts("usage: replay <capture file> [--builtin-optimizer]");
+        return EXIT_FAILURE;
+    }
+    std::ifstream stream{ path, std::ios::in | std::ios::binary };
+    if(!stream) {
+        std::printf("failed to open %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    const auto null_backend = animgui::create_null_render_backend();
+    const auto command_optimizer =
+        builtin_optimizer ? animgui::create_builtin_command_optimizer() : animgui::create_noop_command_optimizer();
+    const auto frame_player = animgui::create_frame_player(stream, *null_backend, *command_optimizer);
+
+    std::vector<double> frame_times;
+    while(true) {
+        const auto start = std::chrono::steady_clock::now();
+        if(!frame_player->replay_frame())
+            break;
+        frame_times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    if(frame_times.empty()) {
+        std::puts("no frames");
+        return EXIT_FAILURE;
+    }
+
+    double total = 0.0;
+    for(const auto time : frame_times)
+        total += time;
+    std::sort(frame_times.begin(), frame_times.end());
+    const auto percentile = [&](const double ratio) {
+        const auto idx = static_cast<size_t>(ratio * static_cast<double>(frame_times.size()));
+        return frame_times[std::min(frame_times.size() - 1, idx)];
+    };
+    const auto [width, height] = frame_player->screen_size();
+    std::printf("%zu frames at %ux%u, total %.2f ms\n", frame_times.size(), width, height, total);
+    std::printf("mean %.3f ms, p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+                total / static_cast<double>(frame_times.size()), percentile(0.5), percentile(0.9), percentile(0.99),
+                frame_times.back());
+    return EXIT_SUCCESS;
+}
@@ -12,6 +12,7 @@ namespace animgui {
 
     ANIMGUI_API std::shared_ptr<render_backend>
     create_vulkan_backend(vk::PhysicalDevice& physical_device, vk::Device& device, vk::RenderPass& render_pass,
-                          vk::CommandBuffer& command_buffer, vk::SampleCountFlagBits sample_count, float sample_shading,
-                          synchronized_executor synchronized_transfer, std::function<void(vk::Result)> error_report);
+                          vk::CommandBuffer& command_buffer, uint32_t frames_in_flight, vk::SampleCountFlagBits sample_count,
+                          float sample_shading, synchronized_executor synchronized_transfer,
+                          std::function<void(vk::Result)> error_report);
 }  // namespace animgui
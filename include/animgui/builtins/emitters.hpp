@@ -9,4 +9,8 @@ namespace animgui {
     class emitter;
 
     ANIMGUI_API std::shared_ptr<emitter> create_builtin_emitter(std::pmr::memory_resource* memory_resource);
+    // Emits chunks of the operation stream on thread_count threads (including the calling thread), 0 means one thread per core.
+    // Extended callbacks may be invoked concurrently.
+    ANIMGUI_API std::shared_ptr<emitter> create_parallel_emitter(std::pmr::memory_resource* memory_resource,
+                                                                 uint32_t thread_count = 0);
 }  // namespace animgui
@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <animgui/core/common.hpp>
+#include <iosfwd>
+#include <memory>
+
+namespace animgui {
+    class render_backend;
+    class command_optimizer;
+
+    class frame_player {
+    public:
+        frame_player() = default;
+        frame_player(const frame_player&) = delete;
+        frame_player(frame_player&&) = default;
+        frame_player& operator=(const frame_player&) = delete;
+        frame_player& operator=(frame_player&&) = default;
+        virtual ~frame_player() = default;
+
+        // Replays the texture operations and command lists of the next captured frame and emits it. Returns false at the
+        // end of the capture.
+        virtual bool replay_frame() = 0;
+        [[nodiscard]] virtual uvec2 screen_size() const noexcept = 0;
+    };
+
+    // Forwards everything to backend and appends the texture operations and command lists to stream (opened in binary mode),
+    // one frame per emit. Textures must be created through the returned backend, and stream must outlive it.
+    ANIMGUI_API std::shared_ptr<render_backend> create_capture_render_backend(render_backend& backend, std::ostream& stream);
+    // Accepts everything and draws nothing, for timing the rest of the pipeline.
+    ANIMGUI_API std::shared_ptr<render_backend> create_null_render_backend();
+    // Primitives which backend or command_optimizer don't support are expanded into triangles, then command lists are passed
+    // through command_optimizer before they reach backend.
+    ANIMGUI_API std::shared_ptr<frame_player> create_frame_player(std::istream& stream, render_backend& backend,
+                                                                  const command_optimizer& command_optimizer);
+}  // namespace animgui
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <animgui/core/input_backend.hpp>
+#include <iosfwd>
+#include <memory>
+
+namespace animgui {
+    class input_recorder : public input_backend {
+    public:
+        // Recorded with the next frame, as the recorder cannot query the window.
+        virtual void set_viewport(uvec2 window_size, uvec2 framebuffer_size) = 0;
+    };
+
+    // Plays back a log written by the input recorder. Window operations are ignored, so no window is needed.
+    class input_player : public input_backend {
+    public:
+        // delta_t recorded for the current frame, in seconds
+        [[nodiscard]] virtual float delta_t() const noexcept = 0;
+        // whether the last new_frame has run out of recorded frames
+        [[nodiscard]] virtual bool finished() const noexcept = 0;
+        // the last values passed to input_recorder::set_viewport
+        [[nodiscard]] virtual uvec2 window_size() const noexcept = 0;
+        [[nodiscard]] virtual uvec2 framebuffer_size() const noexcept = 0;
+    };
+
+    // Forwards everything to input and appends the input state of every frame to stream (opened in binary mode). The delta_t
+    // of a frame is the time between two new_frame calls. The log uses the native byte order.
+    ANIMGUI_API std::shared_ptr<input_recorder> create_input_recorder(input_backend& input, std::ostream& stream);
+    // Like the recorder, but every frame is written and flushed as soon as it begins, so that a player on the other end of
+    // a socket can follow. Clipboard reads are not recorded.
+    ANIMGUI_API std::shared_ptr<input_recorder> create_input_streamer(input_backend& input, std::ostream& stream);
+    ANIMGUI_API std::shared_ptr<input_player> create_input_player(std::istream& stream);
+}  // namespace animgui
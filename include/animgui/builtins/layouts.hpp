@@ -6,6 +6,8 @@
 #include <optional>
 
 namespace animgui {
+    class table_view;
+
     class layout_proxy : public canvas {
     protected:
         canvas& m_parent;
@@ -22,9 +24,15 @@ namespace animgui {
         std::pair<size_t, identifier> push_region(identifier uid, const std::optional<bounds_aabb>& reserved_bounds) override;
         std::pair<size_t, identifier> add_primitive(identifier uid, primitive primitive) override;
         float step(identifier id, float dest) final;
+        vec2 step(identifier id, vec2 dest) final;
+        color_rgba step(identifier id, const color_rgba& dest) final;
+        void request_redraw(float delay) final;
         [[nodiscard]] const style& global_style() const noexcept final;
         [[nodiscard]] vec2 calculate_bounds(const primitive& primitive) const final;
         span<operation> commands() noexcept final;
+        void reorder(span<const operation_segment> order) final;
+        texture_region render_offscreen(vec2 size, std::shared_ptr<texture> target,
+                                        const std::function<void(canvas&)>& render_function) final;
         [[nodiscard]] bool hovered(const bounds_aabb& bounds) const override;
         [[nodiscard]] std::pmr::memory_resource* memory_resource() const noexcept final;
         identifier region_sub_uid() override;
@@ -80,6 +88,10 @@ namespace animgui {
         virtual void focus_window(identifier id) = 0;
     };
     ANIMGUI_API void multiple_window(canvas& parent, const std::function<void(multiple_window_canvas&)>& render_function);
+    // Windows docked into panes of a split tree, which is kept in the canvas state and only laid out again when a splitter
+    // moves or a window docks or undocks. A pane shows its windows as tabs and only renders the active one. Dragging a tab out
+    // of the tab bar undocks its window, and dropping a floating window onto the markers in the middle of a pane docks it
+    // beside the pane or as a tab of it. New windows are docked as tabs of the first pane.
     ANIMGUI_API void docking(canvas& parent, const std::function<void(multiple_window_canvas&)>& render_function);
 
     enum class scroll_attributes : uint32_t {
@@ -91,6 +103,21 @@ namespace animgui {
 
     ANIMGUI_API void panel(canvas& parent, vec2 size, scroll_attributes scroll,
                            const std::function<vec2(canvas&)>& render_function);
+    // A vertically scrolled panel of item_count rows which only calls render_function for the rows in view and a few rows
+    // around them, so the cost of a frame does not depend on item_count.
+    ANIMGUI_API void virtual_list(canvas& parent, vec2 size, size_t item_count, float item_height,
+                                  const std::function<void(canvas&, size_t)>& render_function);
+    // Rows of variable height. estimate_height is called once for each new row, render_function returns the height the row
+    // actually used, which replaces the estimate. Rows are kept by index, so when item_count changes only the rows at the end
+    // are added or removed and the measured heights of the others are kept.
+    ANIMGUI_API void virtual_list(canvas& parent, vec2 size, size_t item_count,
+                                  const std::function<float(size_t)>& estimate_height,
+                                  const std::function<float(canvas&, size_t)>& render_function);
+    // Renders the content into an offscreen texture filling the reserved size, then draws it as a single image while deps, the
+    // size and the global style are unchanged. render_function is not called while the layer is cached, so the content
+    // should be static. If the render backend does not support offscreen rendering, the content is drawn directly.
+    ANIMGUI_API void cached_layer(canvas& parent, identifier uid, size_t deps,
+                                  const std::function<void(canvas&)>& render_function);
 
     class tab_canvas : public layout_proxy {
     public:
@@ -109,11 +136,41 @@ namespace animgui {
     class table_canvas : public layout_proxy {
     public:
         explicit table_canvas(canvas& parent) noexcept : layout_proxy{ parent } {}
+        // moves to the next cell, a row ends after the last column
         virtual void next_item() = 0;
     };
     // TODO: complex header
-    ANIMGUI_API void table(canvas& parent, const std::pmr::vector<row_alignment>& columns,
+    // The regions added between two next_item calls form a cell, aligned by the row_alignment of its column. Each column is
+    // as wide as its widest cell. Returns the size of the table.
+    ANIMGUI_API vec2 table(canvas& parent, const std::pmr::vector<row_alignment>& columns,
                            const std::function<void(table_canvas&)>& render_function);
-    ANIMGUI_API void tree(canvas& parent, const std::function<void(canvas&)>& render_function);
+    // A scrolled table of row_count rows which, like virtual_list, only calls render_function for the rows in view. The column
+    // widths are cached and grow to fit the rendered cells, so that they do not jitter while scrolling.
+    ANIMGUI_API void table(canvas& parent, vec2 size, const std::pmr::vector<row_alignment>& columns, size_t row_count,
+                           float row_height, const std::function<void(table_canvas&, size_t)>& render_function);
+    // Shows the rows of view, render_function receives the data row. Finished jobs of view are applied at the beginning of the
+    // frame, and the widget state of a row follows its data row when the order changes.
+    ANIMGUI_API void table(canvas& parent, vec2 size, const std::pmr::vector<row_alignment>& columns, table_view& view,
+                           float row_height, const std::function<void(table_canvas&, size_t)>& render_function);
+
+    // A hierarchy of nodes identified by keys which stay the same while a node exists, such as inode numbers or pointers.
+    class tree_source {
+    public:
+        tree_source() = default;
+        virtual ~tree_source() = default;
+        tree_source(const tree_source& rhs) = delete;
+        tree_source(tree_source&& rhs) = default;
+        tree_source& operator=(const tree_source& rhs) = delete;
+        tree_source& operator=(tree_source&& rhs) = default;
+
+        [[nodiscard]] virtual size_t child_count(uint64_t node) = 0;
+        [[nodiscard]] virtual uint64_t child(uint64_t node, size_t idx) = 0;
+    };
+    // A vertically scrolled tree of the descendants of root, in rows of row_height. Like virtual_list, only the rows in view
+    // are rendered and source is only asked about them and the expanded nodes, so collapsed subtrees are never visited and
+    // expanding a node costs the same whatever the number of its children. render_function receives the key and the depth of
+    // the node, next to a toggle which expands or collapses it.
+    ANIMGUI_API void tree(canvas& parent, vec2 size, tree_source& source, uint64_t root, float row_height,
+                          const std::function<void(canvas&, uint64_t, size_t)>& render_function);
 
 }  // namespace animgui
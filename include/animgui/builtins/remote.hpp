@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <animgui/core/common.hpp>
+#include <iosfwd>
+#include <memory>
+
+namespace animgui {
+    // Byte streams for running an application on one machine and viewing it on another. The host renders through a capture
+    // backend and reads input from an input player on the stream, the viewer replays the frames with a frame player and
+    // sends its input with an input streamer. Both ends must create their writer before their reader.
+    //
+    // address is "host:port" for TCP or "unix:path" for a Unix domain socket (not available on Windows).
+
+    // Listens on address and blocks until a viewer connects.
+    ANIMGUI_API std::shared_ptr<std::iostream> accept_remote_viewer(const std::pmr::string& address);
+    ANIMGUI_API std::shared_ptr<std::iostream> connect_remote_host(const std::pmr::string& address);
+}  // namespace animgui
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <animgui/core/common.hpp>
+#include <functional>
+#include <memory>
+
+namespace animgui {
+    // Maps the rows of a table to data rows, filtered and sorted on background threads. Changes start a new job and return at
+    // once; the result replaces rows() in the next poll, so the table keeps showing the previous order until it is ready.
+    // The predicate and the comparator run concurrently on the worker threads and may only read data which the application
+    // leaves untouched until the job has finished (see busy).
+    class table_view {
+    public:
+        table_view() = default;
+        virtual ~table_view() = default;
+        table_view(const table_view& rhs) = delete;
+        table_view(table_view&& rhs) = default;
+        table_view& operator=(const table_view& rhs) = delete;
+        table_view& operator=(table_view&& rhs) = default;
+
+        // the data has changed, filter and sort all row_count rows again
+        virtual void reset(size_t row_count) = 0;
+        // an empty predicate keeps every row
+        virtual void filter(std::function<bool(size_t)> predicate) = 0;
+        // a stable sort, an empty comparator keeps the data order
+        virtual void sort(std::function<bool(size_t, size_t)> less) = 0;
+        // Applies the latest finished job and returns whether rows() has changed. An exception thrown by the predicate or the
+        // comparator is rethrown here. table calls it at the beginning of every frame.
+        virtual bool poll() = 0;
+        // whether a job has not been applied yet
+        [[nodiscard]] virtual bool busy() const noexcept = 0;
+        // the data row of each table row
+        [[nodiscard]] virtual span<const size_t> rows() const noexcept = 0;
+    };
+
+    // Works on thread_count threads, 0 means one thread per core.
+    ANIMGUI_API std::shared_ptr<table_view> create_table_view(size_t row_count, uint32_t thread_count = 0);
+}  // namespace animgui
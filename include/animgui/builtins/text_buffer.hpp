@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <animgui/core/common.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace animgui {
+    // A UTF-8 document stored as a rope of chunks which cache their numbers of codepoints and lines. Positions count
+    // codepoints and are clamped to size(). Locating a position or a line, inserting and erasing cost O(log n) plus the size
+    // of a chunk and of the edited text, so edits do not slow down with the size of the document.
+    class text_buffer {
+    public:
+        text_buffer() = default;
+        virtual ~text_buffer() = default;
+        text_buffer(const text_buffer& rhs) = delete;
+        text_buffer(text_buffer&& rhs) = default;
+        text_buffer& operator=(const text_buffer& rhs) = delete;
+        text_buffer& operator=(text_buffer&& rhs) = default;
+
+        // the number of codepoints
+        [[nodiscard]] virtual size_t size() const noexcept = 0;
+        // the number of '\n' plus one
+        [[nodiscard]] virtual size_t line_count() const noexcept = 0;
+        // the position of the first codepoint of a line
+        [[nodiscard]] virtual size_t line_begin(size_t line) const = 0;
+        // the position of the '\n' which ends a line, or size() for the last line
+        [[nodiscard]] virtual size_t line_end(size_t line) const = 0;
+        [[nodiscard]] virtual size_t line_of(size_t pos) const = 0;
+        [[nodiscard]] virtual std::pmr::string text(size_t begin, size_t end,
+                                                    std::pmr::memory_resource* memory_resource) const = 0;
+        virtual void insert(size_t pos, std::string_view str) = 0;
+        virtual void erase(size_t begin, size_t end) = 0;
+        // bumped by every change
+        [[nodiscard]] virtual uint64_t version() const noexcept = 0;
+    };
+
+    ANIMGUI_API std::shared_ptr<text_buffer> create_text_buffer(std::string_view str = {});
+}  // namespace animgui
@@ -7,6 +7,7 @@ namespace animgui {
     enum class text_edit_status;
     struct texture_region;
     class canvas;
+    class text_buffer;
     struct style;
 
     ANIMGUI_API bool selected(canvas& parent, identifier id);
@@ -150,6 +151,11 @@ namespace animgui {
     };
 
     ANIMGUI_API text_modifier text(canvas& parent, std::pmr::string str);
+    // Text wrapped into lines of at most width. The line breaks are cached by the emitter and only the visible lines are emitted,
+    // so large help or log texts are cheap to show in a scrolled panel. Large texts which rarely change should be kept in a
+    // paragraph_text across frames, so they are neither copied nor hashed again.
+    ANIMGUI_API void paragraph(canvas& parent, float width, std::pmr::string str, text_alignment alignment = text_alignment::left);
+    ANIMGUI_API void paragraph(canvas& parent, float width, paragraph_text str, text_alignment alignment = text_alignment::left);
     ANIMGUI_API image_modifier image(canvas& parent, texture_region image, vec2 size, const color_rgba& factor);
     ANIMGUI_API button_label_modifier button_label(canvas& parent, std::pmr::string label);
     ANIMGUI_API button_image_modifier button_image(canvas& parent, texture_region image, vec2 size, const color_rgba& factor);
@@ -162,6 +168,9 @@ namespace animgui {
     enum class text_edit_status { inactive, active, committed };
     ANIMGUI_API text_edit_modifier text_edit(canvas& parent, float glyph_width, std::pmr::string& str,
                                            std::optional<std::pmr::string> placeholder = std::nullopt);
+    // A scrolled multi-line editor of buffer. Moving the cursor, editing and rendering only touch the lines in view and the
+    // edited ones, so a keystroke costs the same whatever the size of the document. Shift extends the selection.
+    ANIMGUI_API text_edit_status text_editor(canvas& parent, vec2 size, text_buffer& buffer);
     ANIMGUI_API radio_button_modifier radio_button(canvas& parent, const std::pmr::vector<std::pmr::string>& labels, size_t& index);
     ANIMGUI_API void color_edit(canvas& parent, color_rgba& color);
     ANIMGUI_API progressbar_modifier progressbar(canvas& parent, float width, float progress, std::optional<std::pmr::string> label);
@@ -1,12 +1,9 @@
 // SPDX-License-Identifier: MIT
 
 #pragma once
-#include <functional>
-#include <utility>
+#include "common.hpp"
 
 namespace animgui {
-    using step_function = std::function<float(float, void*)>;  // value=step(destination,state)
-
     // TODO: enter & exit
     class animator {
     public:
@@ -17,8 +14,9 @@ namespace animgui {
         animator& operator=(const animator& rhs) = delete;
         animator& operator=(animator&& rhs) = default;
 
-        // hash/size/alignment
-        [[nodiscard]] virtual std::tuple<size_t, size_t, size_t> state_storage() const noexcept = 0;
-        [[nodiscard]] virtual step_function step(float delta_t) const = 0;
+        // Advances all animation channels towards their destinations in place. The channels are stored as structure of
+        // arrays, so one pass over the flat arrays handles every animated value. A channel has settled once its current value
+        // equals the destination exactly.
+        virtual void step(float delta_t, span<float> current, span<const float> destination) const = 0;
     };
 }  // namespace animgui
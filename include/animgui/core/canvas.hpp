@@ -2,6 +2,7 @@
 
 #pragma once
 #include "emitter.hpp"
+#include <functional>
 #include <optional>
 
 namespace animgui {
@@ -29,6 +30,15 @@ namespace animgui {
         virtual std::pair<size_t, identifier> add_primitive(identifier uid, primitive primitive) = 0;
         [[nodiscard]] virtual vec2 reserved_size() const noexcept = 0;
         virtual span<operation> commands() noexcept = 0;
+        // Emits the operations covered by order in the order of its segments instead of the order they were added in, e.g. to
+        // draw windows by z-order. The segments are indices of commands() which together form one continuous range, and each
+        // of them holds balanced regions. A segment may be reordered again by an enclosing layout.
+        virtual void reorder(span<const operation_segment> order) = 0;
+        // Draws render_function into an offscreen texture, the origin of the content is the top-left corner of the texture.
+        // target is reused if it is large enough. If the render backend does not support offscreen rendering, render_function
+        // is not called and the returned region has no texture.
+        virtual texture_region render_offscreen(vec2 size, std::shared_ptr<texture> target,
+                                                const std::function<void(canvas&)>& render_function) = 0;
 
         virtual void* raw_storage(size_t hash, identifier uid) = 0;
         virtual void register_type(size_t hash, size_t size, size_t alignment, raw_callback ctor, raw_callback dtor) = 0;
@@ -37,7 +47,7 @@ namespace animgui {
             const auto hash = typeid(T).hash_code();
             register_type(
                 hash, sizeof(T), alignof(T),
-                [](void* ptr, size_t size) { std::uninitialized_default_construct_n(static_cast<T*>(ptr), size); },
+                [](void* ptr, size_t size) { std::uninitialized_value_construct_n(static_cast<T*>(ptr), size); },
                 [](void* ptr, size_t size) { std::destroy_n(static_cast<T*>(ptr), size); });
             return *static_cast<T*>(raw_storage(hash, uid));
         }
@@ -54,6 +64,11 @@ namespace animgui {
         [[nodiscard]] virtual bool hovered(const bounds_aabb& bounds) const = 0;
         [[nodiscard]] virtual bool region_request_focus(bool force = false) = 0;
 
+        // Returns the animated value of id which moves towards dest.
         [[nodiscard]] virtual float step(identifier id, float dest) = 0;
+        [[nodiscard]] virtual vec2 step(identifier id, vec2 dest) = 0;
+        [[nodiscard]] virtual color_rgba step(identifier id, const color_rgba& dest) = 0;
+        // Asks for another frame after delay seconds even if no input arrives, for the widgets driven by timers.
+        virtual void request_redraw(float delay) = 0;
     };
 }  // namespace animgui
@@ -4,6 +4,7 @@
 #include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <memory_resource>
 #include <stack>
@@ -113,6 +114,45 @@ namespace animgui {
         return identifier{ res };
     }
 
+    // XXH64 (xxHash). Large inputs are consumed by four independent lanes, and every word is multiplied and rotated, so each
+    // input bit affects the whole result. Hashes are chained by passing the last result as seed.
+    inline uint64_t hash_bytes(const void* data, const size_t size, const uint64_t seed = 0) noexcept {
+        constexpr uint64_t prime1 = 0x9E3779B185EBCA87, prime2 = 0xC2B2AE3D27D4EB4F, prime3 = 0x165667B19E3779F9,
+                           prime4 = 0x85EBCA77C2B2AE63, prime5 = 0x27D4EB2F165667C5;
+        const auto rotl = [](const uint64_t val, const int bits) { return (val << bits) | (val >> (64 - bits)); };
+        const auto round = [&](const uint64_t acc, const uint64_t input) { return rotl(acc + input * prime2, 31) * prime1; };
+        const auto read = [](const unsigned char* ptr, const size_t bytes) {
+            uint64_t word = 0;
+            std::memcpy(&word, ptr, bytes);
+            return word;
+        };
+        auto ptr = static_cast<const unsigned char*>(data);
+        const auto end = ptr + size;
+        uint64_t res;
+        if(size >= 32) {
+            uint64_t lanes[4] = { seed + prime1 + prime2, seed + prime2, seed, seed - prime1 };
+            for(; end - ptr >= 32; ptr += 32)
+                for(size_t lane = 0; lane < 4; ++lane)
+                    lanes[lane] = round(lanes[lane], read(ptr + lane * 8, 8));
+            res = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+            for(const auto lane : lanes)
+                res = (res ^ round(0, lane)) * prime1 + prime4;
+        } else
+            res = seed + prime5;
+        res += size;
+        for(; end - ptr >= 8; ptr += 8)
+            res = rotl(res ^ round(0, read(ptr, 8)), 27) * prime1 + prime4;
+        if(end - ptr >= 4) {
+            res = rotl(res ^ (read(ptr, 4) * prime1), 23) * prime2 + prime3;
+            ptr += 4;
+        }
+        for(; ptr < end; ++ptr)
+            res = rotl(res ^ (*ptr * prime5), 11) * prime1;
+        res = (res ^ (res >> 33)) * prime2;
+        res = (res ^ (res >> 29)) * prime3;
+        return res ^ (res >> 32);
+    }
+
     // TODO: use std::span
     template <typename T>
     class span final {
@@ -31,6 +31,15 @@ namespace animgui {
 
         virtual void new_frame(uint32_t width, uint32_t height, float delta_t,
                                const std::function<void(canvas&)>& render_function) = 0;
+        // Whether the next frame may differ from the last one: input events are pending, an animation has not settled yet or
+        // a widget asked for a redraw.
+        [[nodiscard]] virtual bool needs_redraw() const = 0;
+        // Blocks until needs_redraw() becomes true or timeout (in seconds) expires, and returns needs_redraw(). Changes of the
+        // application's own data are not tracked, so pick a timeout matching its refresh rate.
+        virtual bool wait_for_work(double timeout) = 0;
+        // Marks that the last frame has been presented, which ends its render latency. Optional: without it the render latency
+        // ends when the render backend finishes emit.
+        virtual void frame_presented() = 0;
         virtual void reset_cache() = 0;
         virtual texture_region load_image(const image_desc& image, float max_scale) = 0;
         [[nodiscard]] virtual std::shared_ptr<font> load_font(const std::pmr::string& name, float height) const = 0;
@@ -48,6 +48,41 @@ namespace animgui {
         std::shared_ptr<font> font_ref;
         color_rgba color;
     };
+    enum class text_alignment { left, right, middle };
+    // The immutable text of a paragraph. Copies share the string, so a large text built once is not copied into the
+    // primitives of every frame. The string is moved into the default memory resource, because the emitter keeps it in its
+    // caches after the frame which may have allocated it. The hash is computed once here and is used by the emitter as the
+    // cache key of the text.
+    class paragraph_text final {
+        std::shared_ptr<const std::pmr::string> m_str;
+        uint64_t m_hash;
+
+    public:
+        explicit paragraph_text(std::pmr::string str)
+            : m_str{ std::make_shared<const std::pmr::string>(
+                  std::move(str), std::pmr::polymorphic_allocator<char>{ std::pmr::get_default_resource() }) },
+              m_hash{ hash_bytes(m_str->data(), m_str->size()) } {}
+        [[nodiscard]] const std::pmr::string& str() const noexcept {
+            return *m_str;
+        }
+        [[nodiscard]] uint64_t hash() const noexcept {
+            return m_hash;
+        }
+        // Confirms a cache hit. A text kept across frames shares its string, so it is not read again.
+        [[nodiscard]] bool same_text(const paragraph_text& rhs) const noexcept {
+            return m_str == rhs.m_str || (m_hash == rhs.m_hash && *m_str == *rhs.m_str);
+        }
+    };
+    // Text wrapped into lines of at most width, which break at spaces and '\n' and are font_ref->line_spacing() apart. Words
+    // longer than width are broken between glyphs. Lines are aligned within width.
+    struct canvas_paragraph final {
+        vec2 pos;
+        float width;
+        paragraph_text text;
+        std::shared_ptr<font> font_ref;
+        color_rgba color;
+        text_alignment alignment;
+    };
 
     struct extended_callback final {
         std::function<void(const bounds_aabb&, vec2, std::pmr::vector<command>&, const style&,
@@ -57,13 +92,18 @@ namespace animgui {
     };
 
     using primitive = std::variant<button_base, canvas_fill_rect, canvas_stroke_rect, canvas_line, canvas_point, canvas_image,
-                                   canvas_text, extended_callback>;
+                                   canvas_text, canvas_paragraph, extended_callback>;
 
     struct op_push_region final {
         bounds_aabb bounds;
+        identifier uid;
     };
     struct op_pop_region final {};
     using operation = std::variant<op_push_region, op_pop_region, primitive>;
+    // the operations [begin, end) of a stream
+    struct operation_segment final {
+        size_t begin, end;
+    };
 
     class emitter {
     public:
@@ -74,8 +114,18 @@ namespace animgui {
         emitter& operator=(emitter&&) = default;
         virtual ~emitter() = default;
 
-        virtual command_queue transform(vec2 size, span<operation> operations, const style& style,
-                                                    const std::function<texture_region(font&, glyph_id)>& font_callback) = 0;
+        // font_callback is thread-safe. It returns a texture region without texture if the glyph is not cached yet and the
+        // calling thread is not the one which invoked the emitter.
+        // The segments of order cover all operations, which are emitted in that order. It is how layouts reorder parts of the
+        // stream (see canvas::reorder) without moving operations.
+        virtual command_queue transform(vec2 size, span<operation> operations, span<const operation_segment> order,
+                                        const style& style,
+                                        const std::function<texture_region(font&, glyph_id)>& font_callback) = 0;
         virtual vec2 calculate_bounds(const primitive& primitive, const style& style) = 0;
+        // drops the state retained across frames, it must be called when cached texture regions become invalid
+        virtual void reset_cache() {}
+        // Called by the context at the beginning of every frame, before the canvas is built. State retained across frames
+        // should age by frames, since offscreen layers call transform several times in one frame.
+        virtual void new_frame() {}
     };
 }  // namespace animgui
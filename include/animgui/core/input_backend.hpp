@@ -123,6 +123,12 @@ namespace animgui {
         virtual ~input_backend() = default;
 
         virtual void new_frame() = 0;
+        // Whether any event arrived since the last new_frame. Backends which cannot tell always report true.
+        [[nodiscard]] virtual bool events_arrived() const noexcept {
+            return true;
+        }
+        // Blocks until an event arrives or timeout (in seconds) expires. The events are handled by the next new_frame.
+        virtual void wait_events(double) {}
         [[nodiscard]] virtual input_mode get_input_mode() const noexcept = 0;
 
         virtual void close_window() = 0;
@@ -156,5 +162,10 @@ namespace animgui {
         [[nodiscard]] virtual vec2 action_direction_pulse_repeated(bool navigation = false) const noexcept = 0;
 
         [[nodiscard]] virtual uint64_t input_time() const noexcept = 0;
+        // The time point (see current_time) when the oldest input event handled by the last new_frame arrived, or 0 if no
+        // event arrived or the backend does not track it.
+        [[nodiscard]] virtual uint64_t oldest_event_time() const noexcept {
+            return 0;
+        }
     };
 }  // namespace animgui
@@ -5,6 +5,7 @@
 
 #include <functional>
 #include <optional>
+#include <stdexcept>
 #include <variant>
 #include <vector>
 #include <memory>
@@ -55,7 +56,8 @@ namespace animgui {
         triangles = 1 << 4,
         triangle_fan = 1 << 5,
         triangle_strip = 1 << 6,
-        quads = 1 << 7
+        quads = 1 << 7,
+        quad_instances = 1 << 8
     };
 
     constexpr primitive_type operator|(const primitive_type lhs, const primitive_type rhs) {
@@ -70,17 +72,56 @@ namespace animgui {
         return static_cast<uint32_t>(capability) & static_cast<uint32_t>(requirement);
     }
 
+    // 16-bit normalized texture coordinate, texture regions always lie in [0, 1]
+    struct packed_tex_coord final {
+        uint16_t s = 0, t = 0;
+    };
+    // 8-bit normalized color
+    struct packed_color final {
+        uint8_t r = 0, g = 0, b = 0, a = 0;
+    };
+
+    inline packed_tex_coord pack_tex_coord(const vec2 tex_coord) noexcept {
+        const auto pack = [](const float val) {
+            return static_cast<uint16_t>(std::fmin(std::fmax(val, 0.0f), 1.0f) * 65535.0f + 0.5f);
+        };
+        return { pack(tex_coord.x), pack(tex_coord.y) };
+    }
+    inline vec2 unpack_tex_coord(const packed_tex_coord tex_coord) noexcept {
+        return { static_cast<float>(tex_coord.s) / 65535.0f, static_cast<float>(tex_coord.t) / 65535.0f };
+    }
+    inline packed_color pack_color(const color_rgba& color) noexcept {
+        const auto pack = [](const float val) {
+            return static_cast<uint8_t>(std::fmin(std::fmax(val, 0.0f), 1.0f) * 255.0f + 0.5f);
+        };
+        return { pack(color.r), pack(color.g), pack(color.b), pack(color.a) };
+    }
+
     struct vertex final {
         vec2 pos;
-        vec2 tex_coord;
-        color_rgba color;
+        packed_tex_coord tex_coord;
+        packed_color color;
     };
+    static_assert(sizeof(vertex) == 16);
+
+    // An axis-aligned quad, drawn as the triangle strip (left, top), (left, bottom), (right, top), (right, bottom).
+    struct quad_instance final {
+        bounds_aabb rect;
+        packed_tex_coord tex_min;  // at (left, top)
+        packed_tex_coord tex_max;  // at (right, bottom)
+        packed_color color;
+    };
+    static_assert(sizeof(quad_instance) == 28);
     
     struct primitives final {
         primitive_type type;
         uint32_t vertices_count;
         std::shared_ptr<texture> tex;
         float point_line_size;
+        // Indexed draw if non-zero. Indices are relative to the first vertex of the command.
+        uint32_t indices_count = 0;
+        // The number of quad instances drawn by primitive_type::quad_instances, which uses no vertices.
+        uint32_t instances_count = 0;
     };
 
     struct command final {
@@ -94,6 +135,8 @@ namespace animgui {
     struct command_queue final {
         std::pmr::vector<vertex> vertices;
         std::pmr::vector<command> commands;
+        std::pmr::vector<uint32_t> indices;
+        std::pmr::vector<quad_instance> instances;
     };
 
     class render_backend {
@@ -110,6 +153,24 @@ namespace animgui {
         virtual std::shared_ptr<texture> create_texture_from_native_handle(uint64_t handle, uvec2 size, channel channels) = 0;
         virtual void emit(uvec2 screen_size) = 0;
         [[nodiscard]] virtual uint64_t render_time() const noexcept = 0;
+        // Time spent on copying the command list to the GPU in the last update_command_list, excluded from render_time.
+        [[nodiscard]] virtual uint64_t upload_time() const noexcept {
+            return 0;
+        }
+        // The time point (see current_time) when the last emit finished, or 0 if it is not tracked.
+        [[nodiscard]] virtual uint64_t emit_finish_time() const noexcept {
+            return 0;
+        }
         [[nodiscard]] virtual primitive_type supported_primitives() const noexcept = 0;
+
+        // Offscreen rendering is optional. render_to_texture draws the command list into the top-left size pixels of target, a
+        // texture created by create_texture with channel::rgba. It is only called before update_command_list of the current
+        // frame, so it may reuse the buffers of the frame.
+        [[nodiscard]] virtual bool offscreen_supported() const noexcept {
+            return false;
+        }
+        virtual void render_to_texture(texture&, uvec2, command_queue) {
+            throw std::logic_error{ "offscreen rendering is not supported" };
+        }
     };
 }  // namespace animgui
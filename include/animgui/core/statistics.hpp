@@ -13,15 +13,25 @@ namespace animgui {
         uint32_t input_time;
         uint32_t draw_time;
         uint32_t emit_time;
+        uint32_t cull_time;
         uint32_t fallback_time;
         uint32_t optimize_time;
         uint32_t render_time;
+        uint32_t upload_time;
 
-        // float input_latency;
-        // float render_latency;
+        // unit: us, sampled by the frames which handle input events
+        uint32_t input_latency;   // the oldest input event -> new_frame
+        uint32_t render_latency;  // new_frame -> present, or the end of emit if presenting is not reported
+        // distribution of input_latency + render_latency over the last 600 samples
+        uint32_t latency_p50;
+        uint32_t latency_p90;
+        uint32_t latency_p99;
+        uint32_t latency_max;
 
         uint32_t generated_operation;
         uint32_t emitted_draw_call;
+        uint32_t culled_vertex;
+        uint32_t culled_pixel;
         uint32_t transformed_draw_call;
         uint32_t optimized_draw_call;
     };
@@ -135,6 +135,8 @@ namespace animgui {
 
         ID3D11Buffer* m_vertex_buffer = nullptr;
         size_t m_vertex_buffer_size = 0;
+        ID3D11Buffer* m_index_buffer = nullptr;
+        size_t m_index_buffer_size = 0;
         ID3D11VertexShader* m_vertex_shader = nullptr;
         ID3D11InputLayout* m_input_layout = nullptr;
         ID3D11PixelShader* m_pixel_shader = nullptr;
@@ -149,6 +151,7 @@ namespace animgui {
         ID3D11ShaderResourceView* m_bind_tex = nullptr;
 
         uint64_t m_render_time = 0;
+        uint64_t m_emit_finish_time = 0;
 
         void check_d3d_error(const HRESULT res) const {
             if(res != S_OK)
@@ -175,29 +178,59 @@ namespace animgui {
             m_device_context->Unmap(m_vertex_buffer, 0);
         }
 
+        void update_index_buffer(const std::pmr::vector<uint32_t>& indices) {
+            if(indices.empty())
+                return;
+            if(m_index_buffer_size < indices.size()) {
+                if(m_index_buffer)
+                    m_index_buffer->Release();
+                m_index_buffer_size = std::max(std::max(m_index_buffer_size, static_cast<size_t>(1024)) * 2, indices.size());
+                const D3D11_BUFFER_DESC index_buffer_desc{ static_cast<uint32_t>(m_index_buffer_size * sizeof(uint32_t)),
+                                                           D3D11_USAGE_DYNAMIC,
+                                                           D3D11_BIND_INDEX_BUFFER,
+                                                           D3D11_CPU_ACCESS_WRITE,
+                                                           0,
+                                                           sizeof(uint32_t) };
+                check_d3d_error(m_device->CreateBuffer(&index_buffer_desc, nullptr, &m_index_buffer));
+            }
+
+            D3D11_MAPPED_SUBRESOURCE mapped_resource;
+            check_d3d_error(m_device_context->Map(m_index_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource));
+            memcpy(mapped_resource.pData, indices.data(), indices.size() * sizeof(uint32_t));
+            m_device_context->Unmap(m_index_buffer, 0);
+        }
+
         void make_dirty() {
             m_dirty = true;
             m_scissor_restricted = true;
             m_bind_tex = reinterpret_cast<ID3D11ShaderResourceView*>(std::numeric_limits<size_t>::max());
         }
 
-        void emit(const native_callback& callback, uint32_t&) {
+        void emit(const native_callback& callback, uint32_t&, uint32_t&) {
             callback();
             make_dirty();
         }
         static D3D11_PRIMITIVE_TOPOLOGY get_primitive_type(const primitive_type type) noexcept {
-            // ReSharper disable once CppDefaultCaseNotHandledInSwitchStatement CppIncompleteSwitchStatement
-            switch(type) {  // NOLINT(clang-diagnostic-switch)
+            switch(type) {
                 case primitive_type::triangles:
                     return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
                 case primitive_type::triangle_strip:
                     return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+                case primitive_type::points:
+                case primitive_type::lines:
+                case primitive_type::line_strip:
+                case primitive_type::line_loop:
+                case primitive_type::triangle_fan:
+                case primitive_type::quads:
+                case primitive_type::quad_instances:
+                    // not supported, expanded into triangles by the context
+                    break;
             }
             return static_cast<D3D11_PRIMITIVE_TOPOLOGY>(0);
         }
 
-        void emit(const primitives& primitives, uint32_t& vertices_offset) {
-            auto&& [type, vertices_count, tex, point_line_size] = primitives;
+        void emit(const primitives& primitives, uint32_t& vertices_offset, uint32_t& indices_offset) {
+            auto&& [type, vertices_count, tex, point_line_size, indices_count, instances_count] = primitives;
 
             if(m_dirty) {
                 m_device_context->RSSetState(m_rasterizer_state);
@@ -218,6 +251,7 @@ namespace animgui {
                 uint32_t stride = sizeof(vertex);
                 uint32_t offset = 0;
                 m_device_context->IASetVertexBuffers(0, 1, &m_vertex_buffer, &stride, &offset);
+                m_device_context->IASetIndexBuffer(m_index_buffer, DXGI_FORMAT_R32_UINT, 0);
 
                 m_dirty = false;
             }
@@ -239,7 +273,11 @@ namespace animgui {
                 }
             }
 
-            m_device_context->Draw(vertices_count, vertices_offset);
+            if(indices_count) {
+                m_device_context->DrawIndexed(indices_count, indices_offset, static_cast<INT>(vertices_offset));
+                indices_offset += indices_count;
+            } else
+                m_device_context->Draw(vertices_count, vertices_offset);
             vertices_offset += vertices_count;
         }
 
@@ -261,9 +299,9 @@ namespace animgui {
 
                 const D3D11_INPUT_ELEMENT_DESC input_layout[] = {
                     { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offset_u32(&vertex::pos), D3D11_INPUT_PER_VERTEX_DATA, 0 },
-                    { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offset_u32(&vertex::tex_coord), D3D11_INPUT_PER_VERTEX_DATA,
+                    { "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM, 0, offset_u32(&vertex::tex_coord), D3D11_INPUT_PER_VERTEX_DATA,
                       0 },
-                    { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offset_u32(&vertex::color), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+                    { "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, offset_u32(&vertex::color), D3D11_INPUT_PER_VERTEX_DATA, 0 },
                 };
                 check_d3d_error(m_device->CreateInputLayout(input_layout, 3, vertex_shader_blob->GetBufferPointer(),
                                                             vertex_shader_blob->GetBufferSize(), &m_input_layout));
@@ -338,6 +376,8 @@ namespace animgui {
         ~d3d11_backend() override {
             if(m_vertex_buffer)
                 m_vertex_buffer->Release();
+            if(m_index_buffer)
+                m_index_buffer->Release();
             m_vertex_shader->Release();
             m_input_layout->Release();
             m_pixel_shader->Release();
@@ -363,6 +403,7 @@ namespace animgui {
             }
 
             update_vertex_buffer(command_list.vertices);
+            update_index_buffer(command_list.indices);
 
             m_command_list.clear();
             m_command_list.reserve(command_list.commands.size());
@@ -375,7 +416,7 @@ namespace animgui {
 
             make_dirty();
 
-            uint32_t vertices_offset = 0;
+            uint32_t vertices_offset = 0, indices_offset = 0;
 
             const vec2 scale = { static_cast<float>(screen_size.x) / m_window_size.x,
                                  static_cast<float>(screen_size.y) / m_window_size.y };
@@ -397,11 +438,12 @@ namespace animgui {
                     m_scissor_restricted = false;
                 }
 
-                std::visit([&](auto&& item) { emit(item, vertices_offset); }, command.desc);
+                std::visit([&](auto&& item) { emit(item, vertices_offset, indices_offset); }, command.desc);
             }
 
             const auto tp2 = current_time();
             m_render_time = tp2 - tp1;
+            m_emit_finish_time = tp2;
         }
         std::shared_ptr<texture> create_texture(uvec2 size, channel channels) override {
             return std::make_shared<texture_impl>(m_device, m_device_context, channels, size, m_error_checker);
@@ -416,6 +458,9 @@ namespace animgui {
         [[nodiscard]] uint64_t render_time() const noexcept override {
             return m_render_time;
         }
+        [[nodiscard]] uint64_t emit_finish_time() const noexcept override {
+            return m_emit_finish_time;
+        }
     };
     ANIMGUI_API std::shared_ptr<render_backend> create_d3d11_backend(ID3D11Device* device, ID3D11DeviceContext* device_context,
                                                                      std::function<void(long)> error_checker) {
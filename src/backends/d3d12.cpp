@@ -209,6 +209,35 @@ namespace animgui {
             m_vertex_buffer->Unmap(0, &range);
         }
 
+        ComPtr<ID3D12Resource> m_index_buffer;
+        D3D12_INDEX_BUFFER_VIEW m_index_buffer_view = {};
+        size_t m_index_buffer_size = 0;
+
+        void update_index_buffer(const std::pmr::vector<uint32_t>& indices) {
+            if(indices.empty())
+                return;
+            if(m_index_buffer_size < indices.size()) {
+                m_index_buffer.Reset();
+                m_index_buffer_size = std::max(std::max(m_index_buffer_size, static_cast<size_t>(1024)) * 2, indices.size());
+                const auto heap_properties = CD3DX12_HEAP_PROPERTIES{ D3D12_HEAP_TYPE_UPLOAD };
+                const auto index_buffer_desc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(uint32_t) * m_index_buffer_size);
+
+                check_d3d_error(m_device->CreateCommittedResource(&heap_properties, D3D12_HEAP_FLAG_NONE, &index_buffer_desc,
+                                                                  D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+                                                                  IID_PPV_ARGS(m_index_buffer.GetAddressOf())));
+                m_index_buffer_view = { m_index_buffer->GetGPUVirtualAddress(),
+                                        static_cast<uint32_t>(sizeof(uint32_t) * m_index_buffer_size), DXGI_FORMAT_R32_UINT };
+            }
+
+            const auto size = indices.size() * sizeof(uint32_t);
+            void* ptr;
+            const D3D12_RANGE discard{ 0, 0 };
+            check_d3d_error(m_index_buffer->Map(0, &discard, &ptr));
+            memcpy(ptr, indices.data(), size);
+            const D3D12_RANGE range{ 0, size };
+            m_index_buffer->Unmap(0, &range);
+        }
+
         bool m_dirty = false;
         bool m_scissor_restricted = false;
 
@@ -217,29 +246,39 @@ namespace animgui {
             m_scissor_restricted = true;
         }
 
-        void emit(const native_callback& callback, uint32_t&) {
+        void emit(const native_callback& callback, uint32_t&, uint32_t&) {
             callback();
             make_dirty();
         }
 
         static D3D12_PRIMITIVE_TOPOLOGY get_primitive_type(const primitive_type type) noexcept {
-            // ReSharper disable once CppDefaultCaseNotHandledInSwitchStatement CppIncompleteSwitchStatement
-            switch(type) {  // NOLINT(clang-diagnostic-switch)
+            switch(type) {
                 case primitive_type::triangles:
                     return D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
                 case primitive_type::triangle_strip:
                     return D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+                case primitive_type::points:
+                case primitive_type::lines:
+                case primitive_type::line_strip:
+                case primitive_type::line_loop:
+                case primitive_type::triangle_fan:
+                case primitive_type::quads:
+                case primitive_type::quad_instances:
+                    // not supported, expanded into triangles by the context
+                    break;
             }
             return static_cast<D3D12_PRIMITIVE_TOPOLOGY>(0);
         }
 
-        void emit(const primitives& primitives, uint32_t& vertices_offset) {
-            auto&& [type, vertices_count, tex, point_line_size] = primitives;
+        void emit(const primitives& primitives, uint32_t& vertices_offset, uint32_t& indices_offset) {
+            auto&& [type, vertices_count, tex, point_line_size, indices_count, instances_count] = primitives;
 
             if(m_dirty) {
                 m_command_list->SetGraphicsRootSignature(m_root_signature.Get());
                 m_command_list->SetPipelineState(m_pipeline_state.Get());
                 m_command_list->IASetVertexBuffers(0, 1, &m_vertex_buffer_view);
+                if(m_index_buffer)
+                    m_command_list->IASetIndexBuffer(&m_index_buffer_view);
                 const auto heaps = { m_descriptor_heap.Get(), m_sampler_descriptor_heap.Get() };
                 m_command_list->SetDescriptorHeaps(heaps.size(), heaps.begin());
                 m_command_list->SetGraphicsRootDescriptorTable(1,
@@ -287,11 +326,16 @@ namespace animgui {
                     0, CD3DX12_GPU_DESCRIPTOR_HANDLE{ m_gpu_descriptor_handle, 2, m_descriptor_increment_size });
             }
 
-            m_command_list->DrawInstanced(vertices_count, 1, vertices_offset, 0);
+            if(indices_count) {
+                m_command_list->DrawIndexedInstanced(indices_count, 1, indices_offset, static_cast<INT>(vertices_offset), 0);
+                indices_offset += indices_count;
+            } else
+                m_command_list->DrawInstanced(vertices_count, 1, vertices_offset, 0);
             vertices_offset += vertices_count;
         }
 
         uint64_t m_render_time = 0;
+        uint64_t m_emit_finish_time = 0;
         uvec2 m_window_size = {};
         std::pmr::vector<command> m_command_buffer;
 
@@ -381,9 +425,9 @@ namespace animgui {
             const D3D12_INPUT_ELEMENT_DESC input_layout[] = {
                 { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offset_u32(&vertex::pos),
                   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-                { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offset_u32(&vertex::tex_coord),
+                { "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM, 0, offset_u32(&vertex::tex_coord),
                   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-                { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offset_u32(&vertex::color),
+                { "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, offset_u32(&vertex::color),
                   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
             };
 
@@ -487,6 +531,7 @@ namespace animgui {
             m_window_size = window_size;
 
             update_vertex_buffer(command_list.vertices);
+            update_index_buffer(command_list.indices);
 
             m_command_buffer.clear();
             m_command_buffer.reserve(command_list.commands.size());
@@ -499,7 +544,7 @@ namespace animgui {
 
             make_dirty();
 
-            uint32_t vertices_offset = 0;
+            uint32_t vertices_offset = 0, indices_offset = 0;
 
             const vec2 scale = { static_cast<float>(screen_size.x) / m_window_size.x,
                                  static_cast<float>(screen_size.y) / m_window_size.y };
@@ -521,15 +566,19 @@ namespace animgui {
                     m_scissor_restricted = false;
                 }
 
-                std::visit([&](auto&& item) { emit(item, vertices_offset); }, command.desc);
+                std::visit([&](auto&& item) { emit(item, vertices_offset, indices_offset); }, command.desc);
             }
 
             const auto tp2 = current_time();
             m_render_time = tp2 - tp1;
+            m_emit_finish_time = tp2;
         }
         [[nodiscard]] uint64_t render_time() const noexcept override {
             return m_render_time;
         }
+        [[nodiscard]] uint64_t emit_finish_time() const noexcept override {
+            return m_emit_finish_time;
+        }
         [[nodiscard]] primitive_type supported_primitives() const noexcept override {
             return primitive_type::triangles | primitive_type::triangle_strip;
         }
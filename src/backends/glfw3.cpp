@@ -5,6 +5,7 @@
 #include <animgui/core/input_backend.hpp>
 #include <cmath>
 #include <cstring>
+#include <utility>
 
 #ifdef ANIMGUI_WINDOWS
 #define NOMINMAX
@@ -218,6 +219,8 @@ namespace animgui {
     }
     class glfw3_backend final : public input_backend {
         static constexpr auto game_pad_axis_eps = 0.08f;
+        // game pads do not post events, so they are polled at this interval while waiting
+        static constexpr auto game_pad_poll_interval = 1.0 / 60.0;
         using clock = std::chrono::high_resolution_clock;
 
         GLFWwindow* m_window;
@@ -242,30 +245,101 @@ namespace animgui {
 
         const std::function<void()>& m_redraw;
         uint64_t m_input_time;
+        bool m_has_event;
+        bool m_frame_prepared;
+        uint64_t m_pending_event_time;
+        uint64_t m_event_time;
+
+        // the events are stamped when they are dispatched to the callbacks
+        void input_event() {
+            m_has_event = true;
+            if(!m_pending_event_time)
+                m_pending_event_time = current_time();
+        }
 
         void add_char(const uint32_t codepoint) {
+            input_event();
             m_input_characters.push_back(codepoint);
         }
         void key_event(const int key, const int state) {
+            input_event();
             const auto idx = static_cast<uint32_t>(cast_key_code(key));
             m_key_state[idx] = state != GLFW_RELEASE;
             m_key_state_pulse[idx] = state == GLFW_PRESS;
             m_key_state_pulse_repeated[idx] = state != GLFW_RELEASE;
         }
         void cursor_event(const vec2 pos) {
+            input_event();
             m_input_mode = input_mode::mouse;
             m_mouse_move.x += pos.x - m_cursor_pos.x;
             m_mouse_move.y += pos.y - m_cursor_pos.y;
             m_cursor_pos = pos;
         }
         void scroll_event(const vec2 offset) {
+            input_event();
             m_input_mode = input_mode::mouse;
             m_scroll.x += offset.x;
             m_scroll.y += offset.y;
         }
-        void refresh_event() const {
+        void refresh_event() {
+            m_has_event = true;
             m_redraw();
         }
+        // resets the states of the last frame before the events of the next frame are polled
+        void prepare_frame() {
+#ifdef ANIMGUI_WINDOWS
+            {
+                const auto handle = glfwGetWin32Window(m_window);
+                const auto imm = ImmGetContext(handle);
+
+                COMPOSITIONFORM desc{ CFS_FORCE_POSITION,
+                                      POINT{ static_cast<LONG>(m_imm_anchor.x), static_cast<LONG>(m_imm_anchor.y) },
+                                      {} };
+                //ImmSetCompositionFontW();
+                ImmSetCompositionWindow(imm, &desc);
+                ImmReleaseContext(handle, imm);
+
+                m_imm_anchor = { 0.0f, 0.0f };
+            }
+#endif
+
+            glfwSetCursor(m_window, m_cursors[m_cursor]);
+
+            m_cursor = cursor::arrow;
+            m_mouse_move = m_scroll = { 0.0f, 0.0f };
+            m_input_characters.clear();
+            memset(m_key_state_pulse, 0, sizeof(m_key_state_pulse));
+            memset(m_key_state_pulse_repeated, 0, sizeof(m_key_state_pulse_repeated));
+        }
+        void poll_game_pads() {
+            m_available_game_pad.clear();
+            const auto flush_to_zero = [](float& x) { x = std::fabs(x) < game_pad_axis_eps ? 0.0f : x; };
+            for(int i = 0; i <= GLFW_JOYSTICK_LAST; ++i) {
+                if(!glfwJoystickPresent(i) || !glfwJoystickIsGamepad(i))
+                    continue;
+                // TODO: hats
+                static_assert(sizeof(game_pad_state) == sizeof(GLFWgamepadstate));
+                auto state = reinterpret_cast<GLFWgamepadstate*>(&m_game_pad_state[i]);
+                const auto last = *state;
+                if(glfwGetGamepadState(i, state)) {
+                    for(int j = 0; j < 4; ++j)
+                        flush_to_zero(state->axes[j]);
+                    m_available_game_pad.push_back(i);
+                    bool held = false;
+                    for(auto&& button : state->buttons)
+                        held |= button == GLFW_PRESS;
+                    held |= state->axes[0] != 0.0f || state->axes[1] != 0.0f || state->axes[2] != 0.0f ||
+                        state->axes[3] != 0.0f || std::fabs(state->axes[4] - -1.0f) > game_pad_axis_eps ||
+                        std::fabs(state->axes[5] - -1.0f) > game_pad_axis_eps;
+                    if(held)
+                        m_input_mode = input_mode::game_pad;
+                    // a held stick or button keeps driving the navigation
+                    if(held || std::memcmp(last.buttons, state->buttons, sizeof(last.buttons)) != 0 ||
+                       std::memcmp(last.axes, state->axes, sizeof(last.axes)) != 0)
+                        input_event();
+                }
+            }
+        }
 
     public:
         explicit glfw3_backend(GLFWwindow* window, const std::function<void()>& redraw)
@@ -273,7 +347,8 @@ namespace animgui {
               m_mouse_move{ 0.0f, 0.0f }, m_scroll{ 0.0f, 0.0f }, m_key_state{}, m_key_state_pulse{},
               m_key_state_pulse_repeated{}, m_input_mode{ input_mode::mouse }, m_cursor{ cursor::arrow }, m_game_pad_state{},
               m_direction{ 0.0f, 0.0f }, m_direction_navigation{ 0.0f, 0.0f },
-              m_imm_anchor{ 0.0f, 0.0f }, m_redraw{ redraw }, m_input_time{ 0 } {
+              m_imm_anchor{ 0.0f, 0.0f }, m_redraw{ redraw }, m_input_time{ 0 }, m_has_event{ true }, m_frame_prepared{ false },
+              m_pending_event_time{ 0 }, m_event_time{ 0 } {
             m_available_game_pad.reserve(std::size(m_game_pad_state));
             glfwSetWindowUserPointer(m_window, this);
             glfwSetCharCallback(m_window, [](GLFWwindow* const win, const unsigned int cp) {
@@ -374,59 +449,25 @@ namespace animgui {
         void set_input_candidate_window(const vec2 pos) override {
             m_imm_anchor = pos;
         }
+        [[nodiscard]] bool events_arrived() const noexcept override {
+            return m_has_event;
+        }
+        void wait_events(const double timeout) override {
+            if(!m_frame_prepared) {
+                prepare_frame();
+                m_frame_prepared = true;
+            }
+            poll_game_pads();
+            if(!m_has_event)
+                glfwWaitEventsTimeout(m_available_game_pad.empty() ? timeout : std::fmin(timeout, game_pad_poll_interval));
+        }
         void new_frame() override {
             const auto tp1 = current_time();
 
-#ifdef ANIMGUI_WINDOWS
-            {
-                const auto handle = glfwGetWin32Window(m_window);
-                const auto imm = ImmGetContext(handle);
-
-                COMPOSITIONFORM desc{ CFS_FORCE_POSITION,
-                                      POINT{ static_cast<LONG>(m_imm_anchor.x), static_cast<LONG>(m_imm_anchor.y) },
-                                      {} };
-                //ImmSetCompositionFontW();
-                ImmSetCompositionWindow(imm, &desc);
-                ImmReleaseContext(handle, imm);
-
-                m_imm_anchor = { 0.0f, 0.0f };
-            }
-#endif
-
-            glfwSetCursor(m_window, m_cursors[m_cursor]);
-
-            m_cursor = cursor::arrow;
-            m_mouse_move = m_scroll = { 0.0f, 0.0f };
-            m_available_game_pad.clear();
-            const auto flush_to_zero = [](float& x) { x = std::fabs(x) < game_pad_axis_eps ? 0.0f : x; };
-            for(int i = 0; i <= GLFW_JOYSTICK_LAST; ++i) {
-                if(!glfwJoystickPresent(i) || !glfwJoystickIsGamepad(i))
-                    continue;
-                // TODO: hats
-                static_assert(sizeof(game_pad_state) == sizeof(GLFWgamepadstate));
-                if(auto state = reinterpret_cast<GLFWgamepadstate*>(&m_game_pad_state[i]); glfwGetGamepadState(i, state)) {
-                    for(int j = 0; j < 4; ++j)
-                        flush_to_zero(state->axes[j]);
-                    m_available_game_pad.push_back(i);
-                    if(m_input_mode != input_mode::game_pad) {
-                        for(auto&& button : state->buttons)
-                            if(button == GLFW_PRESS) {
-                                m_input_mode = input_mode::game_pad;
-                                break;
-                            }
-                    }
-                    if(m_input_mode != input_mode::game_pad) {
-                        if(state->axes[0] != 0.0f || state->axes[1] != 0.0f || state->axes[2] != 0.0f || state->axes[3] != 0.0f ||
-                           std::fabs(state->axes[4] - -1.0f) > game_pad_axis_eps ||
-                           std::fabs(state->axes[5] - -1.0f) > game_pad_axis_eps)
-                            m_input_mode = input_mode::game_pad;
-                    }
-                }
-            }
-
-            m_input_characters.clear();
-            memset(m_key_state_pulse, 0, sizeof(m_key_state_pulse));
-            memset(m_key_state_pulse_repeated, 0, sizeof(m_key_state_pulse_repeated));
+            // the states have been reset before waiting for the events
+            if(!std::exchange(m_frame_prepared, false))
+                prepare_frame();
+            poll_game_pads();
 
             auto&& state = m_game_pad_state[0];
 
@@ -450,6 +491,9 @@ namespace animgui {
             }
 
             glfwPollEvents();
+            // the events are handled by this frame
+            m_has_event = false;
+            m_event_time = std::exchange(m_pending_event_time, 0);
 
             m_direction = m_direction_navigation;
 
@@ -513,6 +557,9 @@ namespace animgui {
         [[nodiscard]] uint64_t input_time() const noexcept override {
             return m_input_time;
         }
+        [[nodiscard]] uint64_t oldest_event_time() const noexcept override {
+            return m_event_time;
+        }
     };
 
     ANIMGUI_API std::shared_ptr<input_backend> create_glfw3_backend(GLFWwindow* window, const std::function<void()>& redraw) {
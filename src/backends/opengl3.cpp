@@ -5,6 +5,10 @@
 #include <animgui/core/render_backend.hpp>
 #include <array>
 #include <cmath>
+#include <cstring>
+#include <deque>
+#include <utility>
+#include <vector>
 
 using namespace std::literals;
 
@@ -31,6 +35,31 @@ namespace animgui {
 
         )";
 
+    // quad instances are expanded into the triangle strip (left, top), (left, bottom), (right, top), (right, bottom)
+    static const char* const shader_quad_vert_src = R"(
+
+        #version 330 core
+
+        layout (location = 0) in vec4 rect;
+        layout (location = 1) in vec4 tex_rect;
+        layout (location = 2) in vec4 color;
+
+        out vec2 f_tex_coord;
+        out vec4 f_color;
+
+        uniform vec2 size;
+
+        void main() {
+            bool right = gl_VertexID >= 2;
+            bool bottom = (gl_VertexID & 1) == 1;
+            vec2 pos = vec2(right ? rect.y : rect.x, bottom ? rect.w : rect.z);
+            gl_Position = vec4(pos.x/size.x*2.0f-1.0f,1.0f-pos.y/size.y*2.0f, 0.0f, 1.0f);
+            f_tex_coord = vec2(right ? tex_rect.z : tex_rect.x, bottom ? tex_rect.w : tex_rect.y);
+            f_color = color;
+        }
+
+        )";
+
     static const char* shader_frag_src = R"(
 
         #version 330 core
@@ -55,6 +84,7 @@ namespace animgui {
         bool m_own;
         GLenum m_format;
         bool m_dirty = false;
+        bool m_premultiplied = false;
 
         static GLenum get_format(const channel channel) noexcept {
             if(channel == channel::alpha)
@@ -108,6 +138,19 @@ namespace animgui {
             m_dirty = true;
         }
 
+        // the content was changed by the GPU, e.g. rendered into by a framebuffer
+        void mark_dirty() noexcept {
+            m_dirty = true;
+        }
+        // Offscreen targets are rendered over transparent black with the blend state of emit, which leaves their colors
+        // multiplied by alpha. They are composited with premultiplied blending, so that alpha is not applied twice.
+        void mark_premultiplied() noexcept {
+            m_premultiplied = true;
+        }
+        [[nodiscard]] bool premultiplied() const noexcept {
+            return m_premultiplied;
+        }
+
         void generate_mipmap() override {
             if(m_dirty) {
                 glBindTexture(GL_TEXTURE_2D, m_id);
@@ -129,19 +172,206 @@ namespace animgui {
         }
     };
 
+    // Ring buffer for the per-frame vertex data. Each upload takes a fresh range after the previous one and a fence is
+    // inserted after the range has been drawn, so the CPU only waits when it catches up with ranges still in use by the GPU.
+    // The storage is persistently mapped when ARB_buffer_storage is available. Otherwise every range is mapped
+    // unsynchronized, and the buffer is orphaned instead of waiting when the ring wraps around.
+    class stream_buffer final {
+        static constexpr size_t alignment = sizeof(vertex);
+        // keep enough room for three uploads of the largest size seen, so that the fences rarely block
+        static constexpr size_t ranges_in_flight = 3;
+
+        struct range final {
+            size_t begin, end;
+            GLsync fence;
+        };
+
+        bool m_persistent;
+        GLuint m_buffer = 0;
+        size_t m_capacity = 0;
+        size_t m_head = 0;
+        size_t m_high_water = 0;
+        uint8_t* m_mapped = nullptr;
+        std::deque<range> m_in_flight;
+
+        static void wait(const GLsync fence) {
+            // GL_WAIT_FAILED means the context is lost, there is nothing left to protect
+            while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) == GL_TIMEOUT_EXPIRED) {
+            }
+            glDeleteSync(fence);
+        }
+
+        void release_fences() {
+            for(auto&& [begin, end, fence] : m_in_flight)
+                if(fence)
+                    glDeleteSync(fence);
+            m_in_flight.clear();
+        }
+
+        void reallocate() {
+            release_fences();
+
+            size_t capacity = 1 << 16;
+            while(capacity < m_high_water * ranges_in_flight)
+                capacity *= 2;
+
+            // generate the new name first, so that it always differs from the old one
+            GLuint buffer;
+            glGenBuffers(1, &buffer);
+            if(m_buffer) {
+                if(m_mapped) {
+                    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+                    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+                    m_mapped = nullptr;
+                }
+                glDeleteBuffers(1, &m_buffer);
+            }
+
+            m_buffer = buffer;
+            m_capacity = capacity;
+            m_head = 0;
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+            if(m_persistent) {
+                constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                glBufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(m_capacity), nullptr, flags);
+                m_mapped = static_cast<uint8_t*>(
+                    glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(m_capacity), flags));
+            } else
+                glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(m_capacity), nullptr, GL_STREAM_DRAW);
+        }
+
+    public:
+        explicit stream_buffer(const bool persistent) : m_persistent{ persistent } {}
+        stream_buffer(const stream_buffer&) = delete;
+        stream_buffer(stream_buffer&&) = delete;
+        stream_buffer& operator=(const stream_buffer&) = delete;
+        stream_buffer& operator=(stream_buffer&&) = delete;
+        ~stream_buffer() {
+            release_fences();
+            if(m_buffer) {
+                if(m_mapped) {
+                    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+                    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+                }
+                glDeleteBuffers(1, &m_buffer);
+            }
+        }
+
+        [[nodiscard]] GLuint name() const noexcept {
+            return m_buffer;
+        }
+
+        // Returns a writable pointer to size bytes at offset of the buffer. The range stays valid until commit.
+        [[nodiscard]] uint8_t* allocate(size_t size, size_t& offset) {
+            size = (std::max(size, static_cast<size_t>(1)) + alignment - 1) / alignment * alignment;
+
+            // the last upload was never drawn, so its range can be reused right away
+            if(!m_in_flight.empty() && !m_in_flight.back().fence) {
+                m_head = m_in_flight.back().begin;
+                m_in_flight.pop_back();
+            }
+
+            m_high_water = std::max(m_high_water, size);
+            if(m_high_water * ranges_in_flight > m_capacity)
+                reallocate();
+
+            auto begin = m_head;
+            if(begin + size > m_capacity) {
+                if(m_persistent) {
+                    // the skipped tail [m_head, m_capacity) is released together with the head of the ring
+                    while(!m_in_flight.empty() && m_in_flight.front().begin >= m_head) {
+                        wait(m_in_flight.front().fence);
+                        m_in_flight.pop_front();
+                    }
+                } else {
+                    // orphan the storage, the driver keeps the old one alive until the GPU has finished with it
+                    release_fences();
+                    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+                    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(m_capacity), nullptr, GL_STREAM_DRAW);
+                }
+                begin = 0;
+            }
+
+            // the ranges are ordered by age, so the ones overlapping the new range are at the front
+            while(!m_in_flight.empty() && m_in_flight.front().begin < begin + size && m_in_flight.front().end > begin) {
+                wait(m_in_flight.front().fence);
+                m_in_flight.pop_front();
+            }
+
+            m_in_flight.push_back({ begin, begin + size, nullptr });
+            m_head = begin + size;
+            offset = begin;
+
+            if(m_persistent)
+                return m_mapped + begin;
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+            return static_cast<uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(begin),
+                                                          static_cast<GLsizeiptr>(size),
+                                                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                                                              GL_MAP_UNSYNCHRONIZED_BIT));
+        }
+
+        void commit() {
+            if(!m_persistent) {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+                glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            }
+        }
+
+        // Called after the draw calls reading the last allocated range have been submitted.
+        void fence() {
+            if(m_in_flight.empty())
+                return;
+            auto& last = m_in_flight.back().fence;
+            // a range drawn again is protected by the newest fence only
+            if(last)
+                glDeleteSync(last);
+            last = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+    };
+
     class render_backend_impl final : public render_backend {
+        // positions of the uploaded streams in the ring buffer, in units of their element types
+        struct stream_offsets final {
+            uint32_t vertices, indices, instances;
+        };
+
         std::pmr::vector<command> m_command_list;
+        stream_offsets m_stream_offsets = {};
         GLuint m_program_id;
-        GLuint m_vbo;
+        GLuint m_quad_program_id;
+        GLint m_size_location;
+        GLint m_quad_size_location;
+        stream_buffer m_stream;
         GLuint m_vao;
+        GLuint m_vao_buffer;
+        GLuint m_quad_vao;
+        GLuint m_fbo;
         texture_impl m_empty;
         vec2 m_window_size;
 
         bool m_dirty = false;
+        bool m_premultiplied_blend = false;
         bool m_scissor_restricted = false;
         GLuint m_bind_tex = 0;
+        GLuint m_bind_program = 0;
+        float m_point_size = 0.0f;
+        std::array<GLint, 4> m_scissor = {};
+
+        // consecutive draws sharing the same program, texture, scissor and mode, submitted with one glMultiDraw* call
+        struct draw_batch final {
+            GLenum mode = 0;
+            bool indexed = false;
+            // the first vertex of glMultiDrawArrays, or the base vertex of glMultiDrawElementsBaseVertex
+            std::vector<GLint> firsts;
+            std::vector<GLsizei> counts;
+            std::vector<const void*> indices;
+        } m_batch;
 
         uint64_t m_render_time = 0;
+        uint64_t m_emit_finish_time = 0;
+        uint64_t m_upload_time = 0;
+        uint64_t m_pending_upload_time = 0;
 
         static void check_compile_errors(const GLuint shader, const std::string_view type) {
             GLint success;
@@ -164,8 +394,7 @@ namespace animgui {
         }
 
         static GLenum get_mode(const primitive_type type) noexcept {
-            // ReSharper disable once CppIncompleteSwitchStatement CppDefaultCaseNotHandledInSwitchStatement
-            switch(type) {  // NOLINT(clang-diagnostic-switch)
+            switch(type) {
                 case primitive_type::points:
                     return GL_POINTS;
                 case primitive_type::triangles:
@@ -176,85 +405,255 @@ namespace animgui {
                     return GL_TRIANGLE_STRIP;
                 case primitive_type::quads:
                     return GL_QUADS;
+                case primitive_type::quad_instances:
+                    // every instance is drawn as a strip of four vertices
+                    return GL_TRIANGLE_STRIP;
+                case primitive_type::lines:
+                case primitive_type::line_strip:
+                case primitive_type::line_loop:
+                    // not supported, expanded into triangles by the context
+                    break;
             }
             return 0;
         }
 
+        static GLuint link_program(const char* const vert_src, const char* const frag_src) {
+            const unsigned int shader_vert = glCreateShader(GL_VERTEX_SHADER);
+            glShaderSource(shader_vert, 1, &vert_src, nullptr);
+            glCompileShader(shader_vert);
+            check_compile_errors(shader_vert, "VERTEX"sv);
+
+            const unsigned int shader_frag = glCreateShader(GL_FRAGMENT_SHADER);
+            glShaderSource(shader_frag, 1, &frag_src, nullptr);
+            glCompileShader(shader_frag);
+            check_compile_errors(shader_frag, "FRAGMENT"sv);
+
+            const auto program = glCreateProgram();
+            glAttachShader(program, shader_vert);
+            glAttachShader(program, shader_frag);
+            glLinkProgram(program);
+            check_compile_errors(program, "PROGRAM"sv);
+
+            glDeleteShader(shader_vert);
+            glDeleteShader(shader_frag);
+            return program;
+        }
+
         void make_dirty() {
             m_dirty = true;
             m_scissor_restricted = true;
             m_bind_tex = std::numeric_limits<uint32_t>::max();
+            m_bind_program = 0;
+            m_point_size = 0.0f;
+        }
+
+        // The alpha channel is blended as src + dst * (1 - src), which keeps it meaningful in offscreen targets.
+        // The factor color of a premultiplied texture should be premultiplied as well.
+        void set_blend(const bool premultiplied) {
+            glBlendFuncSeparate(premultiplied ? GL_ONE : GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            m_premultiplied_blend = premultiplied;
+        }
+
+        void flush_batch() {
+            if(m_batch.counts.empty())
+                return;
+
+            const auto size = static_cast<GLsizei>(m_batch.counts.size());
+            if(m_batch.indexed)
+                glMultiDrawElementsBaseVertex(m_batch.mode, m_batch.counts.data(), GL_UNSIGNED_INT, m_batch.indices.data(), size,
+                                              m_batch.firsts.data());
+            else
+                glMultiDrawArrays(m_batch.mode, m_batch.firsts.data(), m_batch.counts.data(), size);
+
+            m_batch.firsts.clear();
+            m_batch.counts.clear();
+            m_batch.indices.clear();
         }
 
-        void emit(const native_callback& callback, uint32_t&) {
+        void emit(const native_callback& callback, uint32_t&, uint32_t&, uint32_t&) {
+            flush_batch();
             callback();
             make_dirty();
         }
 
-        void emit(const primitives& primitives, uint32_t& vertices_offset) {
-            auto&& [type, vertices_count, tex, point_line_size] = primitives;
+        void emit(const primitives& primitives, uint32_t& vertices_offset, uint32_t& indices_offset,
+                  uint32_t& instances_offset) {
+            auto&& [type, vertices_count, tex, point_line_size, indices_count, instances_count] = primitives;
+
+            const auto instanced = type == primitive_type::quad_instances;
+            const auto program = instanced ? m_quad_program_id : m_program_id;
+            const auto tex_id = static_cast<GLuint>((tex ? tex.get() : &m_empty)->native_handle());
+            const auto mode = get_mode(type);
+            const auto indexed = indices_count != 0;
+            const auto point_size_changed = type == primitive_type::points && point_line_size != m_point_size;
+            const auto premultiplied = tex && static_cast<const texture_impl&>(*tex).premultiplied();
+            if(instanced || program != m_bind_program || tex_id != m_bind_tex || point_size_changed ||
+               mode != m_batch.mode || indexed != m_batch.indexed)
+                flush_batch();
 
             if(m_dirty) {
                 glEnable(GL_BLEND);
                 glDisable(GL_DEPTH_TEST);
                 glDisable(GL_CULL_FACE);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
                 glBlendEquation(GL_FUNC_ADD);
-
-                glUseProgram(m_program_id);
-                glUniform2f(glGetUniformLocation(m_program_id, "size"), m_window_size.x, m_window_size.y);
-                glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-                glBindVertexArray(m_vao);
                 glActiveTexture(GL_TEXTURE0);
+                set_blend(premultiplied);
 
                 m_dirty = false;
+            } else if(premultiplied != m_premultiplied_blend)
+                set_blend(premultiplied);
+
+            if(program != m_bind_program) {
+                glUseProgram(program);
+                glUniform2f(instanced ? m_quad_size_location : m_size_location, m_window_size.x, m_window_size.y);
+                glBindBuffer(GL_ARRAY_BUFFER, m_stream.name());
+                glBindVertexArray(instanced ? m_quad_vao : m_vao);
+                m_bind_program = program;
             }
 
-            if(type == primitive_type::points)
+            if(point_size_changed) {
                 glPointSize(point_line_size);
+                m_point_size = point_line_size;
+            }
 
-            if(auto cmd_tex = tex ? tex.get() : &m_empty; static_cast<GLuint>(cmd_tex->native_handle()) != m_bind_tex) {
-                cmd_tex->generate_mipmap();
-                m_bind_tex = static_cast<GLuint>(cmd_tex->native_handle());
+            // the mipmaps have been generated by the pre-pass in draw
+            if(tex_id != m_bind_tex) {
+                m_bind_tex = tex_id;
                 glBindTexture(GL_TEXTURE_2D, m_bind_tex);
             }
 
-            glDrawArrays(get_mode(type), vertices_offset, vertices_count);
+            if(instanced) {
+                // OpenGL 3.3 has no base instance, the attributes are pointed at the first instance of the command instead
+                const auto base = static_cast<size_t>(instances_offset) * sizeof(quad_instance);
+                glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(quad_instance),
+                                      reinterpret_cast<void*>(base + offset_u32(&quad_instance::rect)));
+                glVertexAttribPointer(1, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(quad_instance),
+                                      reinterpret_cast<void*>(base + offset_u32(&quad_instance::tex_min)));
+                glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(quad_instance),
+                                      reinterpret_cast<void*>(base + offset_u32(&quad_instance::color)));
+                glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(instances_count));
+                instances_offset += instances_count;
+                return;
+            }
+
+            m_batch.mode = mode;
+            m_batch.indexed = indexed;
+            m_batch.firsts.push_back(static_cast<GLint>(vertices_offset));
+            if(indexed) {
+                m_batch.counts.push_back(static_cast<GLsizei>(indices_count));
+                m_batch.indices.push_back(reinterpret_cast<void*>(static_cast<size_t>(indices_offset) * sizeof(uint32_t)));
+                indices_offset += indices_count;
+            } else
+                m_batch.counts.push_back(static_cast<GLsizei>(vertices_count));
             vertices_offset += vertices_count;
         }
 
-    public:
-        render_backend_impl() : m_vbo{ 0 }, m_vao{ 0 }, m_empty{ channel::rgba, uvec2{ 1, 1 } }, m_window_size{ 0.0f, 0.0f } {
-            const unsigned int shader_vert = glCreateShader(GL_VERTEX_SHADER);
-            glShaderSource(shader_vert, 1, &shader_vert_src, nullptr);
-            glCompileShader(shader_vert);
-            check_compile_errors(shader_vert, "VERTEX"sv);
+        [[nodiscard]] stream_offsets upload(const command_queue& command_list) {
+            const auto tp1 = current_time();
 
-            const unsigned int shader_frag = glCreateShader(GL_FRAGMENT_SHADER);
-            glShaderSource(shader_frag, 1, &shader_frag_src, nullptr);
-            glCompileShader(shader_frag);
-            check_compile_errors(shader_frag, "FRAGMENT"sv);
+            const auto vertices_size = command_list.vertices.size() * sizeof(vertex);
+            const auto indices_size = command_list.indices.size() * sizeof(uint32_t);
+            const auto instances_size = command_list.instances.size() * sizeof(quad_instance);
+
+            // the ring buffer hands out ranges aligned to sizeof(vertex), the instances need to be realigned
+            size_t begin;
+            const auto ptr = m_stream.allocate(vertices_size + indices_size + sizeof(quad_instance) + instances_size, begin);
+            const auto indices_begin = begin + vertices_size;
+            const auto instances_begin =
+                (indices_begin + indices_size + sizeof(quad_instance) - 1) / sizeof(quad_instance) * sizeof(quad_instance);
+            memcpy(ptr, command_list.vertices.data(), vertices_size);
+            memcpy(ptr + (indices_begin - begin), command_list.indices.data(), indices_size);
+            memcpy(ptr + (instances_begin - begin), command_list.instances.data(), instances_size);
+            m_stream.commit();
+
+            // a grown ring buffer is a new buffer object, which has to be attached to the vertex array again
+            if(m_stream.name() != m_vao_buffer) {
+                m_vao_buffer = m_stream.name();
+                glBindVertexArray(m_vao);
+                glBindBuffer(GL_ARRAY_BUFFER, m_vao_buffer);
+                glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), offset(&vertex::pos));
+                glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(vertex), offset(&vertex::tex_coord));
+                glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(vertex), offset(&vertex::color));
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vao_buffer);
+                glBindVertexArray(0);
+            }
 
-            m_program_id = glCreateProgram();
-            glAttachShader(m_program_id, shader_vert);
-            glAttachShader(m_program_id, shader_frag);
-            glLinkProgram(m_program_id);
-            check_compile_errors(m_program_id, "PROGRAM"sv);
+            m_pending_upload_time += current_time() - tp1;
+            return { static_cast<uint32_t>(begin / sizeof(vertex)), static_cast<uint32_t>(indices_begin / sizeof(uint32_t)),
+                     static_cast<uint32_t>(instances_begin / sizeof(quad_instance)) };
+        }
 
-            glDeleteShader(shader_vert);
-            glDeleteShader(shader_frag);
+        void draw(const std::pmr::vector<command>& command_list, const stream_offsets offsets, const uvec2 screen_size) {
+            // generate the mipmaps of all dirty textures up front, so that the draw loop only binds them
+            for(auto&& command : command_list)
+                if(const auto desc = std::get_if<primitives>(&command.desc); desc && desc->tex)
+                    desc->tex->generate_mipmap();
+            m_empty.generate_mipmap();
+
+            glEnable(GL_SCISSOR_TEST);
+            make_dirty();
+            m_scissor_restricted = true;
+            m_batch.mode = 0;
 
-            glGenBuffers(1, &m_vbo);
-            glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+            auto [vertices_offset, indices_offset, instances_offset] = offsets;
+
+            const vec2 scale = { static_cast<float>(screen_size.x) / m_window_size.x,
+                                 static_cast<float>(screen_size.y) / m_window_size.y };
+
+            // ReSharper disable once CppUseStructuredBinding
+            for(auto&& command : command_list) {
+                if(command.clip.has_value()) {
+                    const auto clip = command.clip.value();
+                    const int left = static_cast<int>(std::floor(clip.left * scale.x));
+                    const int right = static_cast<int>(std::ceil(clip.right * scale.x));
+                    const int bottom = static_cast<int>(std::ceil(clip.bottom * scale.y));
+                    const int top = static_cast<int>(std::floor(clip.top * scale.y));
+
+                    if(const std::array<GLint, 4> scissor = { left, static_cast<GLint>(screen_size.y) - bottom, right - left,
+                                                              bottom - top };
+                       !m_scissor_restricted || scissor != m_scissor || m_dirty) {
+                        flush_batch();
+                        glScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+                        m_scissor = scissor;
+                    }
+                    m_scissor_restricted = true;
+                } else {
+                    if(m_scissor_restricted) {
+                        flush_batch();
+                        glScissor(0, 0, screen_size.x, screen_size.y);
+                        m_scissor_restricted = false;
+                    }
+                }
 
+                std::visit([&](auto&& item) { emit(item, vertices_offset, indices_offset, instances_offset); }, command.desc);
+            }
+            flush_batch();
+
+            m_stream.fence();
+        }
+
+    public:
+        render_backend_impl()
+            : m_stream{ GLEW_ARB_buffer_storage != 0 }, m_vao{ 0 }, m_vao_buffer{ 0 }, m_quad_vao{ 0 }, m_fbo{ 0 },
+              m_empty{ channel::rgba, uvec2{ 1, 1 } }, m_window_size{ 0.0f, 0.0f } {
+            m_program_id = link_program(shader_vert_src, shader_frag_src);
+            m_quad_program_id = link_program(shader_quad_vert_src, shader_frag_src);
+            m_size_location = glGetUniformLocation(m_program_id, "size");
+            m_quad_size_location = glGetUniformLocation(m_quad_program_id, "size");
+
+            // the attribute pointers are set once the ring buffer is allocated by the first upload
             glGenVertexArrays(1, &m_vao);
             glBindVertexArray(m_vao);
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), offset(&vertex::pos));
-            glEnableVertexAttribArray(1);
-            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), offset(&vertex::tex_coord));
-            glEnableVertexAttribArray(2);
-            glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(vertex), offset(&vertex::color));
+            for(GLuint idx = 0; idx < 3; ++idx)
+                glEnableVertexAttribArray(idx);
+
+            // the attribute pointers are set per draw call
+            glGenVertexArrays(1, &m_quad_vao);
+            glBindVertexArray(m_quad_vao);
+            for(GLuint idx = 0; idx < 3; ++idx) {
+                glEnableVertexAttribArray(idx);
+                glVertexAttribDivisor(idx, 1);
+            }
             glBindBuffer(GL_ARRAY_BUFFER, 0);
             glBindVertexArray(0);
 
@@ -267,16 +666,18 @@ namespace animgui {
         render_backend_impl& operator=(render_backend_impl&&) = delete;
         ~render_backend_impl() override {
             glDeleteProgram(m_program_id);
+            glDeleteProgram(m_quad_program_id);
             glDeleteVertexArrays(1, &m_vao);
-            glDeleteBuffers(1, &m_vbo);
+            glDeleteVertexArrays(1, &m_quad_vao);
+            if(m_fbo)
+                glDeleteFramebuffers(1, &m_fbo);
         }
 
         void update_command_list(const uvec2 window_size, command_queue command_list) override {
             m_window_size = { static_cast<float>(window_size.x), static_cast<float>(window_size.y) };
-
-            glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-            glBufferData(GL_ARRAY_BUFFER, command_list.vertices.size() * sizeof(vertex), command_list.vertices.data(),
-                         GL_STREAM_DRAW);
+            m_stream_offsets = upload(command_list);
+            // also covers the uploads of render_to_texture, which happen earlier in the same frame
+            m_upload_time = std::exchange(m_pending_upload_time, 0);
 
             m_command_list.clear();
             m_command_list.reserve(command_list.commands.size());
@@ -296,49 +697,76 @@ namespace animgui {
 
         void emit(const uvec2 screen_size) override {
             const auto tp1 = current_time();
+            draw(m_command_list, m_stream_offsets, screen_size);
+            const auto tp2 = current_time();
+            m_render_time = tp2 - tp1;
+            m_emit_finish_time = tp2;
+        }
 
-            glEnable(GL_SCISSOR_TEST);
-            make_dirty();
-            m_scissor_restricted = true;
-
-            uint32_t vertices_offset = 0;
-
-            const vec2 scale = { static_cast<float>(screen_size.x) / m_window_size.x,
-                                 static_cast<float>(screen_size.y) / m_window_size.y };
+        [[nodiscard]] bool offscreen_supported() const noexcept override {
+            return true;
+        }
 
-            // ReSharper disable once CppUseStructuredBinding
-            for(auto&& command : m_command_list) {
+        void render_to_texture(texture& target, const uvec2 size, command_queue command_list) override {
+            // The first row of a texture is the top of the image, while framebuffers start from the bottom row.
+            const auto height = static_cast<float>(size.y);
+            for(auto&& vert : command_list.vertices)
+                vert.pos.y = height - vert.pos.y;
+            // Each edge is mirrored on its own, so that the corners keep their texture coordinates like the vertices above.
+            // top > bottom afterwards, which the quad program doesn't care about.
+            for(auto&& instance : command_list.instances) {
+                instance.rect.top = height - instance.rect.top;
+                instance.rect.bottom = height - instance.rect.bottom;
+            }
+            for(auto&& command : command_list.commands)
                 if(command.clip.has_value()) {
-                    const auto clip = command.clip.value();
-                    const int left = static_cast<int>(std::floor(clip.left * scale.x));
-                    const int right = static_cast<int>(std::ceil(clip.right * scale.x));
-                    const int bottom = static_cast<int>(std::ceil(clip.bottom * scale.y));
-                    const int top = static_cast<int>(std::floor(clip.top * scale.y));
-
-                    glScissor(left, screen_size.y - bottom, right - left, bottom - top);
-                    m_scissor_restricted = true;
-                } else {
-                    if(m_scissor_restricted) {
-                        glScissor(0, 0, screen_size.x, screen_size.y);
-                        m_scissor_restricted = false;
-                    }
+                    auto& clip = command.clip.value();
+                    clip = { clip.left, clip.right, height - clip.bottom, height - clip.top };
                 }
 
-                std::visit([&](auto&& item) { emit(item, vertices_offset); }, command.desc);
-            }
-
-            const auto tp2 = current_time();
-            m_render_time = tp2 - tp1;
+            GLint last_framebuffer, last_viewport[4];
+            GLfloat last_clear_color[4];
+            glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &last_framebuffer);
+            glGetIntegerv(GL_VIEWPORT, last_viewport);
+            glGetFloatv(GL_COLOR_CLEAR_VALUE, last_clear_color);
+
+            if(!m_fbo)
+                glGenFramebuffers(1, &m_fbo);
+            glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                                   static_cast<GLuint>(target.native_handle()), 0);
+            glViewport(0, 0, static_cast<GLsizei>(size.x), static_cast<GLsizei>(size.y));
+            glDisable(GL_SCISSOR_TEST);
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            const auto window_size = m_window_size;
+            m_window_size = { static_cast<float>(size.x), height };
+            draw(command_list.commands, upload(command_list), size);
+            m_window_size = window_size;
+
+            glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(last_framebuffer));
+            glViewport(last_viewport[0], last_viewport[1], last_viewport[2], last_viewport[3]);
+            glClearColor(last_clear_color[0], last_clear_color[1], last_clear_color[2], last_clear_color[3]);
+            static_cast<texture_impl&>(target).mark_dirty();
+            static_cast<texture_impl&>(target).mark_premultiplied();
         }
         [[nodiscard]] primitive_type supported_primitives() const noexcept override {
             // Notice: Wide lines (width>1.0) in OpenGL3 are deprecated.
             return primitive_type::points | primitive_type::quads | primitive_type::triangle_fan |
-                primitive_type::triangle_strip | primitive_type::triangles;
+                primitive_type::triangle_strip | primitive_type::triangles | primitive_type::quad_instances;
         }
 
         [[nodiscard]] uint64_t render_time() const noexcept override {
             return m_render_time;
         }
+        [[nodiscard]] uint64_t emit_finish_time() const noexcept override {
+            return m_emit_finish_time;
+        }
+
+        [[nodiscard]] uint64_t upload_time() const noexcept override {
+            return m_upload_time;
+        }
     };
 
     ANIMGUI_API std::shared_ptr<render_backend> create_opengl3_backend() {
@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: MIT
+#version 450 core
+
+layout (location = 0) in vec4 rect;
+layout (location = 1) in vec4 tex_rect;
+layout (location = 2) in vec4 color;
+
+layout (location = 0) out vec2 f_tex_coord;
+layout (location = 1) out vec4 f_color;
+
+layout(constant_id = 0) const float size_x = 1.0f;
+layout(constant_id = 1) const float size_y = 1.0f;
+
+// the quad is drawn as the triangle strip (left, top), (left, bottom), (right, top), (right, bottom)
+void main() {
+    bool right = gl_VertexIndex >= 2;
+    bool bottom = (gl_VertexIndex & 1) == 1;
+    vec2 pos = vec2(right ? rect.y : rect.x, bottom ? rect.w : rect.z);
+    gl_Position = vec4(pos.x/size_x*2.0f-1.0f,pos.y/size_y*2.0f-1.0f, 0.0f, 1.0f);
+    f_tex_coord = vec2(right ? tex_rect.z : tex_rect.x, bottom ? tex_rect.w : tex_rect.y);
+    f_color = color;
+}
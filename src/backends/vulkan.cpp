@@ -1,8 +1,9 @@
 // SPDX-License-Identifier: MIT
 
 #include <animgui/backends/vulkan.hpp>
+#include <algorithm>
 #include <animgui/core/render_backend.hpp>
-#include <queue>
+#include <vector>
 
 // TODO: https://zeux.io/2020/02/27/writing-an-efficient-vulkan-renderer/
 
@@ -18,6 +19,11 @@ namespace animgui {
 #include "frag.spv.hpp"
         ;
 
+    static const uint32_t quad_vert_spv[] =
+    // ReSharper disable once CppUnusedIncludeDirective
+#include "quad.vert.spv.hpp"
+        ;
+
     using buffer_pair = std::pair<vk::UniqueBuffer, vk::UniqueDeviceMemory>;
 
     [[nodiscard]] uint32_t find_memory_index(const vk::PhysicalDeviceMemoryProperties& memory_prop,
@@ -41,27 +47,120 @@ namespace animgui {
         return std::make_pair(std::move(buffer), std::move(memory));
     }
 
-    void update_buffer(vk::Device& device, const buffer_pair& buffer, const void* src, const size_t size) {
-        const auto ptr = device.mapMemory(buffer.second.get(), 0, size, {});
-        memcpy(ptr, src, size);
-        device.unmapMemory(buffer.second.get());
-    }
+    class texture_impl;
+
+    // Collects the texture updates into one persistently mapped staging buffer. They are recorded together with the mipmap
+    // generation into a single submission of the synchronized executor, once per frame instead of once per update.
+    class texture_uploader final {
+        // a multiple of the texel sizes 1, 3 and 4, as required by vkCmdCopyBufferToImage
+        static constexpr size_t alignment = 12;
+
+        vk::Device& m_device;
+        const vk::PhysicalDeviceMemoryProperties& m_memory_prop;
+        const synchronized_executor& m_synchronized_transfer;
+
+        buffer_pair m_staging;
+        size_t m_staging_size = 0;
+        size_t m_staging_used = 0;
+        uint8_t* m_staging_ptr = nullptr;
+        // staging buffers replaced by a larger one, which are still referenced by the pending copies
+        std::vector<buffer_pair> m_retired;
+        std::vector<texture_impl*> m_pending;
+
+    public:
+        texture_uploader(vk::Device& device, const vk::PhysicalDeviceMemoryProperties& memory_prop,
+                         const synchronized_executor& synchronized_transfer)
+            : m_device{ device }, m_memory_prop{ memory_prop }, m_synchronized_transfer{ synchronized_transfer } {}
+
+        // Copies the data into the staging buffer and returns its location.
+        std::pair<vk::Buffer, vk::DeviceSize> stage(const void* data, const size_t size) {
+            auto offset = (m_staging_used + alignment - 1) / alignment * alignment;
+            if(offset + size > m_staging_size) {
+                if(m_staging.first)
+                    m_retired.push_back(std::move(m_staging));
+                m_staging_size = std::max(std::max(m_staging_size * 2, static_cast<size_t>(1) << 20), size);
+                m_staging = allocate_buffer(m_device, m_memory_prop, m_staging_size, vk::BufferUsageFlagBits::eTransferSrc,
+                                            vk::MemoryPropertyFlagBits::eHostCoherent |
+                                                vk::MemoryPropertyFlagBits::eHostVisible);
+                m_staging_ptr = static_cast<uint8_t*>(m_device.mapMemory(m_staging.second.get(), 0, m_staging_size, {}));
+                offset = 0;
+            }
+
+            memcpy(m_staging_ptr + offset, data, size);
+            m_staging_used = offset + size;
+            return { m_staging.first.get(), offset };
+        }
+        void enqueue(texture_impl* texture) {
+            m_pending.push_back(texture);
+        }
+        void cancel(texture_impl* texture) {
+            m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), texture), m_pending.end());
+        }
+        void flush();
+    };
+
+    // Hands out one combined image sampler descriptor set per image view. A new pool is created when all pools are full, so
+    // descriptor sets never have to be recycled while a command buffer may still use them.
+    class descriptor_allocator final {
+        static constexpr uint32_t sets_per_pool = 64;
+
+        vk::Device& m_device;
+        const vk::UniqueDescriptorSetLayout& m_layout;
+        const vk::UniqueSampler& m_sampler;
+        std::vector<vk::UniqueDescriptorPool> m_pools;
+
+        [[nodiscard]] vk::UniqueDescriptorSet allocate_from(const vk::DescriptorPool pool) const {
+            const auto layout = m_layout.get();
+            return std::move(m_device.allocateDescriptorSetsUnique(vk::DescriptorSetAllocateInfo{ pool, 1, &layout }).front());
+        }
+
+    public:
+        descriptor_allocator(vk::Device& device, const vk::UniqueDescriptorSetLayout& layout, const vk::UniqueSampler& sampler)
+            : m_device{ device }, m_layout{ layout }, m_sampler{ sampler } {}
+
+        [[nodiscard]] vk::UniqueDescriptorSet allocate(const vk::ImageView image_view) {
+            vk::UniqueDescriptorSet set;
+            // the pools freed by destroyed textures are reused before creating a new one
+            for(auto iter = m_pools.rbegin(); iter != m_pools.rend() && !set; ++iter) {
+                try {
+                    set = allocate_from(iter->get());
+                } catch(const vk::OutOfPoolMemoryError&) {
+                } catch(const vk::FragmentedPoolError&) {
+                }
+            }
+            if(!set) {
+                const vk::DescriptorPoolSize pool_size{ vk::DescriptorType::eCombinedImageSampler, sets_per_pool };
+                m_pools.push_back(m_device.createDescriptorPoolUnique(vk::DescriptorPoolCreateInfo{
+                    vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, sets_per_pool, 1, &pool_size }));
+                set = allocate_from(m_pools.back().get());
+            }
+
+            const vk::DescriptorImageInfo image_info{ m_sampler.get(), image_view, vk::ImageLayout::eShaderReadOnlyOptimal };
+            const vk::WriteDescriptorSet write_descriptor_set{
+                set.get(), 0, 0, 1, vk::DescriptorType::eCombinedImageSampler, &image_info, nullptr, nullptr
+            };
+            m_device.updateDescriptorSets(1, &write_descriptor_set, 0, nullptr);
+            return set;
+        }
+    };
 
-    // TODO: mipmap
     class texture_impl final : public texture {
         uvec2 m_size;
         channel m_channel;
         vk::Device& m_device;
         const vk::PhysicalDeviceMemoryProperties& m_memory_prop;
-        const synchronized_executor& m_synchronized_transfer;
+        texture_uploader& m_uploader;
+        descriptor_allocator& m_descriptor_allocator;
 
         std::function<void(vk::Result)>& m_error_report;
         vk::UniqueImage m_image;
         vk::UniqueDeviceMemory m_image_memory;
         vk::UniqueImageView m_image_view;
+        vk::UniqueDescriptorSet m_descriptor_set;
         uint32_t m_mip_level;
 
-        bool m_dirty = false;
+        std::vector<vk::BufferImageCopy> m_copies;
+        std::vector<vk::Buffer> m_copy_sources;
         bool m_first_update = true;
 
         static vk::Format get_format(const channel channel) noexcept {
@@ -94,13 +193,12 @@ namespace animgui {
         }
 
     public:
-        texture_impl(vk::Device& device, const synchronized_executor& synchronized_transfer,
+        texture_impl(vk::Device& device, texture_uploader& uploader, descriptor_allocator& descriptors,
                      std::function<void(vk::Result)>& error_report, const vk::PhysicalDeviceMemoryProperties& memory_prop,
                      const uvec2 size, const channel image_channel)
             : m_size{ size }, m_channel{ image_channel }, m_device{ device }, m_memory_prop{ memory_prop },
-              m_synchronized_transfer{ synchronized_transfer }, m_error_report{ error_report }, m_mip_level{
-                  calculate_mipmap_level(size)
-              } {
+              m_uploader{ uploader }, m_descriptor_allocator{ descriptors }, m_error_report{ error_report },
+              m_mip_level{ calculate_mipmap_level(size) } {
             const auto format = get_format(image_channel);
 
             m_image = device.createImageUnique(vk::ImageCreateInfo{
@@ -124,121 +222,131 @@ namespace animgui {
             device.bindImageMemory(m_image.get(), m_image_memory.get(), 0);
             create_image_view(m_image.get(), format);
         }
-        texture_impl(vk::Device& device, const synchronized_executor& synchronized_transfer,
+        texture_impl(vk::Device& device, texture_uploader& uploader, descriptor_allocator& descriptors,
                      std::function<void(vk::Result)>& error_report, const vk::PhysicalDeviceMemoryProperties& memory_prop,
                      const vk::Image image, const uvec2 size, const channel image_channel)
             : m_size{ size }, m_channel{ image_channel }, m_device{ device }, m_memory_prop{ memory_prop },
-              m_synchronized_transfer{ synchronized_transfer }, m_error_report{ error_report }, m_mip_level{
-                  calculate_mipmap_level(size)
-              } {
+              m_uploader{ uploader }, m_descriptor_allocator{ descriptors }, m_error_report{ error_report },
+              m_mip_level{ calculate_mipmap_level(size) } {
             const auto format = get_format(image_channel);
             create_image_view(image, format);
         }
+        texture_impl(const texture_impl&) = delete;
+        texture_impl(texture_impl&&) = delete;
+        texture_impl& operator=(const texture_impl&) = delete;
+        texture_impl& operator=(texture_impl&&) = delete;
+        ~texture_impl() override {
+            if(!m_copies.empty())
+                m_uploader.cancel(this);
+        }
 
         void update_texture(const uvec2 offset, const image_desc& image) override {
             if(image.channels != m_channel)
                 throw std::runtime_error{ "mismatched channel" };
             if(image.size.x == 0 || image.size.y == 0)
                 return;
-            // TODO: shared staging buffer
             const auto size = image.size.x * image.size.y * get_pixel_size(m_channel);
-            const auto temp_staging_buffer =
-                allocate_buffer(m_device, m_memory_prop, size, vk::BufferUsageFlagBits::eTransferSrc,
-                                vk::MemoryPropertyFlagBits::eHostCoherent | vk::MemoryPropertyFlagBits::eHostVisible);
-            update_buffer(m_device, temp_staging_buffer, image.data, size);
-
-            m_synchronized_transfer([&](vk::CommandBuffer& cmd) {
-                const vk::ImageMemoryBarrier enter{
-                    m_first_update ? vk::AccessFlagBits::eNoneKHR :
-                                     (m_dirty ? vk::AccessFlagBits::eTransferWrite : vk::AccessFlagBits::eShaderRead),
-                    vk::AccessFlagBits::eTransferWrite,
-                    m_first_update ? vk::ImageLayout::eUndefined :
-                                     (m_dirty ? vk::ImageLayout::eTransferDstOptimal : vk::ImageLayout::eShaderReadOnlyOptimal),
-                    vk::ImageLayout::eTransferDstOptimal,
-                    VK_QUEUE_FAMILY_IGNORED,
-                    VK_QUEUE_FAMILY_IGNORED,
-                    m_image.get(),
-                    vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0, m_mip_level, 0, 1 }
-                };
-                cmd.pipelineBarrier(m_first_update ? vk::PipelineStageFlagBits::eTopOfPipe :
-                                                     (m_dirty ? vk::PipelineStageFlagBits::eTransfer :
-                                                                vk::PipelineStageFlagBits::eFragmentShader),
-                                    vk::PipelineStageFlagBits::eTransfer, {}, 0, nullptr, 0, nullptr, 1, &enter);
-
-                const vk::BufferImageCopy region{ 0,
-                                                  0,
-                                                  0,
-                                                  { vk::ImageAspectFlagBits::eColor, 0, 0, 1 },
-                                                  vk::Offset3D{ static_cast<int32_t>(offset.x), static_cast<int32_t>(offset.y),
-                                                                0 },
-                                                  vk::Extent3D{ image.size.x, image.size.y, 1 } };
-                cmd.copyBufferToImage(temp_staging_buffer.first.get(), m_image.get(), vk::ImageLayout::eTransferDstOptimal, 1,
-                                      &region);
-            });
-
-            m_first_update = false;
-            m_dirty = true;
+            const auto [buffer, buffer_offset] = m_uploader.stage(image.data, size);
+
+            if(m_copies.empty())
+                m_uploader.enqueue(this);
+            m_copies.push_back(vk::BufferImageCopy{
+                buffer_offset,
+                0,
+                0,
+                { vk::ImageAspectFlagBits::eColor, 0, 0, 1 },
+                vk::Offset3D{ static_cast<int32_t>(offset.x), static_cast<int32_t>(offset.y), 0 },
+                vk::Extent3D{ image.size.x, image.size.y, 1 } });
+            m_copy_sources.push_back(buffer);
         }
 
-        void generate_mipmap() override {
-            if(!m_dirty)
-                return;
+        // Records the pending copies and regenerates the mipmap chain.
+        void record_upload(vk::CommandBuffer& cmd) {
+            const vk::ImageMemoryBarrier enter{
+                m_first_update ? vk::AccessFlagBits::eNoneKHR : vk::AccessFlagBits::eShaderRead,
+                vk::AccessFlagBits::eTransferWrite,
+                m_first_update ? vk::ImageLayout::eUndefined : vk::ImageLayout::eShaderReadOnlyOptimal,
+                vk::ImageLayout::eTransferDstOptimal,
+                VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED,
+                m_image.get(),
+                vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0, m_mip_level, 0, 1 }
+            };
+            cmd.pipelineBarrier(m_first_update ? vk::PipelineStageFlagBits::eTopOfPipe :
+                                                 vk::PipelineStageFlagBits::eFragmentShader,
+                                vk::PipelineStageFlagBits::eTransfer, {}, 0, nullptr, 0, nullptr, 1, &enter);
+
+            for(size_t idx = 0; idx < m_copies.size(); ++idx)
+                cmd.copyBufferToImage(m_copy_sources[idx], m_image.get(), vk::ImageLayout::eTransferDstOptimal, 1,
+                                      &m_copies[idx]);
+
+            vk::ImageMemoryBarrier barrier{ {},
+                                            {},
+                                            {},
+                                            {},
+                                            VK_QUEUE_FAMILY_IGNORED,
+                                            VK_QUEUE_FAMILY_IGNORED,
+                                            m_image.get(),
+                                            vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 } };
+
+            int32_t width = m_size.x;
+            int32_t height = m_size.y;
+
+            for(uint32_t i = 1; i < m_mip_level; ++i) {
+                barrier.subresourceRange.baseMipLevel = i - 1;
+                barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+                barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+                barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+                barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
 
-            m_synchronized_transfer([&](vk::CommandBuffer& cmd) {
-                vk::ImageMemoryBarrier barrier{ {},
-                                                {},
-                                                {},
-                                                {},
-                                                VK_QUEUE_FAMILY_IGNORED,
-                                                VK_QUEUE_FAMILY_IGNORED,
-                                                m_image.get(),
-                                                vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 } };
-
-                int32_t width = m_size.x;
-                int32_t height = m_size.y;
-
-                for(uint32_t i = 1; i < m_mip_level; ++i) {
-                    barrier.subresourceRange.baseMipLevel = i - 1;
-                    barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-                    barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
-                    barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-                    barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
-
-                    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, 0,
-                                        nullptr, 0, nullptr, 1, &barrier);
-                    const auto next_width = std::max(1, width / 2);
-                    const auto next_height = std::max(1, height / 2);
-
-                    const vk::ImageBlit blit{ { vk::ImageAspectFlagBits::eColor, i - 1, 0, 1 },
-                                              { { { 0, 0, 0 }, { width, height, 1 } } },
-                                              { vk::ImageAspectFlagBits::eColor, i, 0, 1 },
-                                              { { { 0, 0, 0 }, { next_width, next_height, 1 } } } };
-
-                    cmd.blitImage(m_image.get(), vk::ImageLayout::eTransferSrcOptimal, m_image.get(),
-                                  vk::ImageLayout::eTransferDstOptimal, 1, &blit, vk::Filter::eLinear);
-
-                    barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
-                    barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-                    barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
-                    barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-                    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, 0,
-                                        nullptr, 0, nullptr, 1, &barrier);
-
-                    width = next_width;
-                    height = next_height;
-                }
+                cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, 0,
+                                    nullptr, 0, nullptr, 1, &barrier);
+                const auto next_width = std::max(1, width / 2);
+                const auto next_height = std::max(1, height / 2);
 
-                barrier.subresourceRange.baseMipLevel = m_mip_level - 1;
-                barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+                const vk::ImageBlit blit{ { vk::ImageAspectFlagBits::eColor, i - 1, 0, 1 },
+                                          { { { 0, 0, 0 }, { width, height, 1 } } },
+                                          { vk::ImageAspectFlagBits::eColor, i, 0, 1 },
+                                          { { { 0, 0, 0 }, { next_width, next_height, 1 } } } };
+
+                cmd.blitImage(m_image.get(), vk::ImageLayout::eTransferSrcOptimal, m_image.get(),
+                              vk::ImageLayout::eTransferDstOptimal, 1, &blit, vk::Filter::eLinear);
+
+                barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
                 barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-                barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+                barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
                 barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+
                 cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, 0,
                                     nullptr, 0, nullptr, 1, &barrier);
-            });
 
-            m_dirty = false;
+                width = next_width;
+                height = next_height;
+            }
+
+            barrier.subresourceRange.baseMipLevel = m_mip_level - 1;
+            barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+            barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+            barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+            barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, 0,
+                                nullptr, 0, nullptr, 1, &barrier);
+
+            m_copies.clear();
+            m_copy_sources.clear();
+            m_first_update = false;
+        }
+
+        void generate_mipmap() override {
+            // the mipmap chain is generated together with the batched copies
+            if(!m_copies.empty())
+                m_uploader.flush();
+        }
+
+        [[nodiscard]] vk::DescriptorSet descriptor_set() {
+            if(!m_descriptor_set)
+                m_descriptor_set = m_descriptor_allocator.allocate(m_image_view.get());
+            return m_descriptor_set.get();
         }
 
         [[nodiscard]] uvec2 texture_size() const noexcept override {
@@ -252,9 +360,22 @@ namespace animgui {
         }
     };
 
-    class render_backend_impl final : public render_backend {
-        static constexpr uint32_t max_textures = 32;
+    void texture_uploader::flush() {
+        if(m_pending.empty())
+            return;
 
+        m_synchronized_transfer([&](vk::CommandBuffer& cmd) {
+            for(const auto texture : m_pending)
+                texture->record_upload(cmd);
+        });
+
+        // the executor waits for the submission, so the staging memory can be reused right away
+        m_pending.clear();
+        m_retired.clear();
+        m_staging_used = 0;
+    }
+
+    class render_backend_impl final : public render_backend {
         vk::Device& m_device;
         vk::RenderPass& m_render_pass;
         vk::CommandBuffer& m_command_buffer;
@@ -264,37 +385,19 @@ namespace animgui {
 
         vk::UniqueShaderModule m_vert;
         vk::UniqueShaderModule m_frag;
+        vk::UniqueShaderModule m_quad_vert;
         vk::UniqueSampler m_sampler;
         vk::UniqueDescriptorSetLayout m_descriptor_set_layout;
-        vk::UniqueDescriptorPool m_descriptor_pool;
-
-        std::unordered_map<VkImageView, vk::DescriptorSet> m_texture_binding;
-        std::queue<std::pair<VkImageView, vk::UniqueDescriptorSet>> m_binding_queue;
-        vk::DescriptorSet bind_texture(VkImageView image_view) {
-            if(const auto iter = m_texture_binding.find(image_view); iter != m_texture_binding.cend())
-                return iter->second;
-            auto [old, set] = std::move(m_binding_queue.front());
-            m_binding_queue.pop();
-            m_texture_binding.erase(old);
-            const vk::DescriptorImageInfo image_info{ m_sampler.get(), { image_view }, vk::ImageLayout::eShaderReadOnlyOptimal };
-            const vk::WriteDescriptorSet write_descriptor_set{
-                set.get(), 0, 0, 1, vk::DescriptorType::eCombinedImageSampler, &image_info, nullptr, nullptr
-            };
-            m_device.updateDescriptorSets(1, &write_descriptor_set, 0, nullptr);
-
-            const auto res = set.get();
-            m_binding_queue.push(std::make_pair(image_view, std::move(set)));
-            m_texture_binding.insert(std::make_pair(image_view, res));
-            return res;
-        }
 
         vk::UniquePipelineLayout m_pipeline_layout;
         vk::UniquePipeline m_pipeline;
+        vk::UniquePipeline m_quad_pipeline;
 
         uvec2 m_window_size = {};
         std::pmr::vector<command> m_command_list;
 
         uint64_t m_render_time = 0;
+        uint64_t m_emit_finish_time = 0;
         uvec2 m_last_screen_size = {};
 
         std::function<void(vk::Result)> m_error_report;
@@ -309,6 +412,7 @@ namespace animgui {
             m_device.waitIdle();
 
             m_pipeline.reset();
+            m_quad_pipeline.reset();
             m_pipeline_layout.reset();
 
             const vec2 window_size = { static_cast<float>(m_window_size.x), static_cast<float>(m_window_size.y) };
@@ -320,16 +424,32 @@ namespace animgui {
                 { {}, vk::ShaderStageFlagBits::eVertex, m_vert.get(), "main", &specialization_info },
                 { {}, vk::ShaderStageFlagBits::eFragment, m_frag.get(), "main" }
             };
+            const vk::PipelineShaderStageCreateInfo quad_shader_desc[2] = {
+                { {}, vk::ShaderStageFlagBits::eVertex, m_quad_vert.get(), "main", &specialization_info },
+                { {}, vk::ShaderStageFlagBits::eFragment, m_frag.get(), "main" }
+            };
             const vk::VertexInputBindingDescription vertex_input_binding{ 0, sizeof(vertex), vk::VertexInputRate::eVertex };
             const vk::VertexInputAttributeDescription attributes[3] = {
                 { 0, 0, vk::Format::eR32G32Sfloat, offset_u32(&vertex::pos) },
-                { 1, 0, vk::Format::eR32G32Sfloat, offset_u32(&vertex::tex_coord) },
-                { 2, 0, vk::Format::eR32G32B32A32Sfloat, offset_u32(&vertex::color) }
+                { 1, 0, vk::Format::eR16G16Unorm, offset_u32(&vertex::tex_coord) },
+                { 2, 0, vk::Format::eR8G8B8A8Unorm, offset_u32(&vertex::color) }
             };
             const vk::PipelineVertexInputStateCreateInfo vertex_input{
                 {}, 1, &vertex_input_binding, static_cast<uint32_t>(std::size(attributes)), attributes
             };
             const vk::PipelineInputAssemblyStateCreateInfo input_assembly{ {}, vk::PrimitiveTopology::eTriangleList, false };
+            // quad instances use binding 1, so that both vertex buffers can stay bound across pipeline switches
+            const vk::VertexInputBindingDescription instance_input_binding{ 1, sizeof(quad_instance),
+                                                                            vk::VertexInputRate::eInstance };
+            const vk::VertexInputAttributeDescription instance_attributes[3] = {
+                { 0, 1, vk::Format::eR32G32B32A32Sfloat, offset_u32(&quad_instance::rect) },
+                { 1, 1, vk::Format::eR16G16B16A16Unorm, offset_u32(&quad_instance::tex_min) },
+                { 2, 1, vk::Format::eR8G8B8A8Unorm, offset_u32(&quad_instance::color) }
+            };
+            const vk::PipelineVertexInputStateCreateInfo instance_input{
+                {}, 1, &instance_input_binding, static_cast<uint32_t>(std::size(instance_attributes)), instance_attributes
+            };
+            const vk::PipelineInputAssemblyStateCreateInfo strip_assembly{ {}, vk::PrimitiveTopology::eTriangleStrip, false };
             const vk::PipelineRasterizationStateCreateInfo rasterization_state{ {},
                                                                                 false,
                                                                                 false,
@@ -369,100 +489,157 @@ namespace animgui {
             const auto descriptor_layout = m_descriptor_set_layout.get();
             m_pipeline_layout = m_device.createPipelineLayoutUnique(vk::PipelineLayoutCreateInfo{ {}, 1, &descriptor_layout });
 
-            m_pipeline = m_device
-                             .createGraphicsPipelineUnique({},
-                                                           vk::GraphicsPipelineCreateInfo{
-                                                               {},
-                                                               2,
-                                                               static_cast<const vk::PipelineShaderStageCreateInfo*>(shader_desc),
-                                                               &vertex_input,
-                                                               &input_assembly,
-                                                               nullptr,
-                                                               &viewport_state,
-                                                               &rasterization_state,
-                                                               &multiple_sampling_state,
-                                                               nullptr,
-                                                               &color_blend_state,
-                                                               &dynamic_state_desc,
-                                                               m_pipeline_layout.get(),
-                                                               m_render_pass,
-                                                               0,
-                                                               nullptr,
-                                                               0 })
-                             .value;
+            const auto create_pipeline = [&](const vk::PipelineShaderStageCreateInfo* stages,
+                                             const vk::PipelineVertexInputStateCreateInfo& input,
+                                             const vk::PipelineInputAssemblyStateCreateInfo& assembly) {
+                return m_device
+                    .createGraphicsPipelineUnique({},
+                                                  vk::GraphicsPipelineCreateInfo{ {},
+                                                                                  2,
+                                                                                  stages,
+                                                                                  &input,
+                                                                                  &assembly,
+                                                                                  nullptr,
+                                                                                  &viewport_state,
+                                                                                  &rasterization_state,
+                                                                                  &multiple_sampling_state,
+                                                                                  nullptr,
+                                                                                  &color_blend_state,
+                                                                                  &dynamic_state_desc,
+                                                                                  m_pipeline_layout.get(),
+                                                                                  m_render_pass,
+                                                                                  0,
+                                                                                  nullptr,
+                                                                                  0 })
+                    .value;
+            };
+
+            m_pipeline = create_pipeline(shader_desc, vertex_input, input_assembly);
+            m_quad_pipeline = create_pipeline(quad_shader_desc, instance_input, strip_assembly);
         }
 
         bool m_dirty = false;
         bool m_scissor_restricted = false;
         VkImageView m_bind_tex = nullptr;
+        VkPipeline m_bind_pipeline = nullptr;
 
         void make_dirty() {
             m_dirty = true;
             m_scissor_restricted = true;
+            m_bind_pipeline = nullptr;
             m_bind_tex = reinterpret_cast<VkImageView>(std::numeric_limits<size_t>::max());
         }
 
         const vk::PhysicalDeviceMemoryProperties m_memory_prop;
 
-        buffer_pair m_vertex_buffer;
-        size_t m_vertex_buffer_size = 0;
-
-        void update_vertex_buffer(const std::pmr::vector<vertex>& vertices) {
-            if(m_vertex_buffer_size < vertices.size()) {
-                m_vertex_buffer_size = std::max(m_vertex_buffer_size, static_cast<size_t>(1024)) * 2;
-                m_vertex_buffer = allocate_buffer(
-                    m_device, m_memory_prop, m_vertex_buffer_size * sizeof(vertex), vk::BufferUsageFlagBits::eVertexBuffer,
+        texture_uploader m_uploader;
+        descriptor_allocator m_descriptor_allocator;
+
+        // Each frame in flight owns a persistently mapped buffer holding its vertices, indices and instances. A frame is
+        // only overwritten frames_in_flight updates later, when the application has finished using it.
+        struct frame_resource final {
+            buffer_pair buffer;
+            size_t size = 0;
+            uint8_t* mapped = nullptr;
+            vk::DeviceSize indices_offset = 0;
+            vk::DeviceSize instances_offset = 0;
+        };
+        std::vector<frame_resource> m_frames;
+        size_t m_frame_index = 0;
+
+        void update_frame(const command_queue& command_list) {
+            m_frame_index = (m_frame_index + 1) % m_frames.size();
+            auto& frame = m_frames[m_frame_index];
+
+            const auto vertices_size = command_list.vertices.size() * sizeof(vertex);
+            const auto indices_size = command_list.indices.size() * sizeof(uint32_t);
+            const auto instances_size = command_list.instances.size() * sizeof(quad_instance);
+            const auto size = vertices_size + indices_size + instances_size;
+
+            if(frame.size < size || !frame.buffer.first) {
+                frame.size = std::max(std::max(frame.size, static_cast<size_t>(1) << 16) * 2, size);
+                frame.buffer = allocate_buffer(
+                    m_device, m_memory_prop, frame.size,
+                    vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer,
                     vk::MemoryPropertyFlagBits::eHostCoherent | vk::MemoryPropertyFlagBits::eHostVisible);
+                frame.mapped = static_cast<uint8_t*>(m_device.mapMemory(frame.buffer.second.get(), 0, frame.size, {}));
             }
 
-            update_buffer(m_device, m_vertex_buffer, vertices.data(), vertices.size() * sizeof(vertex));
+            frame.indices_offset = vertices_size;
+            frame.instances_offset = vertices_size + indices_size;
+            if(vertices_size)
+                memcpy(frame.mapped, command_list.vertices.data(), vertices_size);
+            if(indices_size)
+                memcpy(frame.mapped + frame.indices_offset, command_list.indices.data(), indices_size);
+            if(instances_size)
+                memcpy(frame.mapped + frame.instances_offset, command_list.instances.data(), instances_size);
         }
 
         std::shared_ptr<texture> m_empty;
 
-        void emit(const primitives& primitives, uint32_t& vertices_offset) {
+        void emit(const primitives& primitives, uint32_t& vertices_offset, uint32_t& indices_offset,
+                  uint32_t& instances_offset) {
             vk::CommandBuffer& cmd = m_command_buffer;
-            auto&& [type, vertices_count, tex, point_line_size] = primitives;
+            auto&& [type, vertices_count, tex, point_line_size, indices_count, instances_count] = primitives;
 
             if(m_dirty) {
-                cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, m_pipeline.get());
-                vk::Buffer buffer = m_vertex_buffer.first.get();
-                vk::DeviceSize offset = 0;
-                cmd.bindVertexBuffers(0, 1, &buffer, &offset);
+                auto& frame = m_frames[m_frame_index];
+                const vk::Buffer buffers[] = { frame.buffer.first.get(), frame.buffer.first.get() };
+                const vk::DeviceSize offsets[] = { 0, frame.instances_offset };
+                cmd.bindVertexBuffers(0, 2, buffers, offsets);
+                cmd.bindIndexBuffer(frame.buffer.first.get(), frame.indices_offset, vk::IndexType::eUint32);
 
                 m_dirty = false;
             }
 
+            const auto instanced = type == primitive_type::quad_instances;
+            // both pipelines share the same layout, so the bound descriptor set stays valid after switching
+            if(const VkPipeline pipeline = instanced ? m_quad_pipeline.get() : m_pipeline.get(); pipeline != m_bind_pipeline) {
+                cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+                m_bind_pipeline = pipeline;
+            }
+
             if(auto cmd_tex = tex ? tex.get() : m_empty.get();
                reinterpret_cast<VkImageView>(cmd_tex->native_handle()) != m_bind_tex) {
                 cmd_tex->generate_mipmap();
                 m_bind_tex = reinterpret_cast<VkImageView>(cmd_tex->native_handle());
-                const auto descriptor_set = bind_texture(m_bind_tex);
+                const auto descriptor_set = static_cast<texture_impl*>(cmd_tex)->descriptor_set();
                 cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipeline_layout.get(), 0, 1, &descriptor_set, 0,
                                        nullptr);
             }
 
-            cmd.draw(vertices_count, 1, vertices_offset, 0);
+            if(instanced) {
+                cmd.draw(4, instances_count, 0, instances_offset);
+                instances_offset += instances_count;
+            } else if(indices_count) {
+                cmd.drawIndexed(indices_count, 1, indices_offset, static_cast<int32_t>(vertices_offset), 0);
+                indices_offset += indices_count;
+            } else
+                cmd.draw(vertices_count, 1, vertices_offset, 0);
             vertices_offset += vertices_count;
         }
 
-        void emit(const native_callback& callback, uint32_t&) {
+        void emit(const native_callback& callback, uint32_t&, uint32_t&, uint32_t&) {
             callback();
             make_dirty();
         }
 
     public:
         render_backend_impl(vk::PhysicalDevice& physical_device, vk::Device& device, vk::RenderPass& render_pass,
-                            vk::CommandBuffer& command_buffer, const vk::SampleCountFlagBits sample_count,
-                            const float sample_shading, synchronized_executor synchronized_transfer,
-                            std::function<void(vk::Result)> error_report)
+                            vk::CommandBuffer& command_buffer, const uint32_t frames_in_flight,
+                            const vk::SampleCountFlagBits sample_count, const float sample_shading,
+                            synchronized_executor synchronized_transfer, std::function<void(vk::Result)> error_report)
             : m_device{ device }, m_render_pass{ render_pass }, m_command_buffer{ command_buffer },
               m_sample_count{ sample_count }, m_sample_shading{ sample_shading }, m_synchronized_transfer{ std::move(
                                                                                       synchronized_transfer) },
-              m_error_report{ std::move(error_report) }, m_memory_prop{ physical_device.getMemoryProperties() } {
+              m_error_report{ std::move(error_report) }, m_memory_prop{ physical_device.getMemoryProperties() },
+              m_uploader{ device, m_memory_prop, m_synchronized_transfer },
+              m_descriptor_allocator{ device, m_descriptor_set_layout, m_sampler }, m_frames(std::max(frames_in_flight, 1U)) {
 
             m_vert = device.createShaderModuleUnique(vk::ShaderModuleCreateInfo{ {}, sizeof(vert_spv), vert_spv });
             m_frag = device.createShaderModuleUnique(vk::ShaderModuleCreateInfo{ {}, sizeof(frag_spv), frag_spv });
+            m_quad_vert =
+                device.createShaderModuleUnique(vk::ShaderModuleCreateInfo{ {}, sizeof(quad_vert_spv), quad_vert_spv });
             m_sampler = device.createSamplerUnique(vk::SamplerCreateInfo{ {},
                                                                           vk::Filter::eLinear,
                                                                           vk::Filter::eLinear,
@@ -483,17 +660,6 @@ namespace animgui {
                                                                  vk::ShaderStageFlagBits::eFragment, nullptr } };
             m_descriptor_set_layout = device.createDescriptorSetLayoutUnique(
                 vk::DescriptorSetLayoutCreateInfo{ {}, static_cast<uint32_t>(std::size(binding)), binding });
-            vk::DescriptorPoolSize pool_size[]{ { vk::DescriptorType::eCombinedImageSampler, max_textures } };
-            m_descriptor_pool = device.createDescriptorPoolUnique(vk::DescriptorPoolCreateInfo{
-                vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet | vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind,
-                max_textures, static_cast<uint32_t>(std::size(pool_size)), pool_size });
-            vk::DescriptorSetLayout set_layout[max_textures];
-            std::fill(std::begin(set_layout), std::end(set_layout), m_descriptor_set_layout.get());
-            for(auto&& set : m_device.allocateDescriptorSetsUnique(
-                    vk::DescriptorSetAllocateInfo{ m_descriptor_pool.get(), max_textures, set_layout })) {
-                m_binding_queue.push(
-                    std::make_pair(reinterpret_cast<VkImageView>(std::numeric_limits<size_t>::max()), std::move(set)));
-            }
 
             m_empty = create_texture(uvec2{ 1, 1 }, channel::rgba);
             uint8_t data[4] = { 255, 255, 255, 255 };
@@ -502,7 +668,9 @@ namespace animgui {
         void update_command_list(const uvec2 window_size, command_queue command_list) override {
             m_window_size = window_size;
 
-            update_vertex_buffer(command_list.vertices);
+            update_frame(command_list);
+            // the textures updated while drawing the frame are uploaded in one submission
+            m_uploader.flush();
 
             m_command_list.clear();
             m_command_list.reserve(command_list.commands.size());
@@ -511,11 +679,11 @@ namespace animgui {
                 m_command_list.push_back(std::move(command));
         }
         std::shared_ptr<texture> create_texture(uvec2 size, channel channels) override {
-            return std::make_shared<texture_impl>(m_device, m_synchronized_transfer, m_error_report, m_memory_prop, size,
-                                                  channels);
+            return std::make_shared<texture_impl>(m_device, m_uploader, m_descriptor_allocator, m_error_report, m_memory_prop,
+                                                  size, channels);
         }
         std::shared_ptr<texture> create_texture_from_native_handle(const uint64_t handle, uvec2 size, channel channels) override {
-            return std::make_shared<texture_impl>(m_device, m_synchronized_transfer, m_error_report, m_memory_prop,
+            return std::make_shared<texture_impl>(m_device, m_uploader, m_descriptor_allocator, m_error_report, m_memory_prop,
                                                   reinterpret_cast<VkImage>(handle), size, channels);
         }
 
@@ -529,7 +697,7 @@ namespace animgui {
 
             make_dirty();
 
-            uint32_t vertices_offset = 0;
+            uint32_t vertices_offset = 0, indices_offset = 0, instances_offset = 0;
 
             vk::CommandBuffer& cmd = m_command_buffer;
 
@@ -556,27 +724,32 @@ namespace animgui {
                     m_scissor_restricted = false;
                 }
 
-                std::visit([&](auto&& item) { emit(item, vertices_offset); }, command.desc);
+                std::visit([&](auto&& item) { emit(item, vertices_offset, indices_offset, instances_offset); }, command.desc);
             }
 
             const auto tp2 = current_time();
             m_render_time = tp2 - tp1;
+            m_emit_finish_time = tp2;
         }
         [[nodiscard]] uint64_t render_time() const noexcept override {
             return m_render_time;
         }
+        [[nodiscard]] uint64_t emit_finish_time() const noexcept override {
+            return m_emit_finish_time;
+        }
         [[nodiscard]] primitive_type supported_primitives() const noexcept override {
-            return primitive_type::triangles;
+            return primitive_type::triangles | primitive_type::quad_instances;
         }
     };
 
     ANIMGUI_API std::shared_ptr<render_backend>
     create_vulkan_backend(vk::PhysicalDevice& physical_device, vk::Device& device, vk::RenderPass& render_pass,
-                          vk::CommandBuffer& command_buffer, const vk::SampleCountFlagBits sample_count,
-                          const float sample_shading, synchronized_executor synchronized_transfer,
-                          std::function<void(vk::Result)> error_report) {
-        return std::make_shared<render_backend_impl>(physical_device, device, render_pass, command_buffer, sample_count,
-                                                     sample_shading, std::move(synchronized_transfer), std::move(error_report));
+                          vk::CommandBuffer& command_buffer, const uint32_t frames_in_flight,
+                          const vk::SampleCountFlagBits sample_count, const float sample_shading,
+                          synchronized_executor synchronized_transfer, std::function<void(vk::Result)> error_report) {
+        return std::make_shared<render_backend_impl>(physical_device, device, render_pass, command_buffer, frames_in_flight,
+                                                     sample_count, sample_shading, std::move(synchronized_transfer),
+                                                     std::move(error_report));
     }
 
 }  // namespace animgui
@@ -1,17 +1,24 @@
 // SPDX-License-Identifier: MIT
 
+#include <algorithm>
 #include <animgui/builtins/animators.hpp>
 #include <animgui/core/animator.hpp>
 #include <cmath>
 
+// Define ANIMGUI_NO_SIMD to use the scalar reference implementation.
+#if !defined(ANIMGUI_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ANIMGUI_SIMD_SSE2
+#include <emmintrin.h>
+#elif !defined(ANIMGUI_NO_SIMD) && (defined(__aarch64__) || defined(_M_ARM64))
+#define ANIMGUI_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
 namespace animgui {
     class dummy_animator final : public animator {
     public:
-        [[nodiscard]] step_function step(float) const override {
-            return [](const float dest, void*) { return dest; };
-        }
-        [[nodiscard]] std::tuple<size_t, size_t, size_t> state_storage() const noexcept override {
-            return { 0, 0, 0 };
+        void step(float, const span<float> current, const span<const float> destination) const override {
+            std::copy(destination.begin(), destination.end(), current.begin());
         }
     };
 
@@ -22,24 +29,44 @@ namespace animgui {
     class linear_animator final : public animator {
         float m_speed;
 
-        struct storage final {
-            float current;
-        };
+        static float step_one(const float current, const float dest, const float dx) noexcept {
+            const auto diff = dest - current;
+            return std::fabs(diff) <= dx ? dest : current + std::copysign(dx, diff);
+        }
 
     public:
         explicit linear_animator(const float speed) : m_speed{ speed } {}
-        [[nodiscard]] step_function step(float delta_t) const override {
-            return [dx = delta_t * m_speed](const float dest, void* data) {
-                auto&& state = static_cast<storage*>(data);
-                if(std::fabs(state->current - dest) < dx)
-                    state->current = dest;
-                else
-                    state->current += std::copysign(dx, dest - state->current);
-                return state->current;
-            };
-        }
-        [[nodiscard]] std::tuple<size_t, size_t, size_t> state_storage() const noexcept override {
-            return { typeid(storage).hash_code(), sizeof(storage), alignof(storage) };
+        void step(const float delta_t, const span<float> current, const span<const float> destination) const override {
+            const auto dx = delta_t * m_speed;
+            const auto size = current.size();
+            auto cur = current.begin();
+            const auto dst = destination.begin();
+            size_t idx = 0;
+#if defined(ANIMGUI_SIMD_SSE2)
+            const auto sign_mask = _mm_set1_ps(-0.0f);
+            const auto step = _mm_set1_ps(dx);
+            for(; idx + 4 <= size; idx += 4) {
+                const auto c = _mm_loadu_ps(cur + idx);
+                const auto d = _mm_loadu_ps(dst + idx);
+                const auto diff = _mm_sub_ps(d, c);
+                const auto near = _mm_cmple_ps(_mm_andnot_ps(sign_mask, diff), step);
+                const auto moved = _mm_add_ps(c, _mm_or_ps(_mm_and_ps(diff, sign_mask), step));
+                _mm_storeu_ps(cur + idx, _mm_or_ps(_mm_and_ps(near, d), _mm_andnot_ps(near, moved)));
+            }
+#elif defined(ANIMGUI_SIMD_NEON)
+            const auto sign_mask = vdupq_n_u32(0x80000000);
+            const auto step = vdupq_n_f32(dx);
+            for(; idx + 4 <= size; idx += 4) {
+                const auto c = vld1q_f32(cur + idx);
+                const auto d = vld1q_f32(dst + idx);
+                const auto diff = vsubq_f32(d, c);
+                const auto near = vcleq_f32(vabsq_f32(diff), step);
+                const auto moved = vaddq_f32(c, vbslq_f32(sign_mask, diff, step));
+                vst1q_f32(cur + idx, vbslq_f32(near, d, moved));
+            }
+#endif
+            for(; idx < size; ++idx)
+                cur[idx] = step_one(cur[idx], dst[idx], dx);
         }
     };
 
@@ -48,23 +75,47 @@ namespace animgui {
     }
 
     class physical_animator final : public animator {
+        // the exponential decay never reaches the destination, so the value snaps to it once the difference is invisible
+        static constexpr auto converge_eps = 1e-3f;
         float m_speed;
 
-        struct storage final {
-            float current;
-        };
+        static float step_one(const float current, const float dest, const float factor) noexcept {
+            const auto next = dest + (current - dest) * factor;
+            return std::fabs(next - dest) < converge_eps ? dest : next;
+        }
 
     public:
         explicit physical_animator(const float speed) : m_speed{ speed } {}
-        [[nodiscard]] step_function step(float delta_t) const override {
-            return [factor = std::exp(-m_speed * delta_t)](const float dest, void* data) {
-                auto&& state = static_cast<storage*>(data);
-                state->current = dest + (state->current - dest) * factor;
-                return state->current;
-            };
-        }
-        [[nodiscard]] std::tuple<size_t, size_t, size_t> state_storage() const noexcept override {
-            return { typeid(storage).hash_code(), sizeof(storage), alignof(storage) };
+        void step(const float delta_t, const span<float> current, const span<const float> destination) const override {
+            const auto factor = std::exp(-m_speed * delta_t);
+            const auto size = current.size();
+            auto cur = current.begin();
+            const auto dst = destination.begin();
+            size_t idx = 0;
+#if defined(ANIMGUI_SIMD_SSE2)
+            const auto sign_mask = _mm_set1_ps(-0.0f);
+            const auto eps = _mm_set1_ps(converge_eps);
+            const auto scale = _mm_set1_ps(factor);
+            for(; idx + 4 <= size; idx += 4) {
+                const auto c = _mm_loadu_ps(cur + idx);
+                const auto d = _mm_loadu_ps(dst + idx);
+                const auto next = _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(c, d), scale));
+                const auto near = _mm_cmplt_ps(_mm_andnot_ps(sign_mask, _mm_sub_ps(next, d)), eps);
+                _mm_storeu_ps(cur + idx, _mm_or_ps(_mm_and_ps(near, d), _mm_andnot_ps(near, next)));
+            }
+#elif defined(ANIMGUI_SIMD_NEON)
+            const auto eps = vdupq_n_f32(converge_eps);
+            const auto scale = vdupq_n_f32(factor);
+            for(; idx + 4 <= size; idx += 4) {
+                const auto c = vld1q_f32(cur + idx);
+                const auto d = vld1q_f32(dst + idx);
+                const auto next = vaddq_f32(d, vmulq_f32(vsubq_f32(c, d), scale));
+                const auto near = vcltq_f32(vabsq_f32(vsubq_f32(next, d)), eps);
+                vst1q_f32(cur + idx, vbslq_f32(near, d, next));
+            }
+#endif
+            for(; idx < size; ++idx)
+                cur[idx] = step_one(cur[idx], dst[idx], factor);
         }
     };
 
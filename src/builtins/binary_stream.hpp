@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace animgui {
+    // Raw native byte order (de)serialization shared by the capture and replay builtins.
+    inline void write_binary(std::ostream& stream, const void* data, const size_t size) {
+        stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+    template <typename T>
+    void write_binary(std::ostream& stream, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write_binary(stream, &value, sizeof(T));
+    }
+
+    inline void read_binary(std::istream& stream, void* data, const size_t size) {
+        if(!stream.read(static_cast<char*>(data), static_cast<std::streamsize>(size)))
+            throw std::runtime_error{ "unexpected end of stream" };
+    }
+    template <typename T>
+    T read_binary(std::istream& stream) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        read_binary(stream, &value, sizeof(T));
+        return value;
+    }
+}  // namespace animgui
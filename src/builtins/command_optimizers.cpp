@@ -15,7 +15,8 @@ namespace animgui {
         }
         [[nodiscard]] primitive_type supported_primitives() const noexcept override {
             return primitive_type::points | primitive_type::lines | primitive_type::line_strip | primitive_type::line_loop |
-                primitive_type::triangles | primitive_type::triangle_fan | primitive_type::triangle_strip | primitive_type::quads;
+                primitive_type::triangles | primitive_type::triangle_fan | primitive_type::triangle_strip |
+                primitive_type::quads | primitive_type::quad_instances;
         }
     };
 
@@ -25,8 +26,13 @@ namespace animgui {
 
     // FIXME: cannot handle user callback correctly in stage 2
     class command_optimizer_builtin final : public command_optimizer {
-        using command_queue_sub = std::pmr::vector<std::pair<command, std::pmr::vector<std::pair<uint32_t, uint32_t>>>>;
-        using command_pusher = std::function<void(std::pair<command, std::pmr::vector<std::pair<uint32_t, uint32_t>>>)>;
+        struct vertex_range final {
+            uint32_t vertices_offset, vertices_count;
+            uint32_t indices_offset, indices_count;
+            uint32_t instances_offset, instances_count;
+        };
+        using command_queue_sub = std::pmr::vector<std::pair<command, std::pmr::vector<vertex_range>>>;
+        using command_pusher = std::function<void(std::pair<command, std::pmr::vector<vertex_range>>)>;
 
         void merge_tex(command_queue_sub::iterator beg, const command_queue_sub::iterator end, const command_pusher& push) const {
             if(beg == end)
@@ -148,15 +154,19 @@ namespace animgui {
 
             {
                 src_sub.reserve(src.commands.size());
-                uint32_t vertices_offset = 0;
+                uint32_t vertices_offset = 0, indices_offset = 0, instances_offset = 0;
                 for(auto& command : src.commands) {
                     if(auto desc = std::get_if<primitives>(&command.desc)) {
-                        src_sub.push_back(std::make_pair(std::move(command),
-                                                         std::pmr::vector<std::pair<uint32_t, uint32_t>>{
-                                                             { { vertices_offset, desc->vertices_count } }, memory_resource }));
+                        src_sub.push_back(std::make_pair(
+                            std::move(command),
+                            std::pmr::vector<vertex_range>{ { { vertices_offset, desc->vertices_count, indices_offset,
+                                                                desc->indices_count, instances_offset, desc->instances_count } },
+                                                            memory_resource }));
                         vertices_offset += desc->vertices_count;
+                        indices_offset += desc->indices_count;
+                        instances_offset += desc->instances_count;
                     } else
-                        src_sub.push_back(std::make_pair(std::move(command), std::pmr::vector<std::pair<uint32_t, uint32_t>>{}));
+                        src_sub.push_back(std::make_pair(std::move(command), std::pmr::vector<vertex_range>{}));
                 }
             }
 
@@ -225,26 +235,49 @@ namespace animgui {
 
             std::pmr::vector<vertex> sorted_vertices{ memory_resource };
             sorted_vertices.reserve(src.vertices.size());
+            std::pmr::vector<uint32_t> sorted_indices{ memory_resource };
+            sorted_indices.reserve(src.indices.size());
+            std::pmr::vector<quad_instance> sorted_instances{ memory_resource };
+            sorted_instances.reserve(src.instances.size());
             std::pmr::vector<command> commands{ memory_resource };
             commands.reserve(stage2.size());
 
             for(auto&& cmd : stage2) {
                 if(auto desc = std::get_if<primitives>(&cmd.first.desc)) {
-                    uint32_t vertices_count = 0;
+                    // once a merged command contains an indexed range, the whole command is drawn with indices
+                    const auto indexed = std::any_of(cmd.second.cbegin(), cmd.second.cend(),
+                                                     [](const vertex_range& range) { return range.indices_count != 0; });
+                    uint32_t vertices_count = 0, instances_count = 0;
+                    const auto indices_begin = sorted_indices.size();
                     for(auto&& range : cmd.second) {
-                        sorted_vertices.insert(sorted_vertices.end(), src.vertices.begin() + range.first,
-                                               src.vertices.begin() + range.first + range.second);
-                        vertices_count += range.second;
+                        sorted_vertices.insert(sorted_vertices.end(), src.vertices.begin() + range.vertices_offset,
+                                               src.vertices.begin() + range.vertices_offset + range.vertices_count);
+                        sorted_instances.insert(sorted_instances.end(), src.instances.begin() + range.instances_offset,
+                                                src.instances.begin() + range.instances_offset + range.instances_count);
+                        instances_count += range.instances_count;
+                        if(indexed) {
+                            if(range.indices_count) {
+                                for(uint32_t idx = 0; idx < range.indices_count; ++idx)
+                                    sorted_indices.push_back(vertices_count + src.indices[range.indices_offset + idx]);
+                            } else {
+                                for(uint32_t idx = 0; idx < range.vertices_count; ++idx)
+                                    sorted_indices.push_back(vertices_count + idx);
+                            }
+                        }
+                        vertices_count += range.vertices_count;
                     }
                     desc->vertices_count = vertices_count;
+                    desc->indices_count = static_cast<uint32_t>(sorted_indices.size() - indices_begin);
+                    desc->instances_count = instances_count;
                 }
                 commands.push_back(std::move(cmd.first));
             }
 
-            return { std::move(sorted_vertices), std::move(commands) };
+            return { std::move(sorted_vertices), std::move(commands), std::move(sorted_indices), std::move(sorted_instances) };
         }
         [[nodiscard]] primitive_type supported_primitives() const noexcept override {
-            return primitive_type::points | primitive_type::lines | primitive_type::triangles | primitive_type::quads;
+            return primitive_type::points | primitive_type::lines | primitive_type::triangles | primitive_type::quads |
+                primitive_type::quad_instances;
         }
     };
 
@@ -5,12 +5,54 @@
 #include <animgui/core/emitter.hpp>
 #include <animgui/core/font_backend.hpp>
 #include <animgui/core/style.hpp>
+#include "thread_pool.hpp"
+#include <algorithm>
 #include <cmath>
-#include <stack>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <utf8.h>
 
 namespace animgui {
     class builtin_emitter final : public emitter {
+        // the bounds of a command must cover all of its pixels, including the width of lines
+        static bounds_aabb expand_bounds(const bounds_aabb& bounds, const float extent) noexcept {
+            return { bounds.left - extent, bounds.right + extent, bounds.top - extent, bounds.bottom + extent };
+        }
+        // Axis-aligned quads are clipped on the CPU (positions and texture coordinates), so that they don't carry any
+        // scissor state and can be batched across regions. Other primitives still use the clip rect of the command.
+        // If merge is set, the quad is appended to the last command when it draws instances of the same texture.
+        // Returns false if the quad is clipped away.
+        static bool emit_quad(const bounds_aabb& render_rect, const bounds_aabb& clip_rect, const bounds_aabb& tex_region,
+                              const std::shared_ptr<texture>& tex, const color_rgba& color, command_queue& queue,
+                              const bool merge = false) {
+            const auto rect =
+                bounds_aabb{ std::fmax(render_rect.left, clip_rect.left), std::fmin(render_rect.right, clip_rect.right),
+                             std::fmax(render_rect.top, clip_rect.top), std::fmin(render_rect.bottom, clip_rect.bottom) };
+            if(!(rect.left < rect.right && rect.top < rect.bottom))
+                return false;
+
+            const auto [s0, s1, t0, t1] = tex_region;
+            const auto scale_s = (s1 - s0) / (render_rect.right - render_rect.left);
+            const auto scale_t = (t1 - t0) / (render_rect.bottom - render_rect.top);
+            const auto cs0 = s0 + (rect.left - render_rect.left) * scale_s, cs1 = s0 + (rect.right - render_rect.left) * scale_s;
+            const auto ct0 = t0 + (rect.top - render_rect.top) * scale_t, ct1 = t0 + (rect.bottom - render_rect.top) * scale_t;
+            queue.instances.push_back({ rect, pack_tex_coord({ cs0, ct0 }), pack_tex_coord({ cs1, ct1 }), pack_color(color) });
+
+            if(merge && !queue.commands.empty()) {
+                auto& [bounds, clip, desc] = queue.commands.back();
+                if(const auto last = std::get_if<primitives>(&desc);
+                   last && last->type == primitive_type::quad_instances && last->tex == tex && !clip.has_value()) {
+                    ++last->instances_count;
+                    bounds = { std::fmin(bounds.left, rect.left), std::fmax(bounds.right, rect.right),
+                               std::fmin(bounds.top, rect.top), std::fmax(bounds.bottom, rect.bottom) };
+                    return true;
+                }
+            }
+            queue.commands.push_back({ rect, std::nullopt, primitives{ primitive_type::quad_instances, 0, tex, 0.0f, 0, 1 } });
+            return true;
+        }
         static vec2 calc_bounds(const button_base& item, const style& style) {
             return { item.content_size.x + 2 * style.padding.x, item.content_size.y + 2 * style.padding.y };
         }
@@ -27,9 +69,8 @@ namespace animgui {
             }
             return style.action.active;
         }
-        static void emit(const button_base& item, const bounds_aabb& clip_rect, const vec2 offset,
-                         std::pmr::vector<command>& commands, std::pmr::vector<vertex>& vertices, const style& style,
-                         const std::function<texture_region(font&, glyph_id)>&) {
+        static void emit(const button_base& item, const bounds_aabb& clip_rect, const vec2 offset, command_queue& queue,
+                         const style& style, const std::function<texture_region(font&, glyph_id)>&) {
             auto rect = bounds_aabb{ item.anchor.x, item.anchor.x + item.content_size.x + 2 * style.padding.x, item.anchor.y,
                                      item.anchor.y + item.content_size.y + 2 * style.padding.y };
             auto render_rect = rect;
@@ -39,29 +80,20 @@ namespace animgui {
 
             const auto p0 = vec2{ render_rect.left, render_rect.top }, p1 = vec2{ render_rect.left, render_rect.bottom },
                        p2 = vec2{ render_rect.right, render_rect.bottom }, p3 = vec2{ render_rect.right, render_rect.top };
-            const auto back = style.panel_background;
-            const auto front = select_button_color(item.status, style);
-            const auto unused = vec2{ 0.0f, 0.0f };
-
-            commands.push_back({ render_rect, clip_rect, primitives{ primitive_type::triangle_strip, 4, nullptr, 0.0f } });
-            commands.push_back(
-                { render_rect, clip_rect, primitives{ primitive_type::line_loop, 4, nullptr, style.bounds_edge_width } });
-            vertices.insert(vertices.end(),
-                            { { p0, unused, back },
-                              { p1, unused, back },
-                              { p3, unused, back },
-                              { p2, unused, back },
-                              { p0, unused, front },
-                              { p1, unused, front },
-                              { p2, unused, front },
-                              { p3, unused, front } });
+            const auto front = pack_color(select_button_color(item.status, style));
+            const auto unused = packed_tex_coord{};
+
+            emit_quad(render_rect, clip_rect, {}, nullptr, style.panel_background, queue);
+            queue.commands.push_back({ expand_bounds(render_rect, style.bounds_edge_width / 2.0f), clip_rect,
+                                       primitives{ primitive_type::line_loop, 4, nullptr, style.bounds_edge_width } });
+            queue.vertices.insert(queue.vertices.end(),
+                                  { { p0, unused, front }, { p1, unused, front }, { p2, unused, front }, { p3, unused, front } });
         }
         static vec2 calc_bounds(const canvas_stroke_rect& item, const style&) {
             return { item.bounds.right - item.bounds.left + item.size, item.bounds.bottom - item.bounds.top + item.size };
         }
-        static void emit(const canvas_stroke_rect& item, const bounds_aabb& clip_rect, const vec2 offset,
-                         std::pmr::vector<command>& commands, std::pmr::vector<vertex>& vertices, const style&,
-                         const std::function<texture_region(font&, glyph_id)>&) {
+        static void emit(const canvas_stroke_rect& item, const bounds_aabb& clip_rect, const vec2 offset, command_queue& queue,
+                         const style&, const std::function<texture_region(font&, glyph_id)>&) {
             if(auto rect = bounds_aabb{ item.bounds.left - item.size / 2.0f, item.bounds.right + item.size / 2.0f,
                                         item.bounds.top - item.size / 2.0f, item.bounds.bottom + item.size / 2.0f };
                !clip_bounds(rect, offset, clip_rect))
@@ -70,43 +102,27 @@ namespace animgui {
             offset_bounds(render_rect, offset);
             const auto p0 = vec2{ render_rect.left, render_rect.top }, p1 = vec2{ render_rect.left, render_rect.bottom },
                        p2 = vec2{ render_rect.right, render_rect.bottom }, p3 = vec2{ render_rect.right, render_rect.top };
-            const auto unused = vec2{ 0.0f, 0.0f };
-            commands.push_back({ render_rect, clip_rect, primitives{ primitive_type::line_loop, 4, nullptr, item.size } });
-            vertices.insert(vertices.end(),
-                            { { p0, unused, item.color },
-                              { p1, unused, item.color },
-                              { p2, unused, item.color },
-                              { p3, unused, item.color } });
+            const auto unused = packed_tex_coord{};
+            const auto color = pack_color(item.color);
+            queue.commands.push_back({ expand_bounds(render_rect, item.size / 2.0f), clip_rect,
+                                       primitives{ primitive_type::line_loop, 4, nullptr, item.size } });
+            queue.vertices.insert(queue.vertices.end(),
+                                  { { p0, unused, color }, { p1, unused, color }, { p2, unused, color }, { p3, unused, color } });
         }
         static vec2 calc_bounds(const canvas_fill_rect& item, const style&) {
             return { item.bounds.right - item.bounds.left, item.bounds.bottom - item.bounds.top };
         }
-        static void emit(const canvas_fill_rect& item, const bounds_aabb& clip_rect, const vec2 offset,
-                         std::pmr::vector<command>& commands, std::pmr::vector<vertex>& vertices, const style&,
-                         const std::function<texture_region(font&, glyph_id)>&) {
-            auto rect = item.bounds;
-            if(!clip_bounds(rect, offset, clip_rect))
-                return;
-
+        static void emit(const canvas_fill_rect& item, const bounds_aabb& clip_rect, const vec2 offset, command_queue& queue,
+                         const style&, const std::function<texture_region(font&, glyph_id)>&) {
             auto render_rect = item.bounds;
             offset_bounds(render_rect, offset);
-
-            const auto p0 = vec2{ rect.left, rect.top }, p1 = vec2{ rect.left, rect.bottom },
-                       p2 = vec2{ rect.right, rect.bottom }, p3 = vec2{ rect.right, rect.top };
-            const auto unused = vec2{ 0.0f, 0.0f };
-            commands.push_back({ render_rect, clip_rect, primitives{ primitive_type::triangle_strip, 4, nullptr, 0.0f } });
-            vertices.insert(vertices.end(),
-                            { { p0, unused, item.color },
-                              { p1, unused, item.color },
-                              { p3, unused, item.color },
-                              { p2, unused, item.color } });
+            emit_quad(render_rect, clip_rect, {}, nullptr, item.color, queue);
         }
         static vec2 calc_bounds(const canvas_line& item, const style&) {
             return { std::fabs(item.start.x - item.end.x) + item.size, std::fabs(item.start.y - item.end.y) + item.size };
         }
-        static void emit(const canvas_line& item, const bounds_aabb& clip_rect, const vec2 offset,
-                         std::pmr::vector<command>& commands, std::pmr::vector<vertex>& vertices, const style&,
-                         const std::function<texture_region(font&, glyph_id)>&) {
+        static void emit(const canvas_line& item, const bounds_aabb& clip_rect, const vec2 offset, command_queue& queue,
+                         const style&, const std::function<texture_region(font&, glyph_id)>&) {
             auto rect = bounds_aabb{ std::fmin(item.start.x, item.end.x) - item.size / 2.0f,
                                      std::fmax(item.start.x, item.end.x) + item.size / 2.0f,
                                      std::fmin(item.start.y, item.end.y) - item.size / 2.0f,
@@ -118,16 +134,16 @@ namespace animgui {
 
             const auto p0 = vec2{ offset.x + item.start.x, offset.y + item.start.y },
                        p1 = vec2{ offset.x + item.end.x, offset.y + item.end.y };
-            const auto unused = vec2{ 0.0f, 0.0f };
-            commands.push_back({ render_rect, clip_rect, primitives{ primitive_type::lines, 2, nullptr, item.size } });
-            vertices.insert(vertices.end(), { { p0, unused, item.color }, { p1, unused, item.color } });
+            const auto unused = packed_tex_coord{};
+            const auto color = pack_color(item.color);
+            queue.commands.push_back({ render_rect, clip_rect, primitives{ primitive_type::lines, 2, nullptr, item.size } });
+            queue.vertices.insert(queue.vertices.end(), { { p0, unused, color }, { p1, unused, color } });
         }
         static vec2 calc_bounds(const canvas_point& item, const style&) {
             return { item.size, item.size };
         }
-        static void emit(const canvas_point& item, const bounds_aabb& clip_rect, const vec2 offset,
-                         std::pmr::vector<command>& commands, std::pmr::vector<vertex>& vertices, const style&,
-                         const std::function<texture_region(font&, glyph_id)>&) {
+        static void emit(const canvas_point& item, const bounds_aabb& clip_rect, const vec2 offset, command_queue& queue,
+                         const style&, const std::function<texture_region(font&, glyph_id)>&) {
             auto rect = bounds_aabb{ item.pos.x - item.size / 2.0f, item.pos.x + item.size / 2.0f, item.pos.y - item.size / 2.0f,
                                      item.pos.y + item.size / 2.0f };
             auto render_rect = rect;
@@ -135,30 +151,18 @@ namespace animgui {
                 return;
             offset_bounds(render_rect, offset);
 
-            const auto unused = vec2{ 0.0f, 0.0f };
-            commands.push_back({ render_rect, clip_rect, primitives{ primitive_type::points, 1, nullptr, item.size } });
-            vertices.push_back({ { item.pos.x + offset.x, item.pos.y + offset.y }, unused, item.color });
+            const auto unused = packed_tex_coord{};
+            queue.commands.push_back({ render_rect, clip_rect, primitives{ primitive_type::points, 1, nullptr, item.size } });
+            queue.vertices.push_back({ { item.pos.x + offset.x, item.pos.y + offset.y }, unused, pack_color(item.color) });
         }
         static vec2 calc_bounds(const canvas_image& item, const style&) {
             return { item.bounds.right - item.bounds.left, item.bounds.bottom - item.bounds.top };
         }
-        static void emit(const canvas_image& item, const bounds_aabb& clip_rect, const vec2 offset,
-                         std::pmr::vector<command>& commands, std::pmr::vector<vertex>& vertices, const style&,
-                         const std::function<texture_region(font&, glyph_id)>&) {
-            if(auto rect = item.bounds; !clip_bounds(rect, offset, clip_rect))
-                return;
+        static void emit(const canvas_image& item, const bounds_aabb& clip_rect, const vec2 offset, command_queue& queue,
+                         const style&, const std::function<texture_region(font&, glyph_id)>&) {
             auto render_rect = item.bounds;
             offset_bounds(render_rect, offset);
-
-            const auto p0 = vec2{ render_rect.left, render_rect.top }, p1 = vec2{ render_rect.left, render_rect.bottom },
-                       p2 = vec2{ render_rect.right, render_rect.bottom }, p3 = vec2{ render_rect.right, render_rect.top };
-            const auto [s0, s1, t0, t1] = item.tex.region;
-            commands.push_back({ render_rect, clip_rect, primitives{ primitive_type::triangle_strip, 4, item.tex.tex, 0.0f } });
-            vertices.insert(vertices.end(),
-                            { { p0, { s0, t0 }, item.factor },
-                              { p1, { s0, t1 }, item.factor },
-                              { p3, { s1, t0 }, item.factor },
-                              { p2, { s1, t1 }, item.factor } });
+            emit_quad(render_rect, clip_rect, item.tex.region, item.tex.tex, item.factor, queue);
         }
         static vec2 calc_bounds(const canvas_text& item, const style&) {
             auto width = 0.0f;
@@ -173,13 +177,18 @@ namespace animgui {
             }
             return { width, item.font_ref->height() };
         }
-        static void emit(const canvas_text& item, const bounds_aabb& clip_rect, vec2 offset, std::pmr::vector<command>& commands,
-                         std::pmr::vector<vertex>& vertices, const style&,
+        static void emit(const canvas_text& item, const bounds_aabb& clip_rect, vec2 offset, command_queue& queue, const style&,
                          const std::function<texture_region(font&, glyph_id)>& font_callback) {
             offset = offset + item.pos;
+            // glyphs may reach out of the line box, one line height is kept as a margin
+            if(const auto height = item.font_ref->height();
+               offset.y + 2.0f * height <= clip_rect.top || offset.y - height >= clip_rect.bottom)
+                return;
             auto beg = item.str.begin();
             const auto end = item.str.end();
             glyph_id prev{ 0 };
+            // glyphs of the same text share draw calls
+            bool merge = false;
             while(beg != end) {
                 const auto cp = utf8::next(beg, end);
                 const auto glyph = item.font_ref->to_glyph(cp);
@@ -188,23 +197,10 @@ namespace animgui {
                 prev = glyph;
 
                 if(glyph.idx) {
-                    const auto tex = font_callback(*item.font_ref, glyph);
-                    auto render_bounds = bounds;
-                    if(clip_bounds(bounds, offset, clip_rect)) {
-                        offset_bounds(render_bounds, offset);
-
-                        const auto p0 = vec2{ render_bounds.left, render_bounds.top },
-                                   p1 = vec2{ render_bounds.left, render_bounds.bottom },
-                                   p2 = vec2{ render_bounds.right, render_bounds.bottom },
-                                   p3 = vec2{ render_bounds.right, render_bounds.top };
-                        const auto [s0, s1, t0, t1] = tex.region;
-                        commands.push_back(
-                            { render_bounds, clip_rect, primitives{ primitive_type::triangle_strip, 4, tex.tex, 0.0f } });
-                        vertices.insert(vertices.end(),
-                                        { { p0, { s0, t0 }, item.color },
-                                          { p1, { s0, t1 }, item.color },
-                                          { p3, { s1, t0 }, item.color },
-                                          { p2, { s1, t1 }, item.color } });
+                    if(auto rect = bounds; clip_bounds(rect, offset, clip_rect)) {
+                        const auto tex = font_callback(*item.font_ref, glyph);
+                        offset_bounds(bounds, offset);
+                        merge |= emit_quad(bounds, clip_rect, tex.region, tex.tex, item.color, queue, merge);
                     }
                 }
 
@@ -213,82 +209,710 @@ namespace animgui {
                     break;
             }
         }
+
+        // x is the pen position relative to the start of the line, so the glyphs of a line are sorted by x
+        struct laid_glyph final {
+            glyph_id glyph;
+            float x;
+        };
+        struct paragraph_line final {
+            size_t begin, end;  // glyphs
+            float width;        // without trailing spaces
+        };
+        // line breaks of a paragraph, shared by the threads which emit it
+        struct paragraph_layout final {
+            std::vector<laid_glyph> glyphs;
+            std::vector<paragraph_line> lines;
+            float width;  // the widest line
+        };
+        // the key is only a hash, so the entry keeps what it was laid out for
+        struct paragraph_entry final {
+            paragraph_text text;
+            float width;
+            const font* font_ref;
+            std::shared_ptr<const paragraph_layout> layout;
+            uint64_t last_used;
+        };
+        static std::shared_ptr<const paragraph_layout> layout_paragraph(const canvas_paragraph& item) {
+            constexpr auto npos = std::numeric_limits<size_t>::max();
+            auto layout = std::make_shared<paragraph_layout>();
+            auto& [glyphs, lines, max_width] = *layout;
+            const auto& font = *item.font_ref;
+
+            const auto& str = item.text.str();
+            auto beg = str.data();
+            const auto end = beg + str.size();
+            // the first glyph after the last space of the line and where it starts in the string
+            size_t line_begin = 0, break_glyph = npos;
+            auto break_pos = beg;
+            auto pen = 0.0f, line_width = 0.0f, break_width = 0.0f;
+            glyph_id prev{ 0 };
+            const auto new_line = [&](const size_t line_end, const float width) {
+                lines.push_back({ line_begin, line_end, width });
+                line_begin = glyphs.size();
+                break_glyph = npos;
+                pen = line_width = 0.0f;
+                prev = glyph_id{ 0 };
+            };
+            while(beg != end) {
+                const auto pos = beg;
+                const auto cp = utf8::next(beg, end);
+                if(cp == '\n') {
+                    new_line(glyphs.size(), line_width);
+                    continue;
+                }
+                if(cp == '\r')
+                    continue;
+                const auto glyph = font.to_glyph(cp);
+                const auto advance = font.calculate_advance(glyph, prev);
+                if(cp == ' ') {
+                    // spaces hang over the end of the line
+                    glyphs.push_back({ glyph, pen });
+                    pen += advance;
+                    prev = glyph;
+                    break_glyph = glyphs.size();
+                    break_pos = beg;
+                    break_width = line_width;
+                    continue;
+                }
+                if(pen + advance > item.width && glyphs.size() > line_begin) {
+                    // Moves the last word to the next line and lays it out again, so every glyph is laid out at most twice.
+                    // A word which doesn't fit into a line on its own is broken before the glyph.
+                    if(break_glyph != npos) {
+                        glyphs.erase(glyphs.begin() + static_cast<ptrdiff_t>(break_glyph), glyphs.end());
+                        beg = break_pos;
+                        new_line(break_glyph, break_width);
+                    } else {
+                        beg = pos;
+                        new_line(glyphs.size(), line_width);
+                    }
+                    continue;
+                }
+                glyphs.push_back({ glyph, pen });
+                pen += advance;
+                line_width = pen;
+                prev = glyph;
+            }
+            new_line(glyphs.size(), line_width);
+
+            max_width = 0.0f;
+            for(auto&& line : lines)
+                max_width = std::fmax(max_width, line.width);
+            return layout;
+        }
+        // Line breaks are cached by the text, the width and the font, so that a paragraph is laid out once rather than in
+        // every frame. The hash of the text is computed by paragraph_text, and a hit only reads the string again if the
+        // text is a different copy. It may be called by the worker threads of the parallel emitter.
+        std::shared_ptr<const paragraph_layout> find_paragraph(const canvas_paragraph& item) const {
+            auto key = item.text.hash();
+            hash_value(key, item.width);
+            hash_value(key, item.font_ref.get());
+            {
+                std::lock_guard<std::mutex> guard{ m_paragraph_mutex };
+                if(const auto iter = m_paragraphs.find(key); iter != m_paragraphs.cend()) {
+                    auto&& entry = iter->second;
+                    if(entry.width == item.width && entry.font_ref == item.font_ref.get() && entry.text.same_text(item.text)) {
+                        entry.last_used = m_frame;
+                        return entry.layout;
+                    }
+                }
+            }
+            // laid out without the lock, so that other chunks are not blocked by a large paragraph
+            auto layout = layout_paragraph(item);
+            std::lock_guard<std::mutex> guard{ m_paragraph_mutex };
+            m_paragraphs.insert_or_assign(key, paragraph_entry{ item.text, item.width, item.font_ref.get(), layout, m_frame });
+            return layout;
+        }
+        vec2 calc_bounds(const canvas_paragraph& item, const style&) const {
+            const auto layout = find_paragraph(item);
+            return { item.alignment == text_alignment::left ? layout->width : item.width,
+                     static_cast<float>(layout->lines.size() - 1) * item.font_ref->line_spacing() + item.font_ref->height() };
+        }
+        // Only the lines which intersect the clip rect are visited, and the first glyph of a line which may be visible is
+        // found by binary search over the pen positions. The cost is proportional to the number of visible glyphs.
+        void emit(const canvas_paragraph& item, const bounds_aabb& clip_rect, vec2 offset, command_queue& queue, const style&,
+                  const std::function<texture_region(font&, glyph_id)>& font_callback) const {
+            offset = offset + item.pos;
+            auto& font = *item.font_ref;
+            const auto spacing = font.line_spacing(), height = font.height();
+            // glyphs may reach out of the line box, one line height is kept as a margin
+            if(offset.y - height >= clip_rect.bottom)
+                return;
+            const auto layout = find_paragraph(item);
+            const auto& [glyphs, lines, width] = *layout;
+            const auto line_count = static_cast<float>(lines.size());
+            const auto first = static_cast<size_t>(
+                std::fmin(line_count, std::fmax(0.0f, std::floor((clip_rect.top - offset.y - 2.0f * height) / spacing))));
+            const auto last = static_cast<size_t>(
+                std::fmin(line_count, std::fmax(0.0f, std::floor((clip_rect.bottom - offset.y + height) / spacing) + 1.0f)));
+            const auto scale = item.alignment == text_alignment::left ? 0.0f :
+                item.alignment == text_alignment::middle                ? 0.5f :
+                                                                          1.0f;
+
+            // glyphs of the same paragraph share draw calls
+            bool merge = false;
+            for(auto idx = first; idx < last; ++idx) {
+                const auto& line = lines[idx];
+                const vec2 line_offset{ offset.x + (item.width - line.width) * scale,
+                                        offset.y + static_cast<float>(idx) * spacing };
+                const auto line_end = glyphs.cbegin() + static_cast<ptrdiff_t>(line.end);
+                auto iter = std::upper_bound(glyphs.cbegin() + static_cast<ptrdiff_t>(line.begin), line_end,
+                                             clip_rect.left - line_offset.x - height,
+                                             [](const float lhs, const laid_glyph& rhs) { return lhs < rhs.x; });
+                if(iter != glyphs.cbegin() + static_cast<ptrdiff_t>(line.begin))
+                    --iter;
+                for(; iter != line_end; ++iter) {
+                    const vec2 pen{ line_offset.x + iter->x, line_offset.y };
+                    if(pen.x >= clip_rect.right)
+                        break;
+                    if(!iter->glyph.idx)
+                        continue;
+                    if(auto bounds = font.calculate_bounds(iter->glyph), rect = bounds; clip_bounds(rect, pen, clip_rect)) {
+                        const auto tex = font_callback(font, iter->glyph);
+                        offset_bounds(bounds, pen);
+                        merge |= emit_quad(bounds, clip_rect, tex.region, tex.tex, item.color, queue, merge);
+                    }
+                }
+            }
+        }
         static vec2 calc_bounds(const extended_callback& item, const style&) {
             return item.bounds;
         }
-        static void emit(const extended_callback& item, const bounds_aabb& clip_rect, const vec2 offset,
-                         std::pmr::vector<command>& commands, std::pmr::vector<vertex>& vertices, const style& style,
-                         const std::function<texture_region(font&, glyph_id)>& font_callback) {
-            item.emitter(clip_rect, offset, commands, style, font_callback);
+        static void emit(const extended_callback& item, const bounds_aabb& clip_rect, const vec2 offset, command_queue& queue,
+                         const style& style, const std::function<texture_region(font&, glyph_id)>& font_callback) {
+            item.emitter(clip_rect, offset, queue.commands, style, font_callback);
         }
-        std::pmr::memory_resource* m_memory_resource;
+        // clip state of the region stack, the operation stream can be emitted from any position given the state there
+        struct emit_state final {
+            std::pmr::vector<std::pair<bounds_aabb, vec2>> clip_stack;
+            uint32_t clip_discard;
+            std::pmr::vector<uint32_t> escaped_clip_discard;
+            std::pmr::vector<bool> escaped_stack;
 
-    public:
-        explicit builtin_emitter(std::pmr::memory_resource* memory_resource) : m_memory_resource{ memory_resource } {}
-        vec2 calculate_bounds(const primitive& primitive, const style& style) override {
-            return std::visit([&style](auto&& item) { return builtin_emitter::calc_bounds(item, style); }, primitive);
+            emit_state(const vec2 size, std::pmr::memory_resource* memory_resource)
+                : clip_stack{ memory_resource }, clip_discard{ 0 }, escaped_clip_discard{ memory_resource },
+                  escaped_stack(memory_resource) {  // not braced, it would be an initializer list of bool
+                clip_stack.push_back({ { 0.0f, size.x, 0.0f, size.y }, { 0.0f, 0.0f } });
+            }
+            emit_state(const emit_state& rhs, std::pmr::memory_resource* memory_resource)
+                : clip_stack{ rhs.clip_stack, memory_resource }, clip_discard{ rhs.clip_discard },
+                  escaped_clip_discard{ rhs.escaped_clip_discard, memory_resource }, escaped_stack{ rhs.escaped_stack,
+                                                                                                    memory_resource } {}
+
+            void push(const vec2 size, bounds_aabb cur) {
+                escaped_stack.push_back(cur.is_escaped());
+                if(cur.is_escaped()) {
+                    escaped_clip_discard.push_back(clip_discard);
+                    clip_stack.push_back({ { 0.0f, size.x, 0.0f, size.y }, { 0.0f, 0.0f } });
+                    clip_discard = 0;
+                } else {
+                    const vec2 offset = { cur.left, cur.top };
+                    if(clip_discard || !clip_bounds(cur, clip_stack.back().second, clip_stack.back().first))
+                        ++clip_discard;
+                    else {
+                        clip_stack.push_back({ cur, clip_stack.back().second + offset });
+                    }
+                }
+            }
+            void pop() {
+                if(escaped_stack.back()) {
+                    clip_discard = escaped_clip_discard.back();
+                    escaped_clip_discard.pop_back();
+                    clip_stack.pop_back();
+                } else {
+                    if(clip_discard)
+                        --clip_discard;
+                    else
+                        clip_stack.pop_back();
+                }
+                escaped_stack.pop_back();
+            }
+        };
+
+        // only used for types without padding bytes
+        template <typename T>
+        static void hash_value(uint64_t& seed, const T& value) noexcept {
+            seed = hash_bytes(&value, sizeof(T), seed);
         }
-        command_queue transform(const vec2 size, span<operation> operations, const style& style,
-                                const std::function<texture_region(font&, glyph_id)>& font_callback) override {
-            std::pmr::vector<command> command_list{ m_memory_resource };
-            command_list.reserve(operations.size());
-            std::pmr::vector<vertex> vertices{ m_memory_resource };
-            vertices.reserve(operations.size());
-
-            std::pmr::monotonic_buffer_resource arena{ m_memory_resource };
-            stack<std::pair<bounds_aabb, vec2>> clip_stack{ &arena };
-            clip_stack.push({ { 0.0f, size.x, 0.0f, size.y }, { 0.0f, 0.0f } });
-            uint32_t clip_discard = 0;
-            stack<uint32_t> escaped_clip_discard{ &arena };
-            stack<bool> escaped_stack{ &arena };
-
-            for(auto&& operation : operations) {
-                switch(operation.index()) {
+        // returns false if the output of the primitive cannot be cached
+        static bool hash_primitive(uint64_t& seed, const button_base& item) noexcept {
+            hash_value(seed, item.anchor);
+            hash_value(seed, item.content_size);
+            hash_value(seed, item.status);
+            return true;
+        }
+        static bool hash_primitive(uint64_t& seed, const canvas_stroke_rect& item) noexcept {
+            hash_value(seed, item.bounds);
+            hash_value(seed, item.color);
+            hash_value(seed, item.size);
+            return true;
+        }
+        static bool hash_primitive(uint64_t& seed, const canvas_fill_rect& item) noexcept {
+            hash_value(seed, item.bounds);
+            hash_value(seed, item.color);
+            return true;
+        }
+        static bool hash_primitive(uint64_t& seed, const canvas_line& item) noexcept {
+            hash_value(seed, item.start);
+            hash_value(seed, item.end);
+            hash_value(seed, item.color);
+            hash_value(seed, item.size);
+            return true;
+        }
+        static bool hash_primitive(uint64_t& seed, const canvas_point& item) noexcept {
+            hash_value(seed, item.pos);
+            hash_value(seed, item.color);
+            hash_value(seed, item.size);
+            return true;
+        }
+        static bool hash_primitive(uint64_t& seed, const canvas_image& item) noexcept {
+            hash_value(seed, item.bounds);
+            hash_value(seed, item.tex.tex.get());
+            hash_value(seed, item.tex.region);
+            hash_value(seed, item.factor);
+            return true;
+        }
+        static bool hash_primitive(uint64_t& seed, const canvas_text& item) noexcept {
+            hash_value(seed, item.pos);
+            hash_value(seed, item.font_ref.get());
+            hash_value(seed, item.color);
+            seed = hash_bytes(item.str.data(), item.str.size(), seed);
+            return true;
+        }
+        // the text is only hashed here, build_records collects it to confirm a cache hit
+        static bool hash_primitive(uint64_t& seed, const canvas_paragraph& item) noexcept {
+            hash_value(seed, item.pos);
+            hash_value(seed, item.width);
+            hash_value(seed, item.font_ref.get());
+            hash_value(seed, item.color);
+            hash_value(seed, item.alignment);
+            hash_value(seed, item.text.hash());
+            return true;
+        }
+        static bool hash_primitive(uint64_t&, const extended_callback&) noexcept {
+            return false;
+        }
+        // the style fields used by emit
+        static uint64_t hash_style(const style& style) noexcept {
+            uint64_t seed = 0xcbf29ce484222325;
+            hash_value(seed, style.padding);
+            hash_value(seed, style.panel_background);
+            hash_value(seed, style.action);
+            hash_value(seed, style.bounds_edge_width);
+            return seed;
+        }
+
+        // Regions with at least this many operations keep their output across frames. The cached output of a region is
+        // reused while the hash of its operations and the clip state at its start are unchanged.
+        static constexpr size_t min_cached_operations = 32;
+        // Entries which were not used in the last frame are evicted. Ages are counted in frames (see new_frame) rather than
+        // transform calls, because offscreen layers call transform several times in a frame.
+        static constexpr uint64_t max_cache_age = 2;
+
+        // preorder record of a region, built before emission
+        struct region_record final {
+            identifier uid;
+            uint64_t hash;
+            size_t begin, end;  // indices of op_push_region and the matching op_pop_region
+            size_t regions;     // number of nested regions
+            size_t texts_begin, texts_end;  // the paragraphs of the region in m_texts
+            bool cacheable;
+        };
+        struct cache_entry final {
+            uint64_t key;
+            uint64_t last_used;
+            std::pmr::vector<vertex> vertices;
+            std::pmr::vector<command> commands;
+            std::pmr::vector<uint32_t> indices;
+            std::pmr::vector<quad_instance> instances;
+            // the texts of the paragraphs, which are compared on a hit because the key only holds their hashes
+            std::pmr::vector<paragraph_text> texts;
+        };
+        // the output range of a region which missed the cache
+        struct cache_store final {
+            identifier uid;
+            uint64_t key;
+            size_t vertices_begin, commands_begin, indices_begin, instances_begin;
+            size_t vertices_end, commands_end, indices_end, instances_end;
+            size_t texts_begin, texts_end;
+        };
+        // cache accesses of one queue, applied on the calling thread after emission
+        struct cache_log final {
+            std::pmr::vector<identifier> used;
+            std::pmr::vector<cache_store> stores;
+        };
+
+        // a continuous range of operations which is emitted by one thread
+        struct chunk final {
+            size_t begin, end;
+            size_t first_record;
+            emit_state state;
+            command_queue queue;
+            cache_log log;
+            bool deferred;
+        };
+
+        void build_records(const span<operation> operations, const span<const operation_segment> order,
+                           const uint64_t style_hash) {
+            m_records.clear();
+            m_open_records.clear();
+            m_texts.clear();
+            // a region which crosses a segment boundary is emitted in pieces, so its output cannot be cached
+            m_boundaries.clear();
+            for(auto&& [begin, end] : order) {
+                m_boundaries.push_back(begin);
+                m_boundaries.push_back(end);
+            }
+            std::sort(m_boundaries.begin(), m_boundaries.end());
+            auto boundary = m_boundaries.cbegin();
+            for(size_t idx = 0; idx < operations.size(); ++idx) {
+                for(; boundary != m_boundaries.cend() && *boundary <= idx; ++boundary)
+                    if(*boundary == idx)
+                        for(const auto record : m_open_records)
+                            m_records[record].cacheable = false;
+                switch(const auto& operation = operations[idx]; operation.index()) {
+                    case 0: {
+                        const auto& push = std::get<op_push_region>(operation);
+                        auto hash = style_hash;
+                        hash_value(hash, push.bounds);
+                        m_open_records.push_back(m_records.size());
+                        m_records.push_back(
+                            { push.uid, hash, idx, std::numeric_limits<size_t>::max(), 0, m_texts.size(), 0, true });
+                    } break;
+                    case 1: {
+                        if(m_open_records.empty())
+                            break;
+                        const auto record_idx = m_open_records.back();
+                        m_open_records.pop_back();
+                        auto& record = m_records[record_idx];
+                        const auto pure = record.cacheable;
+                        record.end = idx;
+                        record.regions = m_records.size() - record_idx - 1;
+                        record.texts_end = m_texts.size();
+                        record.cacheable = pure && record.end - record.begin + 1 >= min_cached_operations;
+                        if(!m_open_records.empty()) {
+                            auto& parent = m_records[m_open_records.back()];
+                            hash_value(parent.hash, record.hash);
+                            parent.cacheable = parent.cacheable && pure;
+                        }
+                    } break;
+                    default: {
+                        if(m_open_records.empty())
+                            break;
+                        auto& record = m_records[m_open_records.back()];
+                        const auto& item = std::get<primitive>(operation);
+                        if(const auto paragraph = std::get_if<canvas_paragraph>(&item))
+                            m_texts.push_back(&paragraph->text);
+                        hash_value(record.hash, item.index());
+                        record.cacheable = std::visit([&](auto&& val) { return hash_primitive(record.hash, val); }, item) &&
+                            record.cacheable;
+                    } break;
+                }
+            }
+            // unbalanced regions
+            for(const auto idx : m_open_records)
+                m_records[idx].cacheable = false;
+        }
+
+        // the first record of a region which begins at or after idx
+        [[nodiscard]] size_t first_record_at(const size_t idx) const {
+            return static_cast<size_t>(std::lower_bound(m_records.cbegin(), m_records.cend(), idx,
+                                                        [](const region_record& record, const size_t rhs) {
+                                                            return record.begin < rhs;
+                                                        }) -
+                                       m_records.cbegin());
+        }
+
+        [[nodiscard]] bool same_texts(const cache_entry& entry, const region_record& record) const noexcept {
+            if(entry.texts.size() != record.texts_end - record.texts_begin)
+                return false;
+            for(size_t idx = 0; idx < entry.texts.size(); ++idx)
+                if(!entry.texts[idx].same_text(*m_texts[record.texts_begin + idx]))
+                    return false;
+            return true;
+        }
+
+        // operations[0] is at index base of the whole operation stream, first_record is the record of its first region
+        void emit_range(const vec2 size, const span<operation> operations, const size_t base, size_t first_record,
+                        emit_state& state, command_queue& queue, cache_log& log, const style& style,
+                        const std::function<texture_region(font&, glyph_id)>& font_callback) const {
+            std::pmr::vector<std::pair<size_t, cache_store>> open_stores{ log.stores.get_allocator().resource() };
+            for(size_t idx = 0; idx < operations.size(); ++idx) {
+                switch(const auto& operation = operations[idx]; operation.index()) {
                     case 0: {
-                        auto cur = std::get<0>(operation).bounds;
-                        escaped_stack.push(cur.is_escaped());
-                        if(cur.is_escaped()) {
-                            escaped_clip_discard.push(clip_discard);
-                            clip_stack.push({ { 0.0f, size.x, 0.0f, size.y }, { 0.0f, 0.0f } });
-                            clip_discard = 0;
-                        } else {
-                            const vec2 offset = { cur.left, cur.top };
-                            if(clip_discard || !clip_bounds(cur, clip_stack.top().second, clip_stack.top().first))
-                                ++clip_discard;
-                            else {
-                                clip_stack.push({ cur, clip_stack.top().second + offset });
+                        const auto& record = m_records[first_record++];
+                        if(record.cacheable && !state.clip_discard && record.end < base + operations.size()) {
+                            auto key = record.hash;
+                            hash_value(key, state.clip_stack.back().first);
+                            hash_value(key, state.clip_stack.back().second);
+                            hash_value(key, size);
+                            if(const auto iter = m_cache.find(record.uid);
+                               iter != m_cache.cend() && iter->second.key == key && same_texts(iter->second, record)) {
+                                auto&& entry = iter->second;
+                                queue.vertices.insert(queue.vertices.cend(), entry.vertices.cbegin(), entry.vertices.cend());
+                                queue.commands.insert(queue.commands.cend(), entry.commands.cbegin(), entry.commands.cend());
+                                queue.indices.insert(queue.indices.cend(), entry.indices.cbegin(), entry.indices.cend());
+                                queue.instances.insert(queue.instances.cend(), entry.instances.cbegin(),
+                                                       entry.instances.cend());
+                                log.used.push_back(record.uid);
+                                idx = record.end - base;
+                                first_record += record.regions;
+                                continue;
                             }
+                            open_stores.push_back({ record.end,
+                                                    { record.uid, key, queue.vertices.size(), queue.commands.size(),
+                                                      queue.indices.size(), queue.instances.size(), 0, 0, 0, 0,
+                                                      record.texts_begin, record.texts_end } });
                         }
+                        state.push(size, std::get<op_push_region>(operation).bounds);
                     } break;
                     case 1: {
-                        if(escaped_stack.top()) {
-                            clip_discard = escaped_clip_discard.top();
-                            escaped_clip_discard.pop();
-                        } else {
-                            if(clip_discard)
-                                --clip_discard;
-                            else
-                                clip_stack.pop();
+                        state.pop();
+                        if(!open_stores.empty() && open_stores.back().first == base + idx) {
+                            auto& store = open_stores.back().second;
+                            store.vertices_end = queue.vertices.size();
+                            store.commands_end = queue.commands.size();
+                            store.indices_end = queue.indices.size();
+                            store.instances_end = queue.instances.size();
+                            log.stores.push_back(store);
+                            open_stores.pop_back();
                         }
-                        escaped_stack.pop();
                     } break;
                     default: {
-                        if(clip_discard)
+                        if(state.clip_discard)
                             continue;
-                        const auto& clip_rect = clip_stack.top();
+                        const auto& clip_rect = state.clip_stack.back();
                         std::visit(
                             [&](auto&& item) {
-                                builtin_emitter::emit(item, clip_rect.first, clip_rect.second, command_list, vertices, style,
-                                                      font_callback);
+                                builtin_emitter::emit(item, clip_rect.first, clip_rect.second, queue, style, font_callback);
                             },
                             std::get<primitive>(operation));
                     } break;
                 }
             }
-            return { std::move(vertices), std::move(command_list) };
+        }
+
+        void apply_cache_log(cache_log& log, const command_queue& queue) {
+            for(const auto uid : log.used)
+                if(const auto iter = m_cache.find(uid); iter != m_cache.cend())
+                    iter->second.last_used = m_frame;
+            for(auto&& store : log.stores) {
+                auto&& entry = m_cache
+                                   .try_emplace(store.uid,
+                                                cache_entry{ 0, 0, std::pmr::vector<vertex>{ m_memory_resource },
+                                                             std::pmr::vector<command>{ m_memory_resource },
+                                                             std::pmr::vector<uint32_t>{ m_memory_resource },
+                                                             std::pmr::vector<quad_instance>{ m_memory_resource },
+                                                             std::pmr::vector<paragraph_text>{ m_memory_resource } })
+                                   .first->second;
+                entry.key = store.key;
+                entry.last_used = m_frame;
+                entry.vertices.assign(queue.vertices.cbegin() + store.vertices_begin,
+                                    queue.vertices.cbegin() + store.vertices_end);
+                entry.commands.assign(queue.commands.cbegin() + store.commands_begin,
+                                    queue.commands.cbegin() + store.commands_end);
+                entry.indices.assign(queue.indices.cbegin() + store.indices_begin, queue.indices.cbegin() + store.indices_end);
+                entry.instances.assign(queue.instances.cbegin() + store.instances_begin,
+                                       queue.instances.cbegin() + store.instances_end);
+                entry.texts.clear();
+                for(auto idx = store.texts_begin; idx < store.texts_end; ++idx)
+                    entry.texts.push_back(*m_texts[idx]);
+            }
+            log.used.clear();
+            log.stores.clear();
+        }
+
+        void evict_cache() {
+            for(auto iter = m_cache.begin(); iter != m_cache.end();) {
+                if(m_frame - iter->second.last_used >= max_cache_age)
+                    iter = m_cache.erase(iter);
+                else
+                    ++iter;
+            }
+            std::lock_guard<std::mutex> guard{ m_paragraph_mutex };
+            for(auto iter = m_paragraphs.begin(); iter != m_paragraphs.end();) {
+                if(m_frame - iter->second.last_used >= max_cache_age)
+                    iter = m_paragraphs.erase(iter);
+                else
+                    ++iter;
+            }
+        }
+
+        // Splits the operations into chunks in the order of the segments and records the clip state at the start of each chunk.
+        // Chunks may start inside a region, so that a single large window can be emitted in parallel as well. Cacheable regions
+        // which fit into a chunk are not split.
+        void plan_chunks(const vec2 size, const span<operation> operations, const span<const operation_segment> order) {
+            const auto chunk_size =
+                std::max(min_chunk_size, (operations.size() + m_thread_pool->concurrency() * 4 - 1) /
+                             (m_thread_pool->concurrency() * 4));
+            emit_state state{ size, &m_chunk_resource };
+            m_chunk_count = 0;
+            for(auto&& [segment_begin, segment_end] : order) {
+                // a chunk is a continuous range, so every segment starts a new one
+                size_t record_idx = first_record_at(segment_begin), hold_until = 0;
+                for(auto idx = segment_begin; idx < segment_end; ++idx) {
+                    if(idx == segment_begin || (idx - m_chunks[m_chunk_count - 1].begin >= chunk_size && idx > hold_until)) {
+                        if(idx != segment_begin)
+                            m_chunks[m_chunk_count - 1].end = idx;
+                        if(m_chunk_count == m_chunks.size())
+                            m_chunks.push_back({ 0, 0, 0, emit_state{ state, &m_chunk_resource },
+                                                 command_queue{ std::pmr::vector<vertex>{ &m_chunk_resource },
+                                                                std::pmr::vector<command>{ &m_chunk_resource },
+                                                                std::pmr::vector<uint32_t>{ &m_chunk_resource },
+                                                                std::pmr::vector<quad_instance>{ &m_chunk_resource } },
+                                                 cache_log{ std::pmr::vector<identifier>{ &m_chunk_resource },
+                                                            std::pmr::vector<cache_store>{ &m_chunk_resource } },
+                                                 false });
+                        auto& [begin, end, first_record, chunk_state, queue, log, deferred] = m_chunks[m_chunk_count++];
+                        begin = idx;
+                        end = segment_end;
+                        first_record = record_idx;
+                        chunk_state.clip_stack.assign(state.clip_stack.cbegin(), state.clip_stack.cend());
+                        chunk_state.clip_discard = state.clip_discard;
+                        chunk_state.escaped_clip_discard.assign(state.escaped_clip_discard.cbegin(),
+                                                                state.escaped_clip_discard.cend());
+                        chunk_state.escaped_stack.assign(state.escaped_stack.cbegin(), state.escaped_stack.cend());
+                        queue.vertices.clear();
+                        queue.commands.clear();
+                        queue.indices.clear();
+                        queue.instances.clear();
+                        log.used.clear();
+                        log.stores.clear();
+                        deferred = false;
+                    }
+
+                    if(const auto& operation = operations[idx]; operation.index() == 0) {
+                        if(const auto& record = m_records[record_idx++];
+                           idx > hold_until && record.cacheable && record.end - record.begin < chunk_size)
+                            hold_until = record.end;
+                        state.push(size, std::get<op_push_region>(operation).bounds);
+                    } else if(operation.index() == 1)
+                        state.pop();
+                }
+            }
+        }
+
+        static constexpr size_t min_chunk_size = 128;
+
+        std::pmr::memory_resource* m_memory_resource;
+        std::unique_ptr<thread_pool> m_thread_pool;
+        std::pmr::synchronized_pool_resource m_chunk_resource;
+        std::pmr::vector<chunk> m_chunks;
+        size_t m_chunk_count = 0;
+        std::pmr::vector<region_record> m_records;
+        std::pmr::vector<size_t> m_open_records;
+        std::pmr::vector<size_t> m_boundaries;
+        // the paragraphs of the operations in order, only valid during transform
+        std::pmr::vector<const paragraph_text*> m_texts;
+        std::pmr::unordered_map<identifier, cache_entry, identifier_hasher> m_cache;
+        uint64_t m_frame = 0;
+        // not allocated from m_memory_resource, the workers of the parallel emitter insert into it
+        mutable std::mutex m_paragraph_mutex;
+        mutable std::unordered_map<uint64_t, paragraph_entry> m_paragraphs;
+
+    public:
+        explicit builtin_emitter(std::pmr::memory_resource* memory_resource, const size_t thread_count)
+            : m_memory_resource{ memory_resource },
+              m_thread_pool{ thread_count > 1 ? std::make_unique<thread_pool>(thread_count - 1) : nullptr },
+              m_chunk_resource{ memory_resource }, m_chunks{ memory_resource }, m_records{ memory_resource },
+              m_open_records{ memory_resource }, m_boundaries{ memory_resource }, m_texts{ memory_resource },
+              m_cache{ memory_resource } {}
+        vec2 calculate_bounds(const primitive& primitive, const style& style) override {
+            return std::visit([this, &style](auto&& item) { return builtin_emitter::calc_bounds(item, style); }, primitive);
+        }
+        void new_frame() override {
+            ++m_frame;
+        }
+        void reset_cache() override {
+            m_cache.clear();
+            std::lock_guard<std::mutex> guard{ m_paragraph_mutex };
+            m_paragraphs.clear();
+        }
+        command_queue transform(const vec2 size, span<operation> operations, const span<const operation_segment> order,
+                                const style& style,
+                                const std::function<texture_region(font&, glyph_id)>& font_callback) override {
+            command_queue queue{ std::pmr::vector<vertex>{ m_memory_resource }, std::pmr::vector<command>{ m_memory_resource },
+                                 std::pmr::vector<uint32_t>{ m_memory_resource },
+                                 std::pmr::vector<quad_instance>{ m_memory_resource } };
+            build_records(operations, order, hash_style(style));
+
+            if(!m_thread_pool || operations.size() < 2 * min_chunk_size) {
+                queue.commands.reserve(operations.size());
+                queue.vertices.reserve(operations.size() * 4);
+                queue.instances.reserve(operations.size());
+
+                std::pmr::monotonic_buffer_resource arena{ m_memory_resource };
+                emit_state state{ size, &arena };
+                cache_log log{ std::pmr::vector<identifier>{ &arena }, std::pmr::vector<cache_store>{ &arena } };
+                for(auto&& [begin, end] : order)
+                    emit_range(size, span<operation>{ operations.begin() + begin, operations.begin() + end }, begin,
+                               first_record_at(begin), state, queue, log, style, font_callback);
+                apply_cache_log(log, queue);
+                evict_cache();
+                return queue;
+            }
+
+            plan_chunks(size, operations, order);
+
+            // Glyphs which are not cached yet can only be uploaded by the calling thread. font_callback returns an empty
+            // texture region for them on the workers, and the chunk is emitted again on the calling thread.
+            const auto caller = std::this_thread::get_id();
+            m_thread_pool->parallel_for(m_chunk_count, [&](const size_t idx) {
+                auto& [begin, end, first_record, state, chunk_queue, log, deferred] = m_chunks[idx];
+                const std::function<texture_region(font&, glyph_id)> callback = [&](font& font_ref, const glyph_id glyph) {
+                    auto region = font_callback(font_ref, glyph);
+                    if(!region.tex && std::this_thread::get_id() != caller)
+                        deferred = true;
+                    return region;
+                };
+                emit_state local_state{ state, &m_chunk_resource };
+                emit_range(size, span<operation>{ operations.begin() + begin, operations.begin() + end }, begin, first_record,
+                           local_state, chunk_queue, log, style, callback);
+            });
+
+            size_t vertices_count = 0, commands_count = 0, indices_count = 0, instances_count = 0;
+            for(size_t idx = 0; idx < m_chunk_count; ++idx) {
+                auto& [begin, end, first_record, state, chunk_queue, log, deferred] = m_chunks[idx];
+                if(deferred) {
+                    chunk_queue.vertices.clear();
+                    chunk_queue.commands.clear();
+                    chunk_queue.indices.clear();
+                    chunk_queue.instances.clear();
+                    log.used.clear();
+                    log.stores.clear();
+                    emit_range(size, span<operation>{ operations.begin() + begin, operations.begin() + end }, begin, first_record,
+                               state, chunk_queue, log, style, font_callback);
+                }
+                apply_cache_log(log, chunk_queue);
+                vertices_count += chunk_queue.vertices.size();
+                commands_count += chunk_queue.commands.size();
+                indices_count += chunk_queue.indices.size();
+                instances_count += chunk_queue.instances.size();
+            }
+            evict_cache();
+
+            // indices are relative to their commands, so the chunks are concatenated as they are
+            queue.vertices.reserve(vertices_count);
+            queue.commands.reserve(commands_count);
+            queue.indices.reserve(indices_count);
+            queue.instances.reserve(instances_count);
+            for(size_t idx = 0; idx < m_chunk_count; ++idx) {
+                auto& chunk_queue = m_chunks[idx].queue;
+                queue.vertices.insert(queue.vertices.cend(), chunk_queue.vertices.cbegin(), chunk_queue.vertices.cend());
+                queue.commands.insert(queue.commands.cend(), std::make_move_iterator(chunk_queue.commands.begin()),
+                                      std::make_move_iterator(chunk_queue.commands.end()));
+                queue.indices.insert(queue.indices.cend(), chunk_queue.indices.cbegin(), chunk_queue.indices.cend());
+                queue.instances.insert(queue.instances.cend(), chunk_queue.instances.cbegin(), chunk_queue.instances.cend());
+                chunk_queue.commands.clear();
+            }
+            return queue;
         }
     };
     std::shared_ptr<emitter> create_builtin_emitter(std::pmr::memory_resource* memory_resource) {
-        return std::make_shared<builtin_emitter>(memory_resource);
+        return std::make_shared<builtin_emitter>(memory_resource, 1);
+    }
+    std::shared_ptr<emitter> create_parallel_emitter(std::pmr::memory_resource* memory_resource, const uint32_t thread_count) {
+        return std::make_shared<builtin_emitter>(memory_resource,
+                                                 thread_count ? thread_count : std::max(1U, std::thread::hardware_concurrency()));
     }
 }  // namespace animgui
@@ -0,0 +1,614 @@
+// SPDX-License-Identifier: MIT
+
+#include "../core/command_fallback.hpp"
+#include "binary_stream.hpp"
+#include <animgui/builtins/frame_capture.hpp>
+#include <animgui/core/command_optimizer.hpp>
+#include <animgui/core/render_backend.hpp>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace animgui {
+    // Capture layout: header ("AGFC", version), then tagged records. A frame is the run of records up to and including
+    // its emit record. Textures are referred to by ids assigned at creation, 0 stands for no texture.
+    static constexpr char capture_magic[4] = { 'A', 'G', 'F', 'C' };
+    static constexpr uint32_t capture_version = 3;
+    // unchanged gaps shorter than this are cheaper to copy than to start a new run
+    static constexpr size_t min_delta_gap = 4;
+
+    enum class capture_record : uint8_t {
+        create_texture,
+        update_texture,
+        generate_mipmap,
+        destroy_texture,
+        update_command_list,
+        render_to_texture,
+        emit
+    };
+
+    static size_t channel_bytes(const channel channels) {
+        switch(channels) {
+            case channel::alpha:
+                return 1;
+            case channel::rgb:
+                return 3;
+            case channel::rgba:
+                return 4;
+        }
+        throw std::runtime_error{ "corrupted frame capture" };
+    }
+
+    class capture_writer final {
+        std::ostream& m_stream;
+        uint32_t m_next_id = 0;
+        bool m_closed = false;
+
+    public:
+        explicit capture_writer(std::ostream& stream) : m_stream{ stream } {
+            write_binary(m_stream, capture_magic);
+            write_binary(m_stream, capture_version);
+            // a remote viewer waits for the header before it sends anything back
+            m_stream.flush();
+        }
+        [[nodiscard]] std::ostream* stream() const noexcept {
+            return m_closed ? nullptr : &m_stream;
+        }
+        [[nodiscard]] uint32_t new_id() noexcept {
+            return ++m_next_id;
+        }
+        // textures may outlive the backend and its stream
+        void close() {
+            m_stream.flush();
+            m_closed = true;
+        }
+    };
+
+    class capture_texture final : public texture {
+        std::shared_ptr<capture_writer> m_writer;
+        std::shared_ptr<texture> m_texture;
+        uint32_t m_id;
+
+    public:
+        capture_texture(std::shared_ptr<capture_writer> writer, std::shared_ptr<texture> inner)
+            : m_writer{ std::move(writer) }, m_texture{ std::move(inner) }, m_id{ m_writer->new_id() } {
+            auto& stream = *m_writer->stream();
+            write_binary(stream, capture_record::create_texture);
+            write_binary(stream, m_id);
+            write_binary(stream, m_texture->texture_size());
+            write_binary(stream, m_texture->channels());
+        }
+        capture_texture(const capture_texture&) = delete;
+        capture_texture(capture_texture&&) = delete;
+        capture_texture& operator=(const capture_texture&) = delete;
+        capture_texture& operator=(capture_texture&&) = delete;
+        ~capture_texture() override {
+            if(const auto stream = m_writer->stream()) {
+                write_binary(*stream, capture_record::destroy_texture);
+                write_binary(*stream, m_id);
+            }
+        }
+
+        [[nodiscard]] uint32_t id() const noexcept {
+            return m_id;
+        }
+        [[nodiscard]] const std::shared_ptr<texture>& inner() const noexcept {
+            return m_texture;
+        }
+
+        void update_texture(const uvec2 offset, const image_desc& image) override {
+            m_texture->update_texture(offset, image);
+            if(const auto stream = m_writer->stream()) {
+                write_binary(*stream, capture_record::update_texture);
+                write_binary(*stream, m_id);
+                write_binary(*stream, offset);
+                write_binary(*stream, image.size);
+                write_binary(*stream, image.channels);
+                write_binary(*stream, image.data,
+                             static_cast<size_t>(image.size.x) * image.size.y * channel_bytes(image.channels));
+            }
+        }
+        void generate_mipmap() override {
+            m_texture->generate_mipmap();
+            if(const auto stream = m_writer->stream()) {
+                write_binary(*stream, capture_record::generate_mipmap);
+                write_binary(*stream, m_id);
+            }
+        }
+        [[nodiscard]] uvec2 texture_size() const noexcept override {
+            return m_texture->texture_size();
+        }
+        [[nodiscard]] channel channels() const noexcept override {
+            return m_texture->channels();
+        }
+        [[nodiscard]] uint64_t native_handle() const noexcept override {
+            return m_texture->native_handle();
+        }
+    };
+
+    // A command flattened into a fixed-size record, so that the command list can be diffed like the other buffers.
+    struct command_record final {
+        enum flags : uint32_t { has_clip = 1 << 0, has_primitives = 1 << 1 };
+
+        bounds_aabb bounds;
+        bounds_aabb clip;
+        uint32_t flags;
+        primitive_type type;
+        uint32_t vertices_count;
+        uint32_t texture_id;
+        float point_line_size;
+        uint32_t indices_count;
+        uint32_t instances_count;
+    };
+    static_assert(sizeof(command_record) == 60);
+
+    // Where the vertices, indices and instances of a command begin in the buffers of its command list.
+    struct slice_offsets final {
+        uint32_t vertices, indices, instances;
+    };
+
+    // The last command list, which the next one is encoded against. The buffers only hold what the commands draw.
+    struct buffer_history final {
+        std::pmr::vector<vertex> vertices;
+        std::pmr::vector<uint32_t> indices;
+        std::pmr::vector<quad_instance> instances;
+        std::pmr::vector<command_record> commands;
+        // one more than commands, the last one is the end of the buffers
+        std::pmr::vector<slice_offsets> offsets;
+        // only used by the writer, to find unchanged commands
+        std::pmr::vector<uint64_t> hashes;
+        std::unordered_map<uint64_t, uint32_t> lookup;
+    };
+
+    static slice_offsets compute_offsets(const std::pmr::vector<command_record>& commands,
+                                         std::pmr::vector<slice_offsets>& offsets) {
+        offsets.clear();
+        offsets.reserve(commands.size() + 1);
+        slice_offsets offset{ 0, 0, 0 };
+        for(auto&& record : commands) {
+            offsets.push_back(offset);
+            offset.vertices += record.vertices_count;
+            offset.indices += record.indices_count;
+            offset.instances += record.instances_count;
+        }
+        offsets.push_back(offset);
+        return offset;
+    }
+
+    template <typename T>
+    static bool same_elements(const T* lhs, const T* rhs, const size_t count) {
+        return count == 0 || std::memcmp(lhs, rhs, count * sizeof(T)) == 0;
+    }
+
+    // A buffer of a command is written as (skip, copy, copied elements) runs against the same buffer of a command of the
+    // last command list, so a command which changed a little costs what changed.
+    template <typename T>
+    static void write_delta(std::ostream& stream, const T* current, const size_t size, const T* previous,
+                            const size_t previous_size) {
+        const auto same = [&](const size_t idx) {
+            return idx < previous_size && std::memcmp(&current[idx], &previous[idx], sizeof(T)) == 0;
+        };
+        for(size_t pos = 0; pos < size;) {
+            auto copy_begin = pos;
+            while(copy_begin < size && same(copy_begin))
+                ++copy_begin;
+            auto copy_end = copy_begin;
+            while(copy_end < size) {
+                if(!same(copy_end)) {
+                    ++copy_end;
+                    continue;
+                }
+                auto gap_end = copy_end;
+                while(gap_end < size && gap_end - copy_end < min_delta_gap && same(gap_end))
+                    ++gap_end;
+                if(gap_end == size || gap_end - copy_end >= min_delta_gap)
+                    break;
+                copy_end = gap_end;
+            }
+            write_binary(stream, static_cast<uint32_t>(copy_begin - pos));
+            write_binary(stream, static_cast<uint32_t>(copy_end - copy_begin));
+            write_binary(stream, current + copy_begin, (copy_end - copy_begin) * sizeof(T));
+            pos = copy_end;
+        }
+    }
+    // appends size elements to buffer
+    template <typename T>
+    static void read_delta(std::istream& stream, std::pmr::vector<T>& buffer, const size_t size, const T* previous,
+                           const size_t previous_size) {
+        const auto base = buffer.size();
+        buffer.resize(base + size);
+        for(size_t pos = 0; pos < size;) {
+            const size_t skip = read_binary<uint32_t>(stream);
+            const size_t copy = read_binary<uint32_t>(stream);
+            if(skip + copy == 0 || skip + copy > size - pos || (skip != 0 && pos + skip > previous_size))
+                throw std::runtime_error{ "corrupted frame capture" };
+            std::copy_n(previous + pos, skip, buffer.data() + base + pos);
+            read_binary(stream, buffer.data() + base + pos + skip, copy * sizeof(T));
+            pos += skip + copy;
+        }
+    }
+
+    // A command list is written as its size followed by (first, count) entries. A non-empty entry copies count commands
+    // with their vertices, indices and instances from the last command list, starting at first, so inserting, removing
+    // or moving commands costs only the commands which changed. An empty entry is followed by one command written in
+    // full, whose buffers are encoded against the command at first of the last command list if there is one.
+    // Native callbacks cannot be serialized, they are replayed as no-ops.
+    static void write_command_queue(std::ostream& stream, const command_queue& queue, buffer_history& history) {
+        buffer_history current;
+        current.commands.reserve(queue.commands.size());
+        for(auto&& cmd : queue.commands) {
+            // the unused fields stay zero to keep unchanged commands bitwise equal
+            command_record record{};
+            record.bounds = cmd.bounds;
+            if(cmd.clip.has_value()) {
+                record.flags |= command_record::has_clip;
+                record.clip = cmd.clip.value();
+            }
+            if(const auto desc = std::get_if<primitives>(&cmd.desc)) {
+                record.flags |= command_record::has_primitives;
+                record.type = desc->type;
+                record.vertices_count = desc->vertices_count;
+                record.texture_id = desc->tex ? static_cast<const capture_texture&>(*desc->tex).id() : 0;
+                record.point_line_size = desc->point_line_size;
+                record.indices_count = desc->indices_count;
+                record.instances_count = desc->instances_count;
+            }
+            current.commands.push_back(record);
+        }
+        const auto end = compute_offsets(current.commands, current.offsets);
+        if(end.vertices > queue.vertices.size() || end.indices > queue.indices.size() ||
+           end.instances > queue.instances.size())
+            throw std::logic_error{ "the command list draws more than its buffers hold" };
+        current.vertices.assign(queue.vertices.cbegin(), queue.vertices.cbegin() + end.vertices);
+        current.indices.assign(queue.indices.cbegin(), queue.indices.cbegin() + end.indices);
+        current.instances.assign(queue.instances.cbegin(), queue.instances.cbegin() + end.instances);
+
+        current.hashes.reserve(current.commands.size());
+        for(size_t idx = 0; idx < current.commands.size(); ++idx) {
+            auto&& record = current.commands[idx];
+            auto&& offset = current.offsets[idx];
+            auto hash = hash_bytes(&record, sizeof(record), 0);
+            hash = hash_bytes(current.vertices.data() + offset.vertices, record.vertices_count * sizeof(vertex), hash);
+            hash = hash_bytes(current.indices.data() + offset.indices, record.indices_count * sizeof(uint32_t), hash);
+            hash = hash_bytes(current.instances.data() + offset.instances,
+                              record.instances_count * sizeof(quad_instance), hash);
+            current.hashes.push_back(hash);
+        }
+
+        const auto same = [&](const size_t idx, const size_t previous_idx) {
+            if(previous_idx >= history.commands.size() || current.hashes[idx] != history.hashes[previous_idx])
+                return false;
+            auto&& record = current.commands[idx];
+            auto &&offset = current.offsets[idx], &&previous_offset = history.offsets[previous_idx];
+            return std::memcmp(&record, &history.commands[previous_idx], sizeof(record)) == 0 &&
+                same_elements(current.vertices.data() + offset.vertices, history.vertices.data() + previous_offset.vertices,
+                              record.vertices_count) &&
+                same_elements(current.indices.data() + offset.indices, history.indices.data() + previous_offset.indices,
+                              record.indices_count) &&
+                same_elements(current.instances.data() + offset.instances,
+                              history.instances.data() + previous_offset.instances, record.instances_count);
+        };
+
+        const auto size = current.commands.size();
+        write_binary(stream, static_cast<uint32_t>(size));
+        // the command after the last copied run, which is usually the one the next command replaces
+        size_t cursor = 0;
+        for(size_t pos = 0; pos < size;) {
+            auto first = cursor;
+            if(!same(pos, first)) {
+                const auto iter = history.lookup.find(current.hashes[pos]);
+                if(iter != history.lookup.cend() && same(pos, iter->second))
+                    first = iter->second;
+            }
+            size_t count = 0;
+            while(pos + count < size && same(pos + count, first + count))
+                ++count;
+            write_binary(stream, static_cast<uint32_t>(first));
+            write_binary(stream, static_cast<uint32_t>(count));
+            if(count == 0) {
+                auto&& record = current.commands[pos];
+                auto&& offset = current.offsets[pos];
+                slice_offsets previous_begin{ 0, 0, 0 }, previous_end{ 0, 0, 0 };
+                if(first < history.commands.size()) {
+                    previous_begin = history.offsets[first];
+                    previous_end = history.offsets[first + 1];
+                }
+                write_binary(stream, record);
+                write_delta(stream, current.vertices.data() + offset.vertices, record.vertices_count,
+                            history.vertices.data() + previous_begin.vertices, previous_end.vertices - previous_begin.vertices);
+                write_delta(stream, current.indices.data() + offset.indices, record.indices_count,
+                            history.indices.data() + previous_begin.indices, previous_end.indices - previous_begin.indices);
+                write_delta(stream, current.instances.data() + offset.instances, record.instances_count,
+                            history.instances.data() + previous_begin.instances,
+                            previous_end.instances - previous_begin.instances);
+                count = 1;
+            }
+            pos += count;
+            cursor = first + count;
+        }
+
+        // identical commands are all copied from the first one
+        current.lookup.reserve(size);
+        for(size_t idx = 0; idx < size; ++idx)
+            current.lookup.emplace(current.hashes[idx], static_cast<uint32_t>(idx));
+        history = std::move(current);
+    }
+
+    // the wrapped backend only understands its own textures
+    static command_queue unwrap_textures(command_queue queue) {
+        for(auto&& cmd : queue.commands)
+            if(const auto desc = std::get_if<primitives>(&cmd.desc); desc && desc->tex)
+                desc->tex = static_cast<const capture_texture&>(*desc->tex).inner();
+        return queue;
+    }
+
+    class capture_render_backend final : public render_backend {
+        render_backend& m_backend;
+        std::shared_ptr<capture_writer> m_writer;
+        buffer_history m_history;
+
+    public:
+        capture_render_backend(render_backend& backend, std::ostream& stream)
+            : m_backend{ backend }, m_writer{ std::make_shared<capture_writer>(stream) } {}
+        capture_render_backend(const capture_render_backend&) = delete;
+        capture_render_backend(capture_render_backend&&) = delete;
+        capture_render_backend& operator=(const capture_render_backend&) = delete;
+        capture_render_backend& operator=(capture_render_backend&&) = delete;
+        ~capture_render_backend() override {
+            m_writer->close();
+        }
+
+        void update_command_list(const uvec2 window_size, command_queue command_list) override {
+            auto& stream = *m_writer->stream();
+            write_binary(stream, capture_record::update_command_list);
+            write_binary(stream, window_size);
+            write_command_queue(stream, command_list, m_history);
+            m_backend.update_command_list(window_size, unwrap_textures(std::move(command_list)));
+        }
+        std::shared_ptr<texture> create_texture(const uvec2 size, const channel channels) override {
+            return std::make_shared<capture_texture>(m_writer, m_backend.create_texture(size, channels));
+        }
+        // the content of a native texture is not captured, it is replayed as a blank texture
+        std::shared_ptr<texture> create_texture_from_native_handle(const uint64_t handle, const uvec2 size,
+                                                                   const channel channels) override {
+            return std::make_shared<capture_texture>(m_writer,
+                                                     m_backend.create_texture_from_native_handle(handle, size, channels));
+        }
+        void emit(const uvec2 screen_size) override {
+            m_backend.emit(screen_size);
+            auto& stream = *m_writer->stream();
+            write_binary(stream, capture_record::emit);
+            write_binary(stream, screen_size);
+            stream.flush();
+        }
+        [[nodiscard]] uint64_t render_time() const noexcept override {
+            return m_backend.render_time();
+        }
+        [[nodiscard]] uint64_t upload_time() const noexcept override {
+            return m_backend.upload_time();
+        }
+        [[nodiscard]] uint64_t emit_finish_time() const noexcept override {
+            return m_backend.emit_finish_time();
+        }
+        [[nodiscard]] primitive_type supported_primitives() const noexcept override {
+            return m_backend.supported_primitives();
+        }
+        [[nodiscard]] bool offscreen_supported() const noexcept override {
+            return m_backend.offscreen_supported();
+        }
+        void render_to_texture(texture& target, const uvec2 size, command_queue command_list) override {
+            auto& stream = *m_writer->stream();
+            auto& capture_target = static_cast<capture_texture&>(target);
+            write_binary(stream, capture_record::render_to_texture);
+            write_binary(stream, capture_target.id());
+            write_binary(stream, size);
+            // layers are rendered rarely, they are written in full
+            buffer_history history;
+            write_command_queue(stream, command_list, history);
+            m_backend.render_to_texture(*capture_target.inner(), size, unwrap_textures(std::move(command_list)));
+        }
+    };
+
+    ANIMGUI_API std::shared_ptr<render_backend> create_capture_render_backend(render_backend& backend, std::ostream& stream) {
+        return std::make_shared<capture_render_backend>(backend, stream);
+    }
+
+    class null_texture final : public texture {
+        uvec2 m_size;
+        channel m_channels;
+
+    public:
+        null_texture(const uvec2 size, const channel channels) : m_size{ size }, m_channels{ channels } {}
+        void update_texture(uvec2, const image_desc& image) override {
+            if(image.channels != m_channels)
+                throw std::runtime_error{ "mismatched channel" };
+        }
+        void generate_mipmap() override {}
+        [[nodiscard]] uvec2 texture_size() const noexcept override {
+            return m_size;
+        }
+        [[nodiscard]] channel channels() const noexcept override {
+            return m_channels;
+        }
+        [[nodiscard]] uint64_t native_handle() const noexcept override {
+            return 0;
+        }
+    };
+
+    class null_render_backend final : public render_backend {
+    public:
+        void update_command_list(uvec2, command_queue) override {}
+        std::shared_ptr<texture> create_texture(const uvec2 size, const channel channels) override {
+            return std::make_shared<null_texture>(size, channels);
+        }
+        std::shared_ptr<texture> create_texture_from_native_handle(uint64_t, const uvec2 size, const channel channels) override {
+            return std::make_shared<null_texture>(size, channels);
+        }
+        void emit(uvec2) override {}
+        [[nodiscard]] uint64_t render_time() const noexcept override {
+            return 0;
+        }
+        [[nodiscard]] primitive_type supported_primitives() const noexcept override {
+            return primitive_type::points | primitive_type::lines | primitive_type::line_strip | primitive_type::line_loop |
+                primitive_type::triangles | primitive_type::triangle_fan | primitive_type::triangle_strip |
+                primitive_type::quads | primitive_type::quad_instances;
+        }
+        [[nodiscard]] bool offscreen_supported() const noexcept override {
+            return true;
+        }
+        void render_to_texture(texture&, uvec2, command_queue) override {}
+    };
+
+    ANIMGUI_API std::shared_ptr<render_backend> create_null_render_backend() {
+        return std::make_shared<null_render_backend>();
+    }
+
+    class frame_player_impl final : public frame_player {
+        std::istream& m_stream;
+        render_backend& m_backend;
+        const command_optimizer& m_command_optimizer;
+        // The capture holds the primitives supported by the recording backend, e.g. lines from a null backend of a remote
+        // host. They are expanded again for the backend which replays them.
+        command_fallback_translator m_command_fallback_translator;
+        std::unordered_map<uint32_t, std::shared_ptr<texture>> m_textures;
+        std::pmr::vector<uint8_t> m_pixels;
+        buffer_history m_history;
+        uvec2 m_screen_size;
+
+        [[nodiscard]] const std::shared_ptr<texture>& find_texture(const uint32_t id) const {
+            const auto iter = m_textures.find(id);
+            if(iter == m_textures.cend())
+                throw std::runtime_error{ "corrupted frame capture" };
+            return iter->second;
+        }
+        command_queue read_command_queue(buffer_history& history) {
+            buffer_history current;
+            const size_t size = read_binary<uint32_t>(m_stream);
+            current.commands.reserve(size);
+            while(current.commands.size() < size) {
+                const size_t first = read_binary<uint32_t>(m_stream);
+                const size_t count = read_binary<uint32_t>(m_stream);
+                if(count != 0) {
+                    if(count > size - current.commands.size() || first > history.commands.size() ||
+                       count > history.commands.size() - first)
+                        throw std::runtime_error{ "corrupted frame capture" };
+                    auto &&begin = history.offsets[first], &&end = history.offsets[first + count];
+                    current.vertices.insert(current.vertices.cend(), history.vertices.cbegin() + begin.vertices,
+                                            history.vertices.cbegin() + end.vertices);
+                    current.indices.insert(current.indices.cend(), history.indices.cbegin() + begin.indices,
+                                           history.indices.cbegin() + end.indices);
+                    current.instances.insert(current.instances.cend(), history.instances.cbegin() + begin.instances,
+                                             history.instances.cbegin() + end.instances);
+                    current.commands.insert(current.commands.cend(), history.commands.cbegin() + first,
+                                            history.commands.cbegin() + first + count);
+                    continue;
+                }
+                const auto record = read_binary<command_record>(m_stream);
+                slice_offsets previous_begin{ 0, 0, 0 }, previous_end{ 0, 0, 0 };
+                if(first < history.commands.size()) {
+                    previous_begin = history.offsets[first];
+                    previous_end = history.offsets[first + 1];
+                }
+                read_delta(m_stream, current.vertices, record.vertices_count, history.vertices.data() + previous_begin.vertices,
+                           previous_end.vertices - previous_begin.vertices);
+                read_delta(m_stream, current.indices, record.indices_count, history.indices.data() + previous_begin.indices,
+                           previous_end.indices - previous_begin.indices);
+                read_delta(m_stream, current.instances, record.instances_count,
+                           history.instances.data() + previous_begin.instances,
+                           previous_end.instances - previous_begin.instances);
+                current.commands.push_back(record);
+            }
+            compute_offsets(current.commands, current.offsets);
+            history = std::move(current);
+
+            command_queue queue{ history.vertices, {}, history.indices, history.instances };
+            queue.commands.reserve(history.commands.size());
+            for(auto&& record : history.commands) {
+                std::optional<bounds_aabb> clip;
+                if(record.flags & command_record::has_clip)
+                    clip = record.clip;
+                if(record.flags & command_record::has_primitives)
+                    queue.commands.push_back({ record.bounds, clip,
+                                               primitives{ record.type, record.vertices_count,
+                                                           record.texture_id ? find_texture(record.texture_id) : nullptr,
+                                                           record.point_line_size, record.indices_count,
+                                                           record.instances_count } });
+                else
+                    queue.commands.push_back({ record.bounds, clip, native_callback{ [] {} } });
+            }
+            return queue;
+        }
+
+    public:
+        frame_player_impl(std::istream& stream, render_backend& backend, const command_optimizer& command_optimizer)
+            : m_stream{ stream }, m_backend{ backend }, m_command_optimizer{ command_optimizer },
+              m_command_fallback_translator{ backend.supported_primitives() & command_optimizer.supported_primitives() },
+              m_screen_size{ 0, 0 } {
+            char magic[sizeof(capture_magic)];
+            read_binary(m_stream, magic, sizeof(magic));
+            if(std::memcmp(magic, capture_magic, sizeof(magic)) != 0 || read_binary<uint32_t>(m_stream) != capture_version)
+                throw std::runtime_error{ "unsupported frame capture" };
+        }
+
+        bool replay_frame() override {
+            // texture records may follow the last emit
+            while(m_stream.peek() != std::istream::traits_type::eof()) {
+                switch(read_binary<capture_record>(m_stream)) {
+                    case capture_record::create_texture: {
+                        const auto id = read_binary<uint32_t>(m_stream);
+                        const auto size = read_binary<uvec2>(m_stream);
+                        const auto channels = read_binary<channel>(m_stream);
+                        m_textures[id] = m_backend.create_texture(size, channels);
+                    } break;
+                    case capture_record::update_texture: {
+                        auto& tex = *find_texture(read_binary<uint32_t>(m_stream));
+                        const auto offset = read_binary<uvec2>(m_stream);
+                        const auto size = read_binary<uvec2>(m_stream);
+                        const auto channels = read_binary<channel>(m_stream);
+                        m_pixels.resize(static_cast<size_t>(size.x) * size.y * channel_bytes(channels));
+                        read_binary(m_stream, m_pixels.data(), m_pixels.size());
+                        tex.update_texture(offset, image_desc{ size, channels, m_pixels.data() });
+                    } break;
+                    case capture_record::generate_mipmap:
+                        find_texture(read_binary<uint32_t>(m_stream))->generate_mipmap();
+                        break;
+                    case capture_record::destroy_texture:
+                        m_textures.erase(read_binary<uint32_t>(m_stream));
+                        break;
+                    case capture_record::update_command_list: {
+                        const auto size = read_binary<uvec2>(m_stream);
+                        // m_history keeps the captured primitives for the deltas of the next frame
+                        auto queue = read_command_queue(m_history);
+                        m_command_fallback_translator.transform(queue);
+                        m_backend.update_command_list(size, m_command_optimizer.optimize(size, std::move(queue)));
+                    } break;
+                    case capture_record::render_to_texture: {
+                        auto& target = *find_texture(read_binary<uint32_t>(m_stream));
+                        const auto size = read_binary<uvec2>(m_stream);
+                        buffer_history history;
+                        auto queue = read_command_queue(history);
+                        if(m_backend.offscreen_supported()) {
+                            m_command_fallback_translator.transform(queue);
+                            m_backend.render_to_texture(target, size, std::move(queue));
+                        }
+                    } break;
+                    case capture_record::emit:
+                        m_screen_size = read_binary<uvec2>(m_stream);
+                        m_backend.emit(m_screen_size);
+                        return true;
+                    default:
+                        throw std::runtime_error{ "corrupted frame capture" };
+                }
+            }
+            return false;
+        }
+        [[nodiscard]] uvec2 screen_size() const noexcept override {
+            return m_screen_size;
+        }
+    };
+
+    ANIMGUI_API std::shared_ptr<frame_player> create_frame_player(std::istream& stream, render_backend& backend,
+                                                                  const command_optimizer& command_optimizer) {
+        return std::make_shared<frame_player_impl>(stream, backend, command_optimizer);
+    }
+}  // namespace animgui
@@ -0,0 +1,491 @@
+// SPDX-License-Identifier: MIT
+
+#include "binary_stream.hpp"
+#include <algorithm>
+#include <animgui/builtins/input_replay.hpp>
+#include <animgui/core/input_backend.hpp>
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace animgui {
+    // Log layout: header ("AGIR", version, scroll factor), then one record per frame. Each record starts with a flag byte
+    // telling which optional sections follow, so an idle frame takes 15 bytes.
+    static constexpr char log_magic[4] = { 'A', 'G', 'I', 'R' };
+    static constexpr uint32_t log_version = 1;
+    static constexpr size_t key_count = 256;
+    static constexpr size_t max_game_pads = 16;
+
+    enum frame_flags : uint8_t {
+        keys_changed = 1 << 0,
+        game_pads_changed = 1 << 1,
+        has_characters = 1 << 2,
+        has_clipboard = 1 << 3,
+        has_pointer_motion = 1 << 4,
+        has_direction = 1 << 5,
+        viewport_changed = 1 << 6,
+    };
+
+    struct input_frame final {
+        float delta_t = 0.0f;
+        input_mode mode = input_mode::mouse;
+        bool action_press = false;
+        uint8_t modifiers = 0;
+        vec2 cursor_pos, mouse_move, scroll, direction, direction_navigation;
+        uvec2 window_size, framebuffer_size;
+        // key state, pulse and repeated pulse bitsets
+        std::array<uint8_t, 3 * key_count / 8> keys{};
+        std::pmr::vector<uint32_t> characters;
+        std::pmr::vector<std::pair<uint8_t, game_pad_state>> game_pads;
+        std::pmr::vector<std::pmr::string> clipboard;
+
+        [[nodiscard]] bool test_key(const size_t bank, const key_code code) const noexcept {
+            const auto idx = bank * key_count + (static_cast<uint32_t>(code) & (key_count - 1));
+            return keys[idx / 8] & (1 << (idx % 8));
+        }
+        void set_key(const size_t bank, const size_t code) noexcept {
+            const auto idx = bank * key_count + code;
+            keys[idx / 8] |= static_cast<uint8_t>(1 << (idx % 8));
+        }
+    };
+
+    static uint16_t pack_buttons(const game_pad_state& state) noexcept {
+        const bool buttons[] = { state.a,          state.b,           state.x,          state.y,
+                                 state.left_bumper, state.right_bumper, state.back,      state.start,
+                                 state.guide,      state.left_thumb,  state.right_thumb, state.d_pad_up,
+                                 state.d_pad_right, state.d_pad_down,  state.d_pad_left };
+        uint16_t bits = 0;
+        for(size_t idx = 0; idx < std::size(buttons); ++idx)
+            bits |= static_cast<uint16_t>(buttons[idx] << idx);
+        return bits;
+    }
+    static bool same_game_pad(const game_pad_state& lhs, const game_pad_state& rhs) noexcept {
+        return pack_buttons(lhs) == pack_buttons(rhs) && lhs.left_axis.x == rhs.left_axis.x &&
+            lhs.left_axis.y == rhs.left_axis.y && lhs.right_axis.x == rhs.right_axis.x &&
+            lhs.right_axis.y == rhs.right_axis.y && lhs.left_trigger == rhs.left_trigger &&
+            lhs.right_trigger == rhs.right_trigger;
+    }
+    static void write_game_pad(std::ostream& stream, const game_pad_state& state) {
+        write_binary(stream, pack_buttons(state));
+        write_binary(stream, state.left_axis);
+        write_binary(stream, state.right_axis);
+        write_binary(stream, state.left_trigger);
+        write_binary(stream, state.right_trigger);
+    }
+    static game_pad_state read_game_pad(std::istream& stream) {
+        const auto bits = read_binary<uint16_t>(stream);
+        const auto bit = [bits](const int idx) { return ((bits >> idx) & 1) != 0; };
+        game_pad_state state{ bit(0), bit(1),  bit(2),  bit(3),  bit(4),  bit(5),  bit(6), bit(7), bit(8),
+                              bit(9), bit(10), bit(11), bit(12), bit(13), bit(14), {},     {},     0.0f,   0.0f };
+        state.left_axis = read_binary<vec2>(stream);
+        state.right_axis = read_binary<vec2>(stream);
+        state.left_trigger = read_binary<float>(stream);
+        state.right_trigger = read_binary<float>(stream);
+        return state;
+    }
+
+    class input_recorder_impl final : public input_recorder {
+        input_backend& m_input;
+        std::ostream& m_stream;
+        input_frame m_frame, m_last_frame;
+        uvec2 m_window_size, m_framebuffer_size;
+        // a live recorder writes every frame as soon as it begins, without the clipboard reads
+        bool m_live;
+        bool m_has_frame;
+        uint64_t m_last_time;
+
+        void capture(const float delta_t) {
+            m_frame.delta_t = delta_t;
+            m_frame.window_size = m_window_size;
+            m_frame.framebuffer_size = m_framebuffer_size;
+            m_frame.mode = m_input.get_input_mode();
+            m_frame.action_press = m_input.action_press();
+            m_frame.modifiers = static_cast<uint8_t>(m_input.get_modifier_key(modifier_key::shift) |
+                                                     m_input.get_modifier_key(modifier_key::control) << 1 |
+                                                     m_input.get_modifier_key(modifier_key::alt) << 2);
+            m_frame.cursor_pos = m_input.get_cursor_pos();
+            m_frame.mouse_move = m_input.mouse_move();
+            m_frame.scroll = m_input.scroll();
+            m_frame.direction = m_input.action_direction_pulse_repeated(false);
+            m_frame.direction_navigation = m_input.action_direction_pulse_repeated(true);
+
+            m_frame.keys.fill(0);
+            for(size_t code = 0; code < key_count; ++code) {
+                const auto key = static_cast<key_code>(code);
+                if(m_input.get_key(key))
+                    m_frame.set_key(0, code);
+                if(m_input.get_key_pulse(key, false))
+                    m_frame.set_key(1, code);
+                if(m_input.get_key_pulse(key, true))
+                    m_frame.set_key(2, code);
+            }
+
+            const auto characters = m_input.get_input_characters();
+            m_frame.characters.assign(characters.begin(), characters.end());
+            m_frame.game_pads.clear();
+            for(const auto idx : m_input.list_game_pad())
+                m_frame.game_pads.emplace_back(static_cast<uint8_t>(idx), m_input.get_game_pad_state(idx));
+            m_frame.clipboard.clear();
+        }
+        void write_frame() {
+            const auto zero = [](const vec2 v) { return v.x == 0.0f && v.y == 0.0f; };
+            const auto same_pads =
+                m_frame.game_pads.size() == m_last_frame.game_pads.size() &&
+                std::equal(m_frame.game_pads.cbegin(), m_frame.game_pads.cend(), m_last_frame.game_pads.cbegin(),
+                           [](const auto& lhs, const auto& rhs) {
+                               return lhs.first == rhs.first && same_game_pad(lhs.second, rhs.second);
+                           });
+
+            uint8_t flags = 0;
+            if(m_frame.keys != m_last_frame.keys)
+                flags |= keys_changed;
+            if(!same_pads)
+                flags |= game_pads_changed;
+            if(!m_frame.characters.empty())
+                flags |= has_characters;
+            if(!m_frame.clipboard.empty())
+                flags |= has_clipboard;
+            if(!zero(m_frame.mouse_move) || !zero(m_frame.scroll))
+                flags |= has_pointer_motion;
+            if(!zero(m_frame.direction) || !zero(m_frame.direction_navigation))
+                flags |= has_direction;
+            if(m_frame.window_size != m_last_frame.window_size || m_frame.framebuffer_size != m_last_frame.framebuffer_size)
+                flags |= viewport_changed;
+
+            write_binary(m_stream, flags);
+            write_binary(m_stream, m_frame.delta_t);
+            write_binary(m_stream, static_cast<uint8_t>(m_frame.mode));
+            write_binary(m_stream, static_cast<uint8_t>(m_frame.action_press | m_frame.modifiers << 1));
+            write_binary(m_stream, m_frame.cursor_pos);
+            if(flags & has_pointer_motion) {
+                write_binary(m_stream, m_frame.mouse_move);
+                write_binary(m_stream, m_frame.scroll);
+            }
+            if(flags & has_direction) {
+                write_binary(m_stream, m_frame.direction);
+                write_binary(m_stream, m_frame.direction_navigation);
+            }
+            if(flags & viewport_changed) {
+                write_binary(m_stream, m_frame.window_size);
+                write_binary(m_stream, m_frame.framebuffer_size);
+            }
+            if(flags & keys_changed)
+                write_binary(m_stream, m_frame.keys);
+            if(flags & has_characters) {
+                write_binary(m_stream, static_cast<uint32_t>(m_frame.characters.size()));
+                write_binary(m_stream, m_frame.characters.data(), m_frame.characters.size() * sizeof(uint32_t));
+            }
+            if(flags & game_pads_changed) {
+                write_binary(m_stream, static_cast<uint8_t>(m_frame.game_pads.size()));
+                for(auto&& [idx, state] : m_frame.game_pads) {
+                    write_binary(m_stream, idx);
+                    write_game_pad(m_stream, state);
+                }
+            }
+            if(flags & has_clipboard) {
+                write_binary(m_stream, static_cast<uint32_t>(m_frame.clipboard.size()));
+                for(auto&& str : m_frame.clipboard) {
+                    write_binary(m_stream, static_cast<uint32_t>(str.size()));
+                    write_binary(m_stream, str.data(), str.size());
+                }
+            }
+            std::swap(m_frame, m_last_frame);
+        }
+
+    public:
+        input_recorder_impl(input_backend& input, std::ostream& stream, const bool live)
+            : m_input{ input }, m_stream{ stream }, m_window_size{ 0, 0 }, m_framebuffer_size{ 0, 0 }, m_live{ live },
+              m_has_frame{ false }, m_last_time{ 0 } {
+            write_binary(m_stream, log_magic);
+            write_binary(m_stream, log_version);
+            write_binary(m_stream, m_input.scroll_factor());
+            if(m_live)
+                m_stream.flush();
+        }
+        input_recorder_impl(const input_recorder_impl&) = delete;
+        input_recorder_impl(input_recorder_impl&&) = delete;
+        input_recorder_impl& operator=(const input_recorder_impl&) = delete;
+        input_recorder_impl& operator=(input_recorder_impl&&) = delete;
+        ~input_recorder_impl() override {
+            if(m_has_frame && !m_live)
+                write_frame();
+            m_stream.flush();
+        }
+
+        void set_viewport(const uvec2 window_size, const uvec2 framebuffer_size) noexcept override {
+            m_window_size = window_size;
+            m_framebuffer_size = framebuffer_size;
+        }
+        // the clipboard reads of a frame are only known when the next frame begins
+        void new_frame() override {
+            if(m_has_frame && !m_live)
+                write_frame();
+            m_input.new_frame();
+            const auto now = current_time();
+            capture(m_has_frame ? static_cast<float>(static_cast<double>(now - m_last_time) /
+                                                     static_cast<double>(clocks_per_second())) :
+                                  0.0f);
+            m_last_time = now;
+            m_has_frame = true;
+            if(m_live) {
+                write_frame();
+                m_stream.flush();
+            }
+        }
+        [[nodiscard]] bool events_arrived() const noexcept override {
+            return m_input.events_arrived();
+        }
+        void wait_events(const double timeout) override {
+            m_input.wait_events(timeout);
+        }
+        [[nodiscard]] input_mode get_input_mode() const noexcept override {
+            return m_input.get_input_mode();
+        }
+        void close_window() override {
+            m_input.close_window();
+        }
+        void minimize_window() override {
+            m_input.minimize_window();
+        }
+        void maximize_window() override {
+            m_input.maximize_window();
+        }
+        void move_window(const int32_t dx, const int32_t dy) override {
+            m_input.move_window(dx, dy);
+        }
+        void focus_window() override {
+            m_input.focus_window();
+        }
+        void set_clipboard_text(const std::pmr::string& str) override {
+            m_input.set_clipboard_text(str);
+        }
+        std::pmr::string get_clipboard_text() override {
+            auto str = m_input.get_clipboard_text();
+            if(!m_live)
+                m_frame.clipboard.push_back(str);
+            return str;
+        }
+        [[nodiscard]] span<const uint32_t> get_input_characters() const noexcept override {
+            return m_input.get_input_characters();
+        }
+        void set_input_candidate_window(const vec2 pos) override {
+            m_input.set_input_candidate_window(pos);
+        }
+        [[nodiscard]] vec2 get_cursor_pos() const override {
+            return m_input.get_cursor_pos();
+        }
+        [[nodiscard]] vec2 mouse_move() const noexcept override {
+            return m_input.mouse_move();
+        }
+        [[nodiscard]] vec2 scroll() const noexcept override {
+            return m_input.scroll();
+        }
+        [[nodiscard]] vec2 scroll_factor() const noexcept override {
+            return m_input.scroll_factor();
+        }
+        void set_cursor(const cursor cursor) noexcept override {
+            m_input.set_cursor(cursor);
+        }
+        [[nodiscard]] bool get_key(const key_code code) const override {
+            return m_input.get_key(code);
+        }
+        [[nodiscard]] bool get_key_pulse(const key_code code, const bool allow_repeated) const override {
+            return m_input.get_key_pulse(code, allow_repeated);
+        }
+        [[nodiscard]] bool get_modifier_key(const modifier_key code) const override {
+            return m_input.get_modifier_key(code);
+        }
+        [[nodiscard]] std::pmr::string get_game_pad_name(const size_t idx) const override {
+            return m_input.get_game_pad_name(idx);
+        }
+        [[nodiscard]] span<const size_t> list_game_pad() const noexcept override {
+            return m_input.list_game_pad();
+        }
+        [[nodiscard]] const game_pad_state& get_game_pad_state(const size_t idx) const noexcept override {
+            return m_input.get_game_pad_state(idx);
+        }
+        [[nodiscard]] bool action_press() const noexcept override {
+            return m_input.action_press();
+        }
+        [[nodiscard]] vec2 action_direction_pulse_repeated(const bool navigation) const noexcept override {
+            return m_input.action_direction_pulse_repeated(navigation);
+        }
+        [[nodiscard]] uint64_t input_time() const noexcept override {
+            return m_input.input_time();
+        }
+        [[nodiscard]] uint64_t oldest_event_time() const noexcept override {
+            return m_input.oldest_event_time();
+        }
+    };
+
+    ANIMGUI_API std::shared_ptr<input_recorder> create_input_recorder(input_backend& input, std::ostream& stream) {
+        return std::make_shared<input_recorder_impl>(input, stream, false);
+    }
+    ANIMGUI_API std::shared_ptr<input_recorder> create_input_streamer(input_backend& input, std::ostream& stream) {
+        return std::make_shared<input_recorder_impl>(input, stream, true);
+    }
+
+    class input_player_impl final : public input_player {
+        std::istream& m_stream;
+        vec2 m_scroll_factor;
+        input_frame m_frame;
+        std::array<game_pad_state, max_game_pads> m_game_pad_state;
+        std::pmr::vector<size_t> m_available_game_pad;
+        size_t m_clipboard_pos;
+        std::pmr::string m_clipboard;
+        bool m_finished;
+
+        // the sections which are absent keep the state of the last frame, the per-frame ones are cleared
+        bool read_frame() {
+            if(m_stream.peek() == std::istream::traits_type::eof())
+                return false;
+            const auto flags = read_binary<uint8_t>(m_stream);
+            m_frame.delta_t = read_binary<float>(m_stream);
+            m_frame.mode = static_cast<input_mode>(read_binary<uint8_t>(m_stream));
+            const auto bits = read_binary<uint8_t>(m_stream);
+            m_frame.action_press = bits & 1;
+            m_frame.modifiers = static_cast<uint8_t>(bits >> 1);
+            m_frame.cursor_pos = read_binary<vec2>(m_stream);
+            m_frame.mouse_move = m_frame.scroll = m_frame.direction = m_frame.direction_navigation = { 0.0f, 0.0f };
+            if(flags & has_pointer_motion) {
+                m_frame.mouse_move = read_binary<vec2>(m_stream);
+                m_frame.scroll = read_binary<vec2>(m_stream);
+            }
+            if(flags & has_direction) {
+                m_frame.direction = read_binary<vec2>(m_stream);
+                m_frame.direction_navigation = read_binary<vec2>(m_stream);
+            }
+            if(flags & viewport_changed) {
+                m_frame.window_size = read_binary<uvec2>(m_stream);
+                m_frame.framebuffer_size = read_binary<uvec2>(m_stream);
+            }
+            if(flags & keys_changed)
+                m_frame.keys = read_binary<decltype(m_frame.keys)>(m_stream);
+            m_frame.characters.clear();
+            if(flags & has_characters) {
+                m_frame.characters.resize(read_binary<uint32_t>(m_stream));
+                read_binary(m_stream, m_frame.characters.data(), m_frame.characters.size() * sizeof(uint32_t));
+            }
+            if(flags & game_pads_changed) {
+                m_available_game_pad.clear();
+                const auto count = read_binary<uint8_t>(m_stream);
+                for(uint8_t i = 0; i < count; ++i) {
+                    const auto idx = read_binary<uint8_t>(m_stream);
+                    if(idx >= max_game_pads)
+                        throw std::runtime_error{ "corrupted input log" };
+                    m_game_pad_state[idx] = read_game_pad(m_stream);
+                    m_available_game_pad.push_back(idx);
+                }
+            }
+            m_frame.clipboard.clear();
+            m_clipboard_pos = 0;
+            if(flags & has_clipboard) {
+                m_frame.clipboard.resize(read_binary<uint32_t>(m_stream));
+                for(auto& str : m_frame.clipboard) {
+                    str.resize(read_binary<uint32_t>(m_stream));
+                    read_binary(m_stream, str.data(), str.size());
+                }
+            }
+            return true;
+        }
+
+    public:
+        explicit input_player_impl(std::istream& stream)
+            : m_stream{ stream }, m_scroll_factor{}, m_game_pad_state{}, m_clipboard_pos{ 0 }, m_finished{ false } {
+            char magic[sizeof(log_magic)];
+            read_binary(m_stream, magic, sizeof(magic));
+            if(std::memcmp(magic, log_magic, sizeof(magic)) != 0 || read_binary<uint32_t>(m_stream) != log_version)
+                throw std::runtime_error{ "unsupported input log" };
+            m_scroll_factor = read_binary<vec2>(m_stream);
+        }
+
+        void new_frame() override {
+            if(!m_finished && read_frame())
+                return;
+            // keep the held keys but drop the per-frame input
+            m_finished = true;
+            m_frame.delta_t = 0.0f;
+            m_frame.mouse_move = m_frame.scroll = m_frame.direction = m_frame.direction_navigation = { 0.0f, 0.0f };
+            std::fill(m_frame.keys.begin() + key_count / 8, m_frame.keys.end(), static_cast<uint8_t>(0));
+            m_frame.characters.clear();
+            m_frame.clipboard.clear();
+        }
+        [[nodiscard]] float delta_t() const noexcept override {
+            return m_frame.delta_t;
+        }
+        [[nodiscard]] bool finished() const noexcept override {
+            return m_finished;
+        }
+        [[nodiscard]] uvec2 window_size() const noexcept override {
+            return m_frame.window_size;
+        }
+        [[nodiscard]] uvec2 framebuffer_size() const noexcept override {
+            return m_frame.framebuffer_size;
+        }
+        [[nodiscard]] input_mode get_input_mode() const noexcept override {
+            return m_frame.mode;
+        }
+        void close_window() override {}
+        void minimize_window() override {}
+        void maximize_window() override {}
+        void move_window(int32_t, int32_t) override {}
+        void focus_window() override {}
+        void set_clipboard_text(const std::pmr::string& str) override {
+            m_clipboard = str;
+        }
+        // returns what the recorded frame read, in order
+        std::pmr::string get_clipboard_text() override {
+            if(m_clipboard_pos < m_frame.clipboard.size())
+                return m_frame.clipboard[m_clipboard_pos++];
+            return m_clipboard;
+        }
+        [[nodiscard]] span<const uint32_t> get_input_characters() const noexcept override {
+            return { m_frame.characters.data(), m_frame.characters.data() + m_frame.characters.size() };
+        }
+        void set_input_candidate_window(vec2) override {}
+        [[nodiscard]] vec2 get_cursor_pos() const override {
+            return m_frame.cursor_pos;
+        }
+        [[nodiscard]] vec2 mouse_move() const noexcept override {
+            return m_frame.mouse_move;
+        }
+        [[nodiscard]] vec2 scroll() const noexcept override {
+            return m_frame.scroll;
+        }
+        [[nodiscard]] vec2 scroll_factor() const noexcept override {
+            return m_scroll_factor;
+        }
+        void set_cursor(cursor) noexcept override {}
+        [[nodiscard]] bool get_key(const key_code code) const override {
+            return m_frame.test_key(0, code);
+        }
+        [[nodiscard]] bool get_key_pulse(const key_code code, const bool allow_repeated) const override {
+            return m_frame.test_key(allow_repeated ? 2 : 1, code);
+        }
+        [[nodiscard]] bool get_modifier_key(const modifier_key code) const override {
+            return m_frame.modifiers & (1 << static_cast<uint32_t>(code));
+        }
+        [[nodiscard]] std::pmr::string get_game_pad_name(size_t) const override {
+            return "replay";
+        }
+        [[nodiscard]] span<const size_t> list_game_pad() const noexcept override {
+            return { m_available_game_pad.data(), m_available_game_pad.data() + m_available_game_pad.size() };
+        }
+        [[nodiscard]] const game_pad_state& get_game_pad_state(const size_t idx) const noexcept override {
+            return m_game_pad_state[idx];
+        }
+        [[nodiscard]] bool action_press() const noexcept override {
+            return m_frame.action_press;
+        }
+        [[nodiscard]] vec2 action_direction_pulse_repeated(const bool navigation) const noexcept override {
+            return navigation ? m_frame.direction_navigation : m_frame.direction;
+        }
+        [[nodiscard]] uint64_t input_time() const noexcept override {
+            return 0;
+        }
+    };
+
+    ANIMGUI_API std::shared_ptr<input_player> create_input_player(std::istream& stream) {
+        return std::make_shared<input_player_impl>(stream);
+    }
+}  // namespace animgui
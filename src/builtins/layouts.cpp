@@ -1,11 +1,18 @@
 // SPDX-License-Identifier: MIT
 
 #include <animgui/builtins/layouts.hpp>
+#include <animgui/builtins/table_view.hpp>
 #include <animgui/builtins/widgets.hpp>
 #include <animgui/core/input_backend.hpp>
 #include <animgui/core/style.hpp>
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace animgui {
     std::pmr::memory_resource* layout_proxy::memory_resource() const noexcept {
@@ -55,9 +62,29 @@ namespace animgui {
     span<operation> layout_proxy::commands() noexcept {
         return m_parent.commands().subspan(m_offset);
     }
+    void layout_proxy::reorder(const span<const operation_segment> order) {
+        std::pmr::vector<operation_segment> segments{ memory_resource() };
+        segments.reserve(order.size());
+        for(auto&& [begin, end] : order)
+            segments.push_back({ begin + m_offset, end + m_offset });
+        m_parent.reorder({ segments.data(), segments.data() + segments.size() });
+    }
+    texture_region layout_proxy::render_offscreen(const vec2 size, std::shared_ptr<texture> target,
+                                                  const std::function<void(canvas&)>& render_function) {
+        return m_parent.render_offscreen(size, std::move(target), render_function);
+    }
     float layout_proxy::step(const identifier id, const float dest) {
         return m_parent.step(id, dest);
     }
+    vec2 layout_proxy::step(const identifier id, const vec2 dest) {
+        return m_parent.step(id, dest);
+    }
+    color_rgba layout_proxy::step(const identifier id, const color_rgba& dest) {
+        return m_parent.step(id, dest);
+    }
+    void layout_proxy::request_redraw(const float delay) {
+        m_parent.request_redraw(delay);
+    }
     identifier layout_proxy::region_sub_uid() {
         return m_parent.region_sub_uid();
     }
@@ -179,14 +206,16 @@ namespace animgui {
     }
 
     // TODO: force focus
-    ANIMGUI_API void panel(canvas& parent, const vec2 size, const scroll_attributes scroll,
-                           const std::function<vec2(canvas&)>& render_function) {
+    // The content is rendered with the current scroll offset (non-positive) and returns its size. A wheel step moves the
+    // content by a fraction of its size, or by a few lines if scroll_by_line is set, which suits long content better.
+    static void scroll_panel(canvas& parent, const vec2 size, const scroll_attributes scroll, const bool scroll_by_line,
+                             const std::function<vec2(canvas&, vec2)>& render_function) {
         const bounds_aabb bounds{ 0.0f, size.x, 0.0f, size.y };
         const auto uid = parent.push_region(parent.region_sub_uid(), bounds).second;
         auto& [offset_x, offset_y] = parent.storage<vec2>(uid);
 
         parent.push_region("panel_content"_id, bounds_aabb{ offset_x, size.x, offset_y, size.y });
-        const auto [w, h] = render_function(parent);
+        const auto [w, h] = render_function(parent, vec2{ offset_x, offset_y });
         parent.pop_region();
 
         /*
@@ -269,22 +298,572 @@ namespace animgui {
         if(parent.region_hovered()) {
             const auto [scroll_x, scroll_y] = input.scroll_factor();
 
+            constexpr auto lines_per_step = 3.0f;
+            const auto scale_x = scroll_by_line ? lines_per_step : w / size.x;
+            const auto scale_y = scroll_by_line ? lines_per_step : h / size.y;
+
             if(std::fabs(input.scroll().x) > 1e-3f) {
-                offset_x += input.scroll().x / size.x * w * scroll_x * style.default_font->standard_width();
+                offset_x += input.scroll().x * scale_x * scroll_x * style.default_font->standard_width();
                 scrolling_x = scrolling_delay;
             }
             if(std::fabs(input.scroll().y) > 1e-3f) {
-                offset_y += input.scroll().y / size.y * h * scroll_y * style.default_font->height();
+                offset_y += input.scroll().y * scale_y * scroll_y * style.default_font->height();
                 scrolling_y = scrolling_delay;
             }
         }
 
+        // keep the scroll bars fading out while idle
+        if(scrolling_x > 0.0f)
+            parent.request_redraw(scrolling_x);
+        if(scrolling_y > 0.0f)
+            parent.request_redraw(scrolling_y);
+
         offset_x = std::fmin(0.0f, std::fmax(size.x - w, offset_x));
         offset_y = std::fmin(0.0f, std::fmax(size.y - h, offset_y));
 
         parent.pop_region();
     }
 
+    ANIMGUI_API void panel(canvas& parent, const vec2 size, const scroll_attributes scroll,
+                           const std::function<vec2(canvas&)>& render_function) {
+        scroll_panel(parent, size, scroll, false, [&](canvas& content, vec2) { return render_function(content); });
+    }
+
+    // rows kept alive above and below the view, so that keyboard focus and animations survive small scrolls
+    constexpr size_t virtual_list_overscan = 2;
+
+    // Row positions are computed in double, a float product is off by whole pixels once the rows add up to a few million.
+    static float row_top(const size_t idx, const float row_height) noexcept {
+        return static_cast<float>(static_cast<double>(idx) * row_height);
+    }
+    // the rows of row_height in a view of view_height scrolled by offset, with the overscan rows around them
+    static std::pair<size_t, size_t> rows_in_view(const float offset, const float view_height, const float row_height,
+                                                  const size_t row_count) {
+        const auto first = static_cast<size_t>(std::fmax(0.0, -static_cast<double>(offset) / row_height));
+        const auto last =
+            static_cast<size_t>(std::fmax(0.0, std::ceil((static_cast<double>(view_height) - offset) / row_height)));
+        return { first > virtual_list_overscan ? first - virtual_list_overscan : 0,
+                 std::min(row_count, last + virtual_list_overscan) };
+    }
+
+    static float render_virtual_list_item(canvas& content, const size_t idx, const float width, const float top,
+                                          const float height, const std::function<float(canvas&, size_t)>& render_function) {
+        content.push_region(mix("virtual_list_item"_id, identifier{ idx }), bounds_aabb{ 0.0f, width, top, top + height });
+        const auto actual_height = render_function(content, idx);
+        content.pop_region(bounds_aabb{ 0.0f, width, top, top + actual_height });
+        return actual_height;
+    }
+
+    ANIMGUI_API void virtual_list(canvas& parent, const vec2 size, const size_t item_count, const float item_height,
+                                  const std::function<void(canvas&, size_t)>& render_function) {
+        const std::function<float(canvas&, size_t)> render_item = [&](canvas& content, const size_t idx) {
+            render_function(content, idx);
+            return item_height;
+        };
+        scroll_panel(parent, size, scroll_attributes::vertical_scroll, true, [&](canvas& content, const vec2 offset) {
+            if(item_height <= 0.0f)
+                return vec2{ size.x, 0.0f };
+            const auto [begin, end] = rows_in_view(offset.y, size.y, item_height, item_count);
+            for(auto idx = begin; idx < end; ++idx)
+                render_virtual_list_item(content, idx, size.x, row_top(idx, item_height), item_height, render_item);
+            return vec2{ size.x, row_top(item_count, item_height) };
+        });
+    }
+
+    // Fenwick tree over the row heights, so that both the offset of a row and the row at an offset cost O(log n).
+    struct virtual_list_state final {
+        std::pmr::vector<float> heights;
+        std::pmr::vector<double> tree;  // 1-based
+
+        static size_t lowest_bit(const size_t node) noexcept {
+            return node & (~node + 1);
+        }
+        // Rows are kept by index. Removed rows are dropped from the end and appended rows are estimated, so the measured
+        // heights of the other rows survive and a change costs O(log n) per added row.
+        void resize(const size_t count, const std::function<float(size_t)>& estimate_height) {
+            if(tree.empty())
+                tree.push_back(0.0);
+            // a node only covers the rows before it, so the remaining nodes stay valid
+            if(count < heights.size()) {
+                heights.resize(count);
+                tree.resize(count + 1);
+                return;
+            }
+            heights.reserve(count);
+            tree.reserve(count + 1);
+            while(heights.size() < count) {
+                const auto node = heights.size() + 1;
+                heights.push_back(estimate_height(node - 1));
+                // the node covers the rows (node - lowest_bit(node), node]
+                tree.push_back(heights.back() + offset_of(node - 1) - offset_of(node - lowest_bit(node)));
+            }
+        }
+        // the total height of the rows before idx
+        [[nodiscard]] double offset_of(size_t idx) const noexcept {
+            double sum = 0.0;
+            for(; idx > 0; idx -= lowest_bit(idx))
+                sum += tree[idx];
+            return sum;
+        }
+        // the row which covers offset, or the row count if offset is past the end
+        [[nodiscard]] size_t row_at(double offset) const noexcept {
+            size_t step = 1;
+            while(step * 2 < tree.size())
+                step *= 2;
+            size_t idx = 0;
+            for(; step > 0; step >>= 1) {
+                if(const auto next = idx + step; next < tree.size() && tree[next] <= offset) {
+                    idx = next;
+                    offset -= tree[next];
+                }
+            }
+            return idx;
+        }
+        void update(const size_t idx, const float height) noexcept {
+            const double delta = height - heights[idx];
+            heights[idx] = height;
+            for(auto node = idx + 1; node < tree.size(); node += lowest_bit(node))
+                tree[node] += delta;
+        }
+    };
+
+    ANIMGUI_API void virtual_list(canvas& parent, const vec2 size, const size_t item_count,
+                                  const std::function<float(size_t)>& estimate_height,
+                                  const std::function<float(canvas&, size_t)>& render_function) {
+        scroll_panel(parent, size, scroll_attributes::vertical_scroll, true, [&](canvas& content, const vec2 offset) {
+            auto& state = content.storage<virtual_list_state>(mix(content.region_sub_uid(), "virtual_list"_id));
+            if(state.heights.size() != item_count)
+                state.resize(item_count, estimate_height);
+
+            const auto first = state.row_at(-offset.y);
+            auto idx = first > virtual_list_overscan ? first - virtual_list_overscan : 0;
+            auto top = state.offset_of(idx);
+            size_t below = 0;
+            for(; idx < item_count && below < virtual_list_overscan; ++idx) {
+                if(top >= static_cast<double>(size.y) - offset.y)
+                    ++below;
+                const auto height = render_virtual_list_item(content, idx, size.x, static_cast<float>(top), state.heights[idx],
+                                                             render_function);
+                // the estimate is replaced by the measured height once the row has been rendered
+                if(std::fabs(height - state.heights[idx]) > 1e-3f)
+                    state.update(idx, height);
+                top += height;
+            }
+            return vec2{ size.x, static_cast<float>(state.offset_of(item_count)) };
+        });
+    }
+
+    // the offset of the first item and the spacing between the items when count items of width_sum are aligned in width
+    static std::pair<float, float> align_cell(row_alignment alignment, const float width, const float width_sum,
+                                              const size_t count, const float spacing) {
+        if(alignment == row_alignment::justify && (count == 1 || width < width_sum))
+            alignment = row_alignment::middle;
+        const auto total_width = width_sum + static_cast<float>(count - 1) * spacing;
+        switch(alignment) {
+            case row_alignment::left:
+                break;
+            case row_alignment::right:
+                return { width - total_width, spacing };
+            case row_alignment::middle:
+                return { (width - total_width) / 2.0f, spacing };
+            case row_alignment::justify:
+                return { 0.0f, (width - width_sum) / (static_cast<float>(count) - 1.0f) };
+        }
+        return { 0.0f, spacing };
+    }
+
+    // Cells are the top level regions between two next_item calls, placed side by side and vertically centered in the row.
+    // Like a line of row_layout_canvas_impl, the bounds are patched once all cells are known. Rows either follow each other
+    // or, with a row height, are regions opened by begin_row at a given offset.
+    class table_canvas_impl final : public table_canvas {
+        struct cell_item final {
+            size_t idx;
+            identifier id;
+            vec2 size;
+            size_t row;
+            size_t column;
+        };
+        struct row_info final {
+            std::optional<std::pair<size_t, identifier>> region;
+            float top;
+            float height;
+        };
+
+        const std::pmr::vector<row_alignment>& m_columns;
+        std::pmr::vector<float>& m_widths;
+        std::optional<float> m_row_height;
+        std::pmr::vector<cell_item> m_items;
+        std::pmr::vector<row_info> m_rows;
+        uint32_t m_current_depth = 0;
+        size_t m_row = 0;
+        size_t m_column = 0;
+
+        [[nodiscard]] float total_width() const noexcept {
+            auto width = 0.0f;
+            for(const auto column_width : m_widths)
+                width += column_width;
+            return width + std::fmax(0.0f, static_cast<float>(m_widths.size()) - 1.0f) * global_style().spacing.x;
+        }
+        // calls func(begin, end, width_sum) for the items of each cell, which are adjacent
+        template <typename Func>
+        void for_each_cell(Func&& func) const {
+            for(size_t begin = 0; begin < m_items.size();) {
+                auto end = begin + 1;
+                auto width_sum = m_items[begin].size.x;
+                for(; end < m_items.size() && m_items[end].row == m_items[begin].row &&
+                    m_items[end].column == m_items[begin].column;
+                    ++end)
+                    width_sum += m_items[end].size.x;
+                func(begin, end, width_sum);
+                begin = end;
+            }
+        }
+
+    public:
+        // widths holds the width of each column, which grows to fit the cells
+        table_canvas_impl(canvas& parent, const std::pmr::vector<row_alignment>& columns, std::pmr::vector<float>& widths,
+                          const std::optional<float> row_height)
+            : table_canvas{ parent }, m_columns{ columns }, m_widths{ widths }, m_row_height{ row_height },
+              m_items{ parent.memory_resource() }, m_rows{ parent.memory_resource() } {
+            if(columns.empty())
+                throw std::logic_error("table without columns");
+        }
+        std::pair<size_t, identifier> push_region(const identifier uid,
+                                                  const std::optional<bounds_aabb>& reserved_bounds) override {
+            const auto [idx, id] = layout_proxy::push_region(uid, reserved_bounds);
+            if(++m_current_depth == 1) {
+                while(m_rows.size() <= m_row)
+                    m_rows.push_back({ std::nullopt, 0.0f, 0.0f });
+                m_items.push_back({ idx, id, vec2{}, m_row, m_column });
+            }
+            return { idx, id };
+        }
+        void pop_region(const std::optional<bounds_aabb>& new_bounds) override {
+            m_parent.pop_region(new_bounds);
+            if(--m_current_depth == 0) {
+                auto& item = m_items.back();
+                if(new_bounds.value_or(std::get<op_push_region>(commands()[item.idx]).bounds).is_escaped())
+                    m_items.pop_back();
+                else {
+                    const auto [x1, x2, y1, y2] = storage<bounds_aabb>(mix(item.id, "last_bounds"_id));
+                    item.size = { x2 - x1, y2 - y1 };
+                }
+            }
+        }
+        void next_item() override {
+            if(m_current_depth != 0)
+                throw std::logic_error("mismatched region");
+            if(++m_column < m_columns.size())
+                return;
+            // the extra cells of a fixed row share its last column
+            if(m_row_height.has_value())
+                m_column = m_columns.size() - 1;
+            else {
+                m_column = 0;
+                ++m_row;
+            }
+        }
+        void begin_row(const identifier uid, const float top) {
+            if(m_current_depth != 0)
+                throw std::logic_error("mismatched region");
+            const auto height = m_row_height.value();
+            const auto region = layout_proxy::push_region(uid, bounds_aabb{ 0.0f, total_width(), top, top + height });
+            m_row = m_rows.size();
+            m_column = 0;
+            m_rows.push_back({ region, top, height });
+        }
+        void end_row() {
+            if(m_current_depth != 0)
+                throw std::logic_error("mismatched region");
+            layout_proxy::pop_region(std::nullopt);
+        }
+        vec2 finish() {
+            if(m_current_depth != 0)
+                throw std::logic_error("mismatched region");
+            auto&& style = global_style();
+
+            for_each_cell([&](const size_t begin, const size_t end, const float width_sum) {
+                auto& width = m_widths[m_items[begin].column];
+                width = std::fmax(width, width_sum + static_cast<float>(end - begin - 1) * style.spacing.x);
+            });
+            if(!m_row_height.has_value()) {
+                for(auto&& item : m_items)
+                    m_rows[item.row].height = std::fmax(m_rows[item.row].height, item.size.y);
+                auto top = 0.0f;
+                for(auto&& row : m_rows) {
+                    row.top = top;
+                    top += row.height + style.spacing.y;
+                }
+            }
+
+            std::pmr::vector<float> offsets(m_columns.size(), 0.0f, memory_resource());
+            for(size_t column = 1; column < m_columns.size(); ++column)
+                offsets[column] = offsets[column - 1] + m_widths[column - 1] + style.spacing.x;
+
+            const auto span = commands();
+            for_each_cell([&](const size_t begin, const size_t end, const float width_sum) {
+                const auto column = m_items[begin].column;
+                auto [offset, spacing] = align_cell(m_columns[column], m_widths[column], width_sum, end - begin, style.spacing.x);
+                offset += offsets[column];
+                const auto& row = m_rows[m_items[begin].row];
+                // the cells of a fixed row are relative to its region
+                const auto top = row.region.has_value() ? 0.0f : row.top;
+                for(auto idx = begin; idx < end; ++idx) {
+                    const auto& item = m_items[idx];
+                    const auto item_top = top + (row.height - item.size.y) / 2.0f;
+                    const bounds_aabb new_bounds{ offset, offset + item.size.x, item_top, item_top + item.size.y };
+                    std::get<op_push_region>(span[item.idx]).bounds = new_bounds;
+                    storage<bounds_aabb>(mix(item.id, "last_bounds"_id)) = new_bounds;
+                    offset += item.size.x + spacing;
+                }
+            });
+
+            const auto width = total_width();
+            for(auto&& [region, top, height] : m_rows) {
+                if(!region.has_value())
+                    continue;
+                const bounds_aabb new_bounds{ 0.0f, width, top, top + height };
+                std::get<op_push_region>(span[region->first]).bounds = new_bounds;
+                storage<bounds_aabb>(mix(region->second, "last_bounds"_id)) = new_bounds;
+            }
+            return { width, m_rows.empty() ? 0.0f : m_rows.back().top + m_rows.back().height };
+        }
+    };
+
+    ANIMGUI_API vec2 table(canvas& parent, const std::pmr::vector<row_alignment>& columns,
+                           const std::function<void(table_canvas&)>& render_function) {
+        std::pmr::vector<float> widths(columns.size(), 0.0f, parent.memory_resource());
+        table_canvas_impl canvas_node{ parent, columns, widths, std::nullopt };
+        render_function(canvas_node);
+        return canvas_node.finish();
+    }
+
+    struct table_state final {
+        std::pmr::vector<float> widths;
+    };
+
+    // rows maps a table row to its data row, whose identifier keys the region of the row
+    static void virtual_table(canvas& parent, const vec2 size, const std::pmr::vector<row_alignment>& columns,
+                              const size_t row_count, const size_t* rows, const float row_height,
+                              const std::function<void(table_canvas&, size_t)>& render_function) {
+        scroll_panel(parent, size, scroll_attributes::both, true, [&](canvas& content, const vec2 offset) {
+            // only the rendered rows are measured, so the widths are updated incrementally and never shrink while scrolling
+            auto& widths = content.storage<table_state>(mix(content.region_sub_uid(), "table"_id)).widths;
+            if(widths.size() != columns.size())
+                widths.assign(columns.size(), 0.0f);
+            if(row_height <= 0.0f)
+                return vec2{ 0.0f, 0.0f };
+
+            const auto [begin, end] = rows_in_view(offset.y, size.y, row_height, row_count);
+            table_canvas_impl canvas_node{ content, columns, widths, row_height };
+            for(auto idx = begin; idx < end; ++idx) {
+                const auto row = rows ? rows[idx] : idx;
+                canvas_node.begin_row(mix("table_row"_id, identifier{ row }), row_top(idx, row_height));
+                render_function(canvas_node, row);
+                canvas_node.end_row();
+            }
+            return vec2{ canvas_node.finish().x, row_top(row_count, row_height) };
+        });
+    }
+
+    ANIMGUI_API void table(canvas& parent, const vec2 size, const std::pmr::vector<row_alignment>& columns,
+                           const size_t row_count, const float row_height,
+                           const std::function<void(table_canvas&, size_t)>& render_function) {
+        virtual_table(parent, size, columns, row_count, nullptr, row_height, render_function);
+    }
+
+    ANIMGUI_API void table(canvas& parent, const vec2 size, const std::pmr::vector<row_alignment>& columns, table_view& view,
+                           const float row_height, const std::function<void(table_canvas&, size_t)>& render_function) {
+        // a finished job only shows up at a frame boundary, so keep polling while one is running
+        constexpr auto poll_interval = 1.0f / 30.0f;
+        view.poll();
+        if(view.busy())
+            parent.request_redraw(poll_interval);
+        const auto rows = view.rows();
+        virtual_table(parent, size, columns, rows.size(), rows.begin(), row_height, render_function);
+    }
+
+    // An expanded node of a tree. Collapsed nodes are not stored, so the state only grows with the expanded part of the tree.
+    struct tree_node final {
+        uint64_t key = 0;
+        tree_node* parent = nullptr;
+        size_t index = 0;  // in the parent
+        size_t child_count = 0;
+        // the rows below the node: its children and the visible rows of its expanded children
+        size_t visible = 0;
+        std::vector<std::pair<size_t, std::unique_ptr<tree_node>>> expanded;  // sorted by the index of the child
+    };
+
+    // The flattened rows are never materialized. The row counts of the expanded nodes locate a row in O(depth * expanded
+    // siblings), and expanding or collapsing a node only updates its ancestors, whatever the number of its children.
+    struct tree_state final {
+        // on the heap, as the canvas storage may move its objects
+        std::unique_ptr<tree_node> root;
+
+        static void add_visible(tree_node* node, const ptrdiff_t delta) noexcept {
+            for(; node; node = node->parent)
+                node->visible = static_cast<size_t>(static_cast<ptrdiff_t>(node->visible) + delta);
+        }
+        static auto find_expanded(tree_node& node, const size_t idx) {
+            return std::lower_bound(node.expanded.begin(), node.expanded.end(), idx,
+                                    [](const auto& child, const size_t rhs) { return child.first < rhs; });
+        }
+        static tree_node* expanded_child(tree_node& node, const size_t idx) {
+            const auto iter = find_expanded(node, idx);
+            return iter != node.expanded.end() && iter->first == idx ? iter->second.get() : nullptr;
+        }
+        static void expand(tree_node& node, const size_t idx, const uint64_t key, const size_t child_count) {
+            auto child = std::make_unique<tree_node>();
+            child->key = key;
+            child->parent = &node;
+            child->index = idx;
+            child->child_count = child->visible = child_count;
+            node.expanded.emplace(find_expanded(node, idx), idx, std::move(child));
+            add_visible(&node, static_cast<ptrdiff_t>(child_count));
+        }
+        static void collapse(tree_node& node, const size_t idx) {
+            const auto iter = find_expanded(node, idx);
+            const auto visible = iter->second->visible;
+            node.expanded.erase(iter);
+            add_visible(&node, -static_cast<ptrdiff_t>(visible));
+        }
+        static void set_child_count(tree_node& node, const size_t child_count) {
+            while(!node.expanded.empty() && node.expanded.back().first >= child_count)
+                collapse(node, node.expanded.back().first);
+            add_visible(&node, static_cast<ptrdiff_t>(child_count) - static_cast<ptrdiff_t>(node.child_count));
+            node.child_count = child_count;
+        }
+
+        // a row is the child idx of node, at the given depth
+        struct cursor final {
+            tree_node* node;
+            size_t idx;
+            size_t depth;
+        };
+        [[nodiscard]] cursor locate(size_t row) const noexcept {
+            cursor pos{ root.get(), 0, 0 };
+            while(true) {
+                // the rows of the children before the current expanded child
+                size_t skipped = 0;
+                tree_node* next = nullptr;
+                for(auto&& [idx, child] : pos.node->expanded) {
+                    const auto child_row = idx + skipped;
+                    if(row <= child_row)
+                        break;
+                    if(row <= child_row + child->visible) {
+                        next = child.get();
+                        row -= child_row + 1;
+                        break;
+                    }
+                    skipped += child->visible;
+                }
+                if(!next) {
+                    pos.idx = row - skipped;
+                    return pos;
+                }
+                pos = { next, 0, pos.depth + 1 };
+            }
+        }
+        // moves to the next row in preorder, returns false after the last row
+        static bool advance(cursor& pos) {
+            if(const auto child = expanded_child(*pos.node, pos.idx); child && child->child_count) {
+                pos = { child, 0, pos.depth + 1 };
+                return true;
+            }
+            ++pos.idx;
+            while(pos.idx >= pos.node->child_count) {
+                if(!pos.node->parent)
+                    return false;
+                pos = { pos.node->parent, pos.node->index + 1, pos.depth - 1 };
+            }
+            return true;
+        }
+    };
+
+    static bool render_tree_toggle(canvas& parent, const float indent, const float size, const bool expanded) {
+        auto&& style = parent.global_style();
+        parent.push_region("tree_toggle"_id, bounds_aabb{ indent, indent + size, 0.0f, size });
+        const auto focused = parent.region_hovered();
+        const auto pressed = focused && parent.input().action_press();
+        const auto base_color = focused ? style.action.hover : color_rgba{};
+        const auto uid =
+            parent.add_primitive("toggle_base"_id, canvas_fill_rect{ bounds_aabb{ 0.0f, size, 0.0f, size }, base_color }).second;
+        const auto res = clicked(parent, uid, pressed, focused);
+
+        // a chevron pointing right when collapsed and down when expanded
+        const auto center = size / 2.0f;
+        const auto extent = size / 6.0f;
+        const auto color = style.text.primary;
+        const auto width = style.bounds_edge_width;
+        if(expanded) {
+            parent.add_primitive("toggle_left"_id, canvas_line{ vec2{ center - 2.0f * extent, center - extent },
+                                                                vec2{ center, center + extent }, color, width });
+            parent.add_primitive("toggle_right"_id, canvas_line{ vec2{ center, center + extent },
+                                                                 vec2{ center + 2.0f * extent, center - extent }, color, width });
+        } else {
+            parent.add_primitive("toggle_left"_id, canvas_line{ vec2{ center - extent, center - 2.0f * extent },
+                                                                vec2{ center + extent, center }, color, width });
+            parent.add_primitive("toggle_right"_id, canvas_line{ vec2{ center + extent, center },
+                                                                 vec2{ center - extent, center + 2.0f * extent }, color, width });
+        }
+        parent.pop_region();
+        return res;
+    }
+
+    ANIMGUI_API void tree(canvas& parent, const vec2 size, tree_source& source, const uint64_t root, const float row_height,
+                          const std::function<void(canvas&, uint64_t, size_t)>& render_function) {
+        scroll_panel(parent, size, scroll_attributes::vertical_scroll, true, [&](canvas& content, const vec2 offset) {
+            auto& state = content.storage<tree_state>(mix(content.region_sub_uid(), "tree"_id));
+            if(!state.root || state.root->key != root) {
+                state.root = std::make_unique<tree_node>();
+                state.root->key = root;
+            }
+            if(const auto child_count = source.child_count(root); child_count != state.root->child_count)
+                tree_state::set_child_count(*state.root, child_count);
+            if(row_height <= 0.0f || state.root->visible == 0)
+                return vec2{ size.x, 0.0f };
+
+            auto [row, end] = rows_in_view(offset.y, size.y, row_height, state.root->visible);
+            if(row >= end)
+                return vec2{ size.x, row_top(state.root->visible, row_height) };
+
+            // the rows are visited in preorder from the first one in view, the structure may change on the way
+            for(auto pos = state.locate(row); row < end; ++row) {
+                auto& node = *pos.node;
+                const auto key = source.child(node.key, pos.idx);
+                auto child = tree_state::expanded_child(node, pos.idx);
+                // the children have changed under an expanded node, so the state belongs to another node
+                if(child && child->key != key) {
+                    tree_state::collapse(node, pos.idx);
+                    child = nullptr;
+                }
+                if(child) {
+                    if(const auto child_count = source.child_count(key); child_count != child->child_count)
+                        tree_state::set_child_count(*child, child_count);
+                }
+
+                const auto top = row_top(row, row_height);
+                const auto indent = static_cast<float>(pos.depth) * row_height;
+                content.push_region(mix("tree_row"_id, identifier{ key }), bounds_aabb{ 0.0f, size.x, top, top + row_height });
+                if(const auto child_count = child ? child->child_count : source.child_count(key);
+                   child_count && render_tree_toggle(content, indent, row_height, child != nullptr)) {
+                    if(child)
+                        tree_state::collapse(node, pos.idx);
+                    else
+                        tree_state::expand(node, pos.idx, key, child_count);
+                }
+                content.push_region("tree_content"_id, bounds_aabb{ indent + row_height, size.x, 0.0f, row_height });
+                render_function(content, key, pos.depth);
+                content.pop_region();
+                content.pop_region();
+
+                if(!tree_state::advance(pos))
+                    break;
+            }
+            return vec2{ size.x, row_top(state.root->visible, row_height) };
+        });
+    }
+
     class window_operator {
     public:
         window_operator() = default;
@@ -438,6 +1017,55 @@ namespace animgui {
         windows_info() = delete;
     };
 
+    static void clamp_window_bounds(bounds_aabb& bounds, const vec2 size) noexcept {
+        if(bounds.left < 0.0f) {
+            bounds.right -= bounds.left;
+            bounds.left = 0.0f;
+        } else if(bounds.right > size.x) {
+            bounds.left -= bounds.right - size.x;
+            bounds.right = size.x;
+        }
+
+        bounds.left = std::fmax(bounds.left, 0.0f);
+        bounds.right = std::fmin(bounds.right, size.x);
+
+        if(bounds.top < 0.0f) {
+            bounds.bottom -= bounds.top;
+            bounds.top = 0.0f;
+        } else if(bounds.bottom > size.y) {
+            bounds.top -= bounds.bottom - size.y;
+            bounds.bottom = size.y;
+        }
+
+        bounds.top = std::fmax(bounds.top, 0.0f);
+        bounds.bottom = std::fmin(bounds.bottom, size.y);
+    }
+
+    // Draws the windows above the other operations, in the given order. They are drawn through a list of segments, so the cost
+    // depends on the number of windows rather than on the number of operations.
+    static void raise_windows(canvas& parent, const std::pmr::vector<operation_segment>& windows) {
+        std::pmr::vector<operation_segment> sorted{ windows, parent.memory_resource() };
+        std::sort(sorted.begin(), sorted.end(),
+                  [](const operation_segment& lhs, const operation_segment& rhs) { return lhs.begin < rhs.begin; });
+
+        std::pmr::vector<operation_segment> order{ parent.memory_resource() };
+        order.reserve(windows.size() * 2 + 1);
+        size_t last = 0;
+        for(auto&& [begin, end] : sorted) {
+            if(last < begin)
+                order.push_back({ last, begin });
+            last = end;
+        }
+        if(const auto size = parent.commands().size(); last < size)
+            order.push_back({ last, size });
+        order.insert(order.end(), windows.cbegin(), windows.cend());
+
+        if(!std::is_sorted(order.cbegin(), order.cend(), [](const operation_segment& lhs, const operation_segment& rhs) {
+               return lhs.begin < rhs.begin;
+           }))
+            parent.reorder({ order.data(), order.data() + order.size() });
+    }
+
     class multiple_window_canvas_impl final : public multiple_window_canvas {
         std::pmr::unordered_map<identifier, std::pair<size_t, size_t>, identifier_hasher> m_ranges;
         std::pmr::vector<identifier> m_focus_requests;
@@ -446,6 +1074,11 @@ namespace animgui {
         std::pmr::vector<std::pair<identifier, vec2>> m_move_requests;
         std::pmr::vector<windows_info>& m_info;
         identifier m_current;
+        // indices in m_info, which is sorted by z-order
+        std::optional<size_t> m_current_rank;
+        // The topmost open window under the cursor, found once per frame with the bounds of the last frame. As the cursor is
+        // a single point, it answers every hover test in O(1) instead of walking the windows above the current one.
+        std::optional<size_t> m_hovered_rank;
 
         [[nodiscard]] bounds_aabb default_bounds() const {
             const auto size = reserved_size();
@@ -461,46 +1094,31 @@ namespace animgui {
             return m_info.back();
         }
 
-        static void clamp_bounds(bounds_aabb& bounds, const vec2 size) noexcept {
-            if(bounds.left < 0.0f) {
-                bounds.right -= bounds.left;
-                bounds.left = 0.0f;
-            } else if(bounds.right > size.x) {
-                bounds.left -= bounds.right - size.x;
-                bounds.right = size.x;
-            }
-
-            bounds.left = std::fmax(bounds.left, 0.0f);
-            bounds.right = std::fmin(bounds.right, size.x);
-
-            if(bounds.top < 0.0f) {
-                bounds.bottom -= bounds.top;
-                bounds.top = 0.0f;
-            } else if(bounds.bottom > size.y) {
-                bounds.top -= bounds.bottom - size.y;
-                bounds.bottom = size.y;
-            }
-
-            bounds.top = std::fmax(bounds.top, 0.0f);
-            bounds.bottom = std::fmin(bounds.bottom, size.y);
-        }
-
     public:
         explicit multiple_window_canvas_impl(canvas& parent)
             : multiple_window_canvas{ parent }, m_ranges{ parent.memory_resource() },
               m_focus_requests{ parent.memory_resource() }, m_open_requests{ parent.memory_resource() },
               m_close_requests{ parent.memory_resource() }, m_move_requests{ parent.memory_resource() },
-              m_info{ parent.storage<std::decay_t<decltype(m_info)>>(parent.region_sub_uid()) }, m_current{ 0 } {}
+              m_info{ parent.storage<std::decay_t<decltype(m_info)>>(parent.region_sub_uid()) }, m_current{ 0 } {
+            for(auto idx = m_info.size(); idx > 0; --idx) {
+                if(const auto& win = m_info[idx - 1]; win.is_open && hovered(win.absolute_bounds)) {
+                    m_hovered_rank = idx - 1;
+                    break;
+                }
+            }
+        }
         void new_window(const identifier id, std::optional<std::pmr::string> title, const window_attributes attributes,
                         const std::function<void(window_canvas&)>& render_function) override {
-            if(auto& [_, bounds, absolute_bounds, is_open, auto_adjust] = locate_window(id); is_open) {
+            auto& info = locate_window(id);
+            if(auto& [_, bounds, absolute_bounds, is_open, auto_adjust] = info; is_open) {
                 multiple_window_operator operator_{ *this, id };
                 const auto beg = commands().size();
 
                 const auto size = reserved_size();
                 m_current = id;
+                m_current_rank = static_cast<size_t>(&info - m_info.data());
                 push_region(id, bounds_aabb{ 0.0f, size.x, 0.0f, size.y });
-                clamp_bounds(bounds, size);
+                clamp_window_bounds(bounds, size);
                 window_canvas_impl canvas_node{ *this, bounds, std::move(title), attributes, operator_, &absolute_bounds };
                 render_function(canvas_node);
                 canvas_node.finish();
@@ -571,14 +1189,8 @@ namespace animgui {
         [[nodiscard]] bool region_hovered() const override {
             if(const auto current_bound = region_bounds(); !hovered(current_bound))
                 return false;
-            for(auto iter = m_info.rbegin(); iter != m_info.rend(); ++iter) {
-                if(iter->id == m_current) {
-                    break;
-                }
-                if(iter->is_open && hovered(iter->absolute_bounds))
-                    return false;
-            }
-            return true;
+            // covered by a window above the current one
+            return !m_hovered_rank.has_value() || (m_current_rank.has_value() && *m_hovered_rank <= *m_current_rank);
         }
         bool region_request_focus(const bool force) override {
             if(force) {
@@ -587,13 +1199,9 @@ namespace animgui {
             }
             const auto bounds = region_bounds();
 
-            for(auto iter = m_info.rbegin(); iter != m_info.rend(); ++iter) {
-                if(iter->id == m_current) {
-                    break;
-                }
-
-                if(const auto [l, r, t, b] = iter->absolute_bounds;
-                   iter->is_open && l <= bounds.left && bounds.right <= r && t <= bounds.top && bounds.bottom <= b) {
+            for(auto idx = m_current_rank.has_value() ? *m_current_rank + 1 : 0; idx < m_info.size(); ++idx) {
+                if(const auto [l, r, t, b] = m_info[idx].absolute_bounds;
+                   m_info[idx].is_open && l <= bounds.left && bounds.right <= r && t <= bounds.top && bounds.bottom <= b) {
                     return false;
                 }
             }
@@ -654,16 +1262,13 @@ namespace animgui {
                     }
             }
 
-            const auto commands_range = commands();
-            std::pmr::vector<operation> new_commands;
-            new_commands.reserve(commands_range.size());
-            for(auto [id, bounds, absolute_bounds, is_open, auto_adjust] : m_info) {
-                if(const auto iter = m_ranges.find(id); iter != m_ranges.cend()) {
-                    const auto [beg, end] = iter->second;
-                    new_commands.insert(new_commands.cend(), commands_range.begin() + beg, commands_range.begin() + end);
-                }
-            }
-            std::move(new_commands.begin(), new_commands.end(), commands_range.begin());
+            // operations outside of the windows stay below them
+            std::pmr::vector<operation_segment> windows{ memory_resource() };
+            windows.reserve(m_ranges.size());
+            for(auto&& info : m_info)
+                if(const auto iter = m_ranges.find(info.id); iter != m_ranges.cend())
+                    windows.push_back({ iter->second.first, iter->second.second });
+            raise_windows(*this, windows);
         }
     };
 
@@ -684,4 +1289,627 @@ namespace animgui {
         render_function(canvas_node);
         canvas_node.finish();
     }
+
+    enum class dock_zone { left, right, top, bottom, center };
+
+    // A node of the split tree of docking. A split divides its bounds between two children, a leaf shows its windows as tabs.
+    struct dock_node final {
+        static constexpr auto npos = std::numeric_limits<size_t>::max();
+
+        size_t parent = npos;
+        // the children of a split, npos for a leaf
+        size_t first = npos;
+        size_t second = npos;
+        // whether first is above second instead of on the left
+        bool vertical = false;
+        float ratio = 0.5f;
+        std::pmr::vector<identifier> windows;
+        size_t active = 0;
+        // relative to the docking area, only laid out again when the tree changes or a splitter moves
+        bounds_aabb bounds{ 0.0f, 0.0f, 0.0f, 0.0f };
+
+        [[nodiscard]] bool is_leaf() const noexcept {
+            return first == npos;
+        }
+    };
+
+    struct dock_window final {
+        identifier id;
+        // npos while floating or closed
+        size_t leaf;
+        // whether the window floats, or is docked again when it is opened
+        bool floating;
+        bool is_open;
+        bounds_aabb bounds;
+        bounds_aabb absolute_bounds;
+    };
+
+    // Nodes refer to each other by index, as the canvas storage may move its objects.
+    struct docking_state final {
+        std::pmr::vector<dock_node> nodes;
+        std::pmr::vector<size_t> free_nodes;
+        size_t root = dock_node::npos;
+        // the floating windows are above the docked ones, sorted by z-order
+        std::pmr::vector<dock_window> windows;
+        vec2 size{ 0.0f, 0.0f };
+        std::optional<identifier> dragging;
+        // the cursor position relative to the dragged window
+        vec2 grab{ 0.0f, 0.0f };
+
+        size_t allocate() {
+            if(free_nodes.empty()) {
+                nodes.emplace_back();
+                return nodes.size() - 1;
+            }
+            const auto idx = free_nodes.back();
+            free_nodes.pop_back();
+            return idx;
+        }
+        void release(const size_t idx) {
+            nodes[idx] = dock_node{};
+            free_nodes.push_back(idx);
+        }
+        [[nodiscard]] dock_window* locate(const identifier id) noexcept {
+            for(auto&& win : windows)
+                if(win.id == id)
+                    return &win;
+            return nullptr;
+        }
+        [[nodiscard]] size_t first_leaf() const noexcept {
+            auto idx = root;
+            while(idx != dock_node::npos && !nodes[idx].is_leaf())
+                idx = nodes[idx].first;
+            return idx;
+        }
+        // the leaf under pos, which is relative to the docking area
+        [[nodiscard]] size_t leaf_at(const vec2 pos) const noexcept {
+            auto idx = root;
+            while(idx != dock_node::npos) {
+                const auto& [left, right, top, bottom] = nodes[idx].bounds;
+                if(pos.x < left || pos.x >= right || pos.y < top || pos.y >= bottom)
+                    return dock_node::npos;
+                if(nodes[idx].is_leaf())
+                    return idx;
+                const auto& first = nodes[nodes[idx].first].bounds;
+                idx = (nodes[idx].vertical ? pos.y < first.bottom : pos.x < first.right) ? nodes[idx].first :
+                                                                                           nodes[idx].second;
+            }
+            return idx;
+        }
+
+        // lays out the subtree of idx in bounds, the cost only depends on the size of the subtree
+        void layout(const size_t idx, const bounds_aabb& bounds, const float splitter) {
+            nodes[idx].bounds = bounds;
+            if(nodes[idx].is_leaf())
+                return;
+            const auto& node = nodes[idx];
+            auto first_bounds = bounds, second_bounds = bounds;
+            if(node.vertical) {
+                first_bounds.bottom = bounds.top + std::fmax(0.0f, bounds.bottom - bounds.top - splitter) * node.ratio;
+                second_bounds.top = first_bounds.bottom + splitter;
+            } else {
+                first_bounds.right = bounds.left + std::fmax(0.0f, bounds.right - bounds.left - splitter) * node.ratio;
+                second_bounds.left = first_bounds.right + splitter;
+            }
+            layout(node.first, first_bounds, splitter);
+            layout(node.second, second_bounds, splitter);
+        }
+
+        void dock(const identifier id, size_t leaf, dock_zone zone, const float splitter) {
+            if(root == dock_node::npos) {
+                root = leaf = allocate();
+                nodes[root].bounds = { 0.0f, size.x, 0.0f, size.y };
+                zone = dock_zone::center;
+            }
+            if(zone == dock_zone::center) {
+                auto& node = nodes[leaf];
+                node.windows.push_back(id);
+                node.active = node.windows.size() - 1;
+                locate(id)->leaf = leaf;
+                return;
+            }
+
+            // the leaf becomes a split of its previous windows and the docked one
+            const auto moved = allocate();
+            const auto added = allocate();
+            nodes[moved].windows.swap(nodes[leaf].windows);
+            nodes[moved].active = nodes[leaf].active;
+            nodes[moved].parent = nodes[added].parent = leaf;
+            for(auto&& moved_id : nodes[moved].windows)
+                locate(moved_id)->leaf = moved;
+            nodes[added].windows.push_back(id);
+            locate(id)->leaf = added;
+
+            auto& node = nodes[leaf];
+            node.vertical = zone == dock_zone::top || zone == dock_zone::bottom;
+            node.ratio = 0.5f;
+            const auto added_first = zone == dock_zone::left || zone == dock_zone::top;
+            node.first = added_first ? added : moved;
+            node.second = added_first ? moved : added;
+            layout(leaf, node.bounds, splitter);
+        }
+        void undock(dock_window& win, const float splitter) {
+            const auto leaf = std::exchange(win.leaf, dock_node::npos);
+            auto& windows_of_leaf = nodes[leaf].windows;
+            windows_of_leaf.erase(std::find(windows_of_leaf.begin(), windows_of_leaf.end(), win.id));
+            if(!windows_of_leaf.empty()) {
+                nodes[leaf].active = std::min(nodes[leaf].active, windows_of_leaf.size() - 1);
+                return;
+            }
+
+            // an empty leaf is removed, and its sibling takes the place of their parent
+            const auto parent = nodes[leaf].parent;
+            release(leaf);
+            if(parent == dock_node::npos) {
+                root = dock_node::npos;
+                return;
+            }
+            const auto sibling = nodes[parent].first == leaf ? nodes[parent].second : nodes[parent].first;
+            const auto bounds = nodes[parent].bounds;
+            const auto grandparent = nodes[parent].parent;
+            nodes[parent] = std::move(nodes[sibling]);
+            nodes[parent].parent = grandparent;
+            if(nodes[parent].is_leaf()) {
+                for(auto&& id : nodes[parent].windows)
+                    locate(id)->leaf = parent;
+            } else {
+                nodes[nodes[parent].first].parent = nodes[nodes[parent].second].parent = parent;
+            }
+            release(sibling);
+            layout(parent, bounds, splitter);
+        }
+    };
+
+    class docking_canvas_impl;
+
+    class docking_window_operator final : public window_operator {
+        docking_canvas_impl& m_canvas;
+        identifier m_id;
+
+    public:
+        explicit docking_window_operator(docking_canvas_impl& parent, const identifier id) : m_canvas{ parent }, m_id{ id } {}
+        void close() override;
+        void minimize() override {}
+        void maximize() override {}
+        void move(vec2 delta) override;
+        void focus() override;
+    };
+
+    // Docked windows are laid out by the split tree, which only changes when a splitter moves or a window docks or undocks,
+    // so a frame renders the splitters, the tabs and the active window of each pane. Floating windows behave like those of
+    // multiple_window above the docked ones.
+    class docking_canvas_impl final : public multiple_window_canvas {
+        docking_state& m_state;
+        // the offset of the docking area
+        vec2 m_origin;
+        float m_splitter;
+        float m_tab_height;
+        std::pmr::unordered_map<identifier, std::pair<size_t, size_t>, identifier_hasher> m_ranges;
+        std::pmr::vector<identifier> m_focus_requests;
+        std::pmr::vector<identifier> m_open_requests;
+        std::pmr::vector<identifier> m_close_requests;
+        // indices in m_state.windows, empty while rendering the docked area
+        std::optional<size_t> m_current_rank;
+        // the topmost floating window under the cursor, see multiple_window_canvas_impl
+        std::optional<size_t> m_hovered_rank;
+
+        [[nodiscard]] vec2 cursor() const {
+            const auto [x, y] = input().get_cursor_pos();
+            return { x - m_origin.x, y - m_origin.y };
+        }
+
+        void render_splitters(const size_t idx) {
+            auto& node = m_state.nodes[idx];
+            if(node.is_leaf())
+                return;
+
+            const auto& first = m_state.nodes[node.first].bounds;
+            const auto splitter_bounds = node.vertical ?
+                bounds_aabb{ node.bounds.left, node.bounds.right, first.bottom, first.bottom + m_splitter } :
+                bounds_aabb{ first.right, first.right + m_splitter, node.bounds.top, node.bounds.bottom };
+            const auto uid = push_region(mix("splitter"_id, identifier{ idx }), splitter_bounds).second;
+            const auto focused = region_hovered();
+            const auto dragged = selected(*this, uid);
+            if(focused || dragged)
+                input().set_cursor(node.vertical ? cursor::vertical : cursor::horizontal);
+            if(dragged) {
+                const auto [dx, dy] = input().mouse_move();
+                const auto extent = node.vertical ? node.bounds.bottom - node.bounds.top - m_splitter :
+                                                    node.bounds.right - node.bounds.left - m_splitter;
+                if(const auto delta = node.vertical ? dy : dx; extent > 0.0f && delta != 0.0f) {
+                    // keeps the tab bars of both sides
+                    const auto min_ratio = std::fmin(0.5f, m_tab_height / extent);
+                    node.ratio = std::clamp(node.ratio + delta / extent, min_ratio, 1.0f - min_ratio);
+                    m_state.layout(idx, node.bounds, m_splitter);
+                }
+            }
+            auto&& style = global_style();
+            add_primitive("splitter"_id,
+                          canvas_fill_rect{ { 0.0f, splitter_bounds.right - splitter_bounds.left, 0.0f,
+                                              splitter_bounds.bottom - splitter_bounds.top },
+                                            dragged ? style.action.selected : focused ? style.action.hover : style.background });
+            pop_region(std::nullopt);
+
+            render_splitters(node.first);
+            render_splitters(node.second);
+        }
+
+        // The markers in the middle of a pane where a window can be dropped, so that floating windows can still be moved over
+        // the panes. Like the preview, they are computed from the cached layout and the windows are not rendered again.
+        // When every window is floating, the empty docking area is a pane (npos) which only accepts windows in the center.
+        [[nodiscard]] bounds_aabb pane_bounds(const size_t leaf) const noexcept {
+            if(leaf == dock_node::npos)
+                return { 0.0f, m_state.size.x, 0.0f, m_state.size.y };
+            return m_state.nodes[leaf].bounds;
+        }
+        [[nodiscard]] bool accepts(const size_t leaf, const dock_zone zone) const noexcept {
+            return leaf != dock_node::npos || (m_state.root == dock_node::npos && zone == dock_zone::center);
+        }
+        [[nodiscard]] bounds_aabb marker_bounds(const size_t leaf, const dock_zone zone) const {
+            const auto [left, right, top, bottom] = pane_bounds(leaf);
+            auto x = (left + right) / 2.0f, y = (top + bottom) / 2.0f;
+            const auto size = m_tab_height * 1.5f;
+            const auto step = size + m_splitter;
+            // ReSharper disable once CppDefaultCaseNotHandledInSwitchStatement
+            switch(zone) {
+                case dock_zone::left:
+                    x -= step;
+                    break;
+                case dock_zone::right:
+                    x += step;
+                    break;
+                case dock_zone::top:
+                    y -= step;
+                    break;
+                case dock_zone::bottom:
+                    y += step;
+                    break;
+                case dock_zone::center:
+                    break;
+            }
+            return { x - size / 2.0f, x + size / 2.0f, y - size / 2.0f, y + size / 2.0f };
+        }
+        static constexpr std::array<dock_zone, 5> zones = { dock_zone::left, dock_zone::right, dock_zone::top, dock_zone::bottom,
+                                                            dock_zone::center };
+
+        // the leaf and the zone of it where the dragged window would dock
+        [[nodiscard]] std::optional<std::pair<size_t, dock_zone>> drop_target(const size_t leaf) const {
+            const auto pos = cursor();
+            for(const auto zone : zones)
+                if(const auto [l, r, t, b] = marker_bounds(leaf, zone);
+                   accepts(leaf, zone) && l <= pos.x && pos.x < r && t <= pos.y && pos.y < b)
+                    return std::make_pair(leaf, zone);
+            return std::nullopt;
+        }
+
+        // the area the dragged window would take
+        [[nodiscard]] bounds_aabb preview_bounds(const size_t leaf, const dock_zone zone) const {
+            auto bounds = pane_bounds(leaf);
+            const auto center_x = (bounds.left + bounds.right) / 2.0f;
+            const auto center_y = (bounds.top + bounds.bottom) / 2.0f;
+            // ReSharper disable once CppDefaultCaseNotHandledInSwitchStatement
+            switch(zone) {
+                case dock_zone::left:
+                    bounds.right = center_x;
+                    break;
+                case dock_zone::right:
+                    bounds.left = center_x;
+                    break;
+                case dock_zone::top:
+                    bounds.bottom = center_y;
+                    break;
+                case dock_zone::bottom:
+                    bounds.top = center_y;
+                    break;
+                case dock_zone::center:
+                    break;
+            }
+            return bounds;
+        }
+
+        void render_drop_targets(const size_t leaf, const std::optional<std::pair<size_t, dock_zone>>& target) {
+            auto&& style = global_style();
+            m_current_rank.reset();
+            if(target.has_value()) {
+                auto color = style.primary.main;
+                color.a *= 0.4f;
+                add_primitive("dock_preview"_id, canvas_fill_rect{ preview_bounds(leaf, target->second), color });
+            }
+            for(const auto zone : zones)
+                if(accepts(leaf, zone))
+                    add_primitive("dock_marker"_id,
+                                  canvas_fill_rect{ marker_bounds(leaf, zone),
+                                                    target.has_value() && target->second == zone ? style.action.hover :
+                                                                                                   style.action.active });
+        }
+
+        void render_docked(dock_window& win, std::optional<std::pmr::string> title, const window_attributes attributes,
+                           const std::function<void(window_canvas&)>& render_function) {
+            const auto leaf = win.leaf;
+            const auto& node = m_state.nodes[leaf];
+            const auto tab_idx =
+                static_cast<size_t>(std::find(node.windows.cbegin(), node.windows.cend(), win.id) - node.windows.cbegin());
+            const auto active = tab_idx == node.active;
+            const auto width = node.bounds.right - node.bounds.left;
+            const auto height = node.bounds.bottom - node.bounds.top;
+
+            auto&& style = global_style();
+            const auto tab_width = std::fmin(width / static_cast<float>(node.windows.size()),
+                                             style.default_font->standard_width() * 16.0f);
+            const auto tab_left = tab_width * static_cast<float>(tab_idx);
+
+            m_current_rank.reset();
+            push_region(win.id, node.bounds);
+            const auto tab_uid = push_region("tab"_id, bounds_aabb{ tab_left, tab_left + tab_width, 0.0f, m_tab_height }).second;
+            const auto focused = region_hovered();
+            const auto dragged = selected(*this, tab_uid);
+            add_primitive("tab_background"_id,
+                          canvas_fill_rect{ { 0.0f, tab_width, 0.0f, m_tab_height },
+                                            active ? style.panel_background :
+                                                focused ? style.action.hover :
+                                                          style.primary.dark });
+            if(title.has_value())
+                add_primitive("title"_id,
+                              canvas_text{ style.padding, std::move(title.value()), style.default_font, style.text.primary });
+            pop_region(std::nullopt);
+
+            if(active) {
+                docking_window_operator operator_{ *this, win.id };
+                window_canvas_impl canvas_node{ *this, { 0.0f, width, m_tab_height, height }, std::nullopt,
+                                                attributes | window_attributes::no_title_bar, operator_,
+                                                &win.absolute_bounds };
+                render_function(canvas_node);
+                canvas_node.finish();
+            }
+            pop_region(std::nullopt);
+
+            if(!dragged)
+                return;
+            m_state.nodes[leaf].active = tab_idx;
+            // dragging a tab out of the tab bar undocks the window, which follows the cursor until it is dropped
+            if(const auto pos = cursor(); !(node.bounds.left <= pos.x && pos.x < node.bounds.right &&
+                                            node.bounds.top <= pos.y && pos.y < node.bounds.top + m_tab_height)) {
+                const auto id = win.id;
+                m_state.undock(win, m_splitter);
+                const auto pane = m_state.locate(id);
+                pane->floating = true;
+                // half of the pane, so that the panes it can dock into stay visible
+                pane->bounds = { pos.x - tab_width / 2.0f, pos.x - tab_width / 2.0f + width / 2.0f, pos.y - m_tab_height / 2.0f,
+                                 pos.y - m_tab_height / 2.0f + height / 2.0f };
+                m_state.dragging = id;
+                m_state.grab = { tab_width / 2.0f, m_tab_height / 2.0f };
+                focus_window(id);
+            }
+        }
+
+        void render_floating(dock_window& win, std::optional<std::pmr::string> title, const window_attributes attributes,
+                             const std::function<void(window_canvas&)>& render_function) {
+            const auto beg = commands().size();
+            const auto size = reserved_size();
+            m_current_rank = static_cast<size_t>(&win - m_state.windows.data());
+            docking_window_operator operator_{ *this, win.id };
+            push_region(win.id, bounds_aabb{ 0.0f, size.x, 0.0f, size.y });
+            clamp_window_bounds(win.bounds, size);
+            window_canvas_impl canvas_node{ *this, win.bounds, std::move(title), attributes | window_attributes::movable,
+                                            operator_, &win.absolute_bounds };
+            render_function(canvas_node);
+            canvas_node.finish();
+            pop_region(std::nullopt);
+            m_ranges[win.id] = { beg, commands().size() };
+        }
+
+    public:
+        explicit docking_canvas_impl(canvas& parent)
+            : multiple_window_canvas{ parent }, m_state{ parent.storage<docking_state>(parent.region_sub_uid()) },
+              m_origin{ parent.region_offset() }, m_splitter{ parent.global_style().spacing.x },
+              m_tab_height{ parent.global_style().default_font->height() + 2.0f * parent.global_style().padding.y },
+              m_ranges{ parent.memory_resource() }, m_focus_requests{ parent.memory_resource() },
+              m_open_requests{ parent.memory_resource() }, m_close_requests{ parent.memory_resource() } {
+            for(auto idx = m_state.windows.size(); idx > 0; --idx) {
+                if(const auto& win = m_state.windows[idx - 1];
+                   win.is_open && win.leaf == dock_node::npos && hovered(win.absolute_bounds)) {
+                    m_hovered_rank = idx - 1;
+                    break;
+                }
+            }
+
+            if(const auto size = reserved_size(); size.x != m_state.size.x || size.y != m_state.size.y) {
+                m_state.size = size;
+                if(m_state.root != dock_node::npos)
+                    m_state.layout(m_state.root, { 0.0f, size.x, 0.0f, size.y }, m_splitter);
+            }
+            if(m_state.root != dock_node::npos)
+                render_splitters(m_state.root);
+        }
+        void new_window(const identifier id, std::optional<std::pmr::string> title, const window_attributes attributes,
+                        const std::function<void(window_canvas&)>& render_function) override {
+            auto win = m_state.locate(id);
+            if(!win) {
+                // new windows are docked as tabs of the first pane, behind its active tab
+                m_state.windows.push_back({ id, dock_node::npos, false, true, { 0.0f, 0.0f, 0.0f, 0.0f },
+                                            { 0.0f, 0.0f, 0.0f, 0.0f } });
+                if(const auto leaf = m_state.first_leaf(); leaf != dock_node::npos) {
+                    const auto active = m_state.nodes[leaf].active;
+                    m_state.dock(id, leaf, dock_zone::center, m_splitter);
+                    m_state.nodes[leaf].active = active;
+                } else
+                    m_state.dock(id, leaf, dock_zone::center, m_splitter);
+                win = m_state.locate(id);
+            }
+            if(!win->is_open)
+                return;
+            if(win->leaf != dock_node::npos)
+                render_docked(*win, std::move(title), attributes, render_function);
+            else
+                render_floating(*win, std::move(title), attributes, render_function);
+        }
+        [[nodiscard]] bool region_hovered() const override {
+            if(const auto current_bound = region_bounds(); !hovered(current_bound))
+                return false;
+            // covered by a floating window above the current one
+            return !m_hovered_rank.has_value() || (m_current_rank.has_value() && *m_hovered_rank <= *m_current_rank);
+        }
+        bool region_request_focus(const bool force) override {
+            if(force)
+                return layout_proxy::region_request_focus(true);
+            const auto bounds = region_bounds();
+
+            for(auto idx = m_current_rank.has_value() ? *m_current_rank + 1 : 0; idx < m_state.windows.size(); ++idx) {
+                if(const auto& win = m_state.windows[idx]; win.is_open && win.leaf == dock_node::npos) {
+                    if(const auto [l, r, t, b] = win.absolute_bounds;
+                       l <= bounds.left && bounds.right <= r && t <= bounds.top && bounds.bottom <= b)
+                        return false;
+                }
+            }
+
+            return layout_proxy::region_request_focus(false);
+        }
+        void close_window(const identifier id) override {
+            m_close_requests.push_back(id);
+        }
+        void open_window(const identifier id) override {
+            m_open_requests.push_back(id);
+            m_focus_requests.push_back(id);
+        }
+        void focus_window(const identifier id) override {
+            m_focus_requests.push_back(id);
+        }
+        void drag_window(const identifier id, const vec2 delta) {
+            if(m_state.dragging.has_value())
+                return;
+            // the cursor has already moved by delta
+            if(const auto win = m_state.locate(id); win && win->leaf == dock_node::npos) {
+                const auto pos = cursor();
+                m_state.dragging = id;
+                m_state.grab = { pos.x - delta.x - win->bounds.left, pos.y - delta.y - win->bounds.top };
+            }
+        }
+        void finish() {
+            for(auto&& id : m_close_requests) {
+                if(const auto win = m_state.locate(id); win && win->is_open) {
+                    win->is_open = false;
+                    if(win->leaf != dock_node::npos)
+                        m_state.undock(*win, m_splitter);
+                    if(m_state.dragging.has_value() && *m_state.dragging == id)
+                        m_state.dragging.reset();
+                }
+            }
+            for(auto&& id : m_open_requests) {
+                if(const auto win = m_state.locate(id); win && !win->is_open) {
+                    win->is_open = true;
+                    if(!win->floating)
+                        m_state.dock(id, m_state.first_leaf(), dock_zone::center, m_splitter);
+                }
+            }
+            for(auto&& id : m_focus_requests) {
+                const auto win = m_state.locate(id);
+                if(!win)
+                    continue;
+                if(win->leaf != dock_node::npos) {
+                    auto& node = m_state.nodes[win->leaf];
+                    node.active =
+                        static_cast<size_t>(std::find(node.windows.cbegin(), node.windows.cend(), id) - node.windows.cbegin());
+                } else {
+                    std::rotate(m_state.windows.begin() + (win - m_state.windows.data()),
+                                m_state.windows.begin() + (win - m_state.windows.data()) + 1, m_state.windows.end());
+                }
+            }
+
+            std::optional<std::pair<size_t, size_t>> preview;
+            if(m_state.dragging.has_value()) {
+                const auto id = *m_state.dragging;
+                const auto win = m_state.locate(id);
+                const auto leaf = m_state.leaf_at(cursor());
+                if(!input().action_press()) {
+                    // dropped
+                    if(const auto target = drop_target(leaf); target.has_value() && win) {
+                        win->floating = false;
+                        m_state.dock(id, target->first, target->second, m_splitter);
+                    }
+                    m_state.dragging.reset();
+                } else if(win) {
+                    const auto pos = cursor();
+                    const auto width = win->bounds.right - win->bounds.left;
+                    const auto height = win->bounds.bottom - win->bounds.top;
+                    win->bounds.left = pos.x - m_state.grab.x;
+                    win->bounds.top = pos.y - m_state.grab.y;
+                    win->bounds.right = win->bounds.left + width;
+                    win->bounds.bottom = win->bounds.top + height;
+
+                    if(leaf != dock_node::npos || m_state.root == dock_node::npos) {
+                        const auto beg = commands().size();
+                        render_drop_targets(leaf, drop_target(leaf));
+                        preview = { beg, commands().size() };
+                    }
+                }
+            }
+
+            // operations outside of the floating windows stay below them, and the preview stays above them
+            std::pmr::vector<operation_segment> windows{ memory_resource() };
+            windows.reserve(m_ranges.size() + 1);
+            for(auto&& win : m_state.windows)
+                if(const auto iter = m_ranges.find(win.id); iter != m_ranges.cend())
+                    windows.push_back({ iter->second.first, iter->second.second });
+            if(preview.has_value())
+                windows.push_back({ preview->first, preview->second });
+            raise_windows(*this, windows);
+        }
+    };
+
+    void docking_window_operator::close() {
+        m_canvas.close_window(m_id);
+    }
+
+    void docking_window_operator::focus() {
+        m_canvas.focus_window(m_id);
+    }
+
+    void docking_window_operator::move(const vec2 delta) {
+        m_canvas.drag_window(m_id, delta);
+    }
+
+    ANIMGUI_API void docking(canvas& parent, const std::function<void(multiple_window_canvas&)>& render_function) {
+        docking_canvas_impl canvas_node{ parent };
+        render_function(canvas_node);
+        canvas_node.finish();
+    }
+
+    struct cached_layer_state final {
+        texture_region tex;
+        identifier key;
+    };
+
+    ANIMGUI_API void cached_layer(canvas& parent, const identifier uid, const size_t deps,
+                                  const std::function<void(canvas&)>& render_function) {
+        const auto size = parent.reserved_size();
+        const bounds_aabb bounds{ 0.0f, size.x, 0.0f, size.y };
+        const auto id = parent.push_region(uid, bounds).second;
+
+        auto&& style = parent.global_style();
+        // fields are hashed one by one, as the layout of style may have padding
+        auto key = mix(identifier{ deps }, identifier{ reinterpret_cast<uint64_t>(style.default_font.get()) });
+        const auto add = [&key](const auto& value) { key = mix(key, fnv1a_impl(&value, sizeof(value))); };
+        for(auto&& color : { style.background, style.panel_background, style.text.primary, style.text.secondary,
+                             style.text.disabled, style.text.hint, style.action.active, style.action.hover,
+                             style.action.selected, style.action.disabled, style.primary.light, style.primary.main,
+                             style.primary.dark, style.primary.text, style.secondary.light, style.secondary.main,
+                             style.secondary.dark, style.secondary.text })
+            add(color);
+        for(auto&& metric : { style.padding, style.spacing, size })
+            add(metric);
+        for(auto&& metric : { style.rounding, style.bounds_edge_width, style.panel_bounds_edge_width })
+            add(metric);
+
+        auto& state = parent.storage<cached_layer_state>(mix(id, "cached_layer"_id));
+        if(!state.tex.tex || !(state.key == key)) {
+            state.tex = parent.render_offscreen(size, std::move(state.tex.tex), render_function);
+            state.key = key;
+        }
+
+        if(state.tex.tex)
+            parent.add_primitive("layer"_id, canvas_image{ bounds, state.tex, { 1.0f, 1.0f, 1.0f, 1.0f } });
+        else
+            render_function(parent);
+        parent.pop_region();
+    }
 }  // namespace animgui
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: MIT
+
+#include <animgui/builtins/remote.hpp>
+#include <array>
+#include <iostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+
+#ifdef ANIMGUI_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace animgui {
+#ifdef ANIMGUI_WINDOWS
+    using socket_handle = SOCKET;
+    static constexpr socket_handle invalid_socket = INVALID_SOCKET;
+    static void close_socket(const socket_handle handle) {
+        closesocket(handle);
+    }
+    static void startup_sockets() {
+        struct winsock_session final {
+            winsock_session() {
+                WSADATA data;
+                if(WSAStartup(MAKEWORD(2, 2), &data) != 0)
+                    throw std::runtime_error{ "failed to initialize winsock" };
+            }
+            winsock_session(const winsock_session&) = delete;
+            winsock_session(winsock_session&&) = delete;
+            winsock_session& operator=(const winsock_session&) = delete;
+            winsock_session& operator=(winsock_session&&) = delete;
+            ~winsock_session() {
+                WSACleanup();
+            }
+        };
+        static const winsock_session session;
+    }
+#else
+    using socket_handle = int;
+    static constexpr socket_handle invalid_socket = -1;
+    static void close_socket(const socket_handle handle) {
+        close(handle);
+    }
+    static void startup_sockets() {}
+#endif
+
+#ifdef MSG_NOSIGNAL
+    static constexpr int send_flags = MSG_NOSIGNAL;
+#else
+    static constexpr int send_flags = 0;
+#endif
+
+    // Buffered in both directions, the output is sent when the buffer is full or the stream is flushed.
+    class socket_buffer final : public std::streambuf {
+        socket_handle m_socket;
+        std::array<char, 1 << 16> m_input, m_output;
+
+        bool send_output() {
+            const char* data = pbase();
+            auto size = pptr() - pbase();
+            while(size > 0) {
+                const auto sent = send(m_socket, data, static_cast<int>(size), send_flags);
+                if(sent <= 0)
+                    return false;
+                data += sent;
+                size -= sent;
+            }
+            setp(m_output.data(), m_output.data() + m_output.size());
+            return true;
+        }
+
+    protected:
+        int_type overflow(const int_type ch) override {
+            if(!send_output())
+                return traits_type::eof();
+            if(!traits_type::eq_int_type(ch, traits_type::eof()))
+                sputc(traits_type::to_char_type(ch));
+            return traits_type::not_eof(ch);
+        }
+        int sync() override {
+            return send_output() ? 0 : -1;
+        }
+        int_type underflow() override {
+            const auto received = recv(m_socket, m_input.data(), static_cast<int>(m_input.size()), 0);
+            if(received <= 0)
+                return traits_type::eof();
+            setg(m_input.data(), m_input.data(), m_input.data() + received);
+            return traits_type::to_int_type(m_input.front());
+        }
+
+    public:
+        explicit socket_buffer(const socket_handle socket) : m_socket{ socket }, m_input{}, m_output{} {
+            setg(m_input.data(), m_input.data(), m_input.data());
+            setp(m_output.data(), m_output.data() + m_output.size());
+        }
+        socket_buffer(const socket_buffer&) = delete;
+        socket_buffer(socket_buffer&&) = delete;
+        socket_buffer& operator=(const socket_buffer&) = delete;
+        socket_buffer& operator=(socket_buffer&&) = delete;
+        ~socket_buffer() override {
+            send_output();
+            close_socket(m_socket);
+        }
+    };
+
+    class socket_stream final : public std::iostream {
+        socket_buffer m_buffer;
+
+    public:
+        explicit socket_stream(const socket_handle socket) : std::iostream{ nullptr }, m_buffer{ socket } {
+            rdbuf(&m_buffer);
+        }
+    };
+
+    // Resolves address, then calls connector with each candidate until it returns a valid socket.
+    template <typename Connector>
+    static socket_handle open_socket(const std::pmr::string& address, const Connector& connector) {
+        startup_sockets();
+        if(address.rfind("unix:", 0) == 0) {
+#ifdef ANIMGUI_WINDOWS
+            throw std::runtime_error{ "unix domain sockets are not supported" };
+#else
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            const auto path = address.substr(5);
+            if(path.empty() || path.size() >= sizeof(addr.sun_path))
+                throw std::runtime_error{ "invalid socket path" };
+            path.copy(addr.sun_path, path.size());
+            return connector(AF_UNIX, reinterpret_cast<const sockaddr*>(&addr), static_cast<socklen_t>(sizeof(addr)),
+                             path.c_str());
+#endif
+        }
+
+        const auto pos = address.rfind(':');
+        if(pos == std::pmr::string::npos)
+            throw std::runtime_error{ "invalid address" };
+        const std::string host{ address.substr(0, pos) }, port{ address.substr(pos + 1) };
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo* result = nullptr;
+        if(getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result) != 0)
+            throw std::runtime_error{ "failed to resolve " + host };
+
+        auto handle = invalid_socket;
+        for(auto iter = result; iter && handle == invalid_socket; iter = iter->ai_next)
+            handle = connector(iter->ai_family, iter->ai_addr, static_cast<socklen_t>(iter->ai_addrlen), nullptr);
+        freeaddrinfo(result);
+        return handle;
+    }
+
+    static void set_socket_options(const socket_handle handle, const int family) {
+        // frames are flushed one by one, do not hold them back
+        if(family != AF_UNIX) {
+            int enable = 1;
+            setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+        }
+#ifdef SO_NOSIGPIPE
+        int enable = 1;
+        setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+    }
+
+    ANIMGUI_API std::shared_ptr<std::iostream> accept_remote_viewer(const std::pmr::string& address) {
+        int family = AF_UNSPEC;
+        const auto listener =
+            open_socket(address, [&](const int addr_family, const sockaddr* addr, const socklen_t size, const char* path) {
+                const auto handle = socket(addr_family, SOCK_STREAM, 0);
+                if(handle == invalid_socket)
+                    return invalid_socket;
+#ifndef ANIMGUI_WINDOWS
+                if(path)
+                    unlink(path);
+#endif
+                int enable = 1;
+                setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&enable), sizeof(enable));
+                if(bind(handle, addr, size) != 0 || listen(handle, 1) != 0) {
+                    close_socket(handle);
+                    return invalid_socket;
+                }
+                family = addr_family;
+                return handle;
+            });
+        if(listener == invalid_socket)
+            throw std::runtime_error{ "failed to listen on " + std::string{ address } };
+
+        const auto handle = accept(listener, nullptr, nullptr);
+        close_socket(listener);
+        if(handle == invalid_socket)
+            throw std::runtime_error{ "failed to accept a viewer" };
+        set_socket_options(handle, family);
+        return std::make_shared<socket_stream>(handle);
+    }
+
+    ANIMGUI_API std::shared_ptr<std::iostream> connect_remote_host(const std::pmr::string& address) {
+        int family = AF_UNSPEC;
+        const auto handle =
+            open_socket(address, [&](const int addr_family, const sockaddr* addr, const socklen_t size, const char*) {
+                const auto candidate = socket(addr_family, SOCK_STREAM, 0);
+                if(candidate == invalid_socket)
+                    return invalid_socket;
+                if(connect(candidate, addr, size) != 0) {
+                    close_socket(candidate);
+                    return invalid_socket;
+                }
+                family = addr_family;
+                return candidate;
+            });
+        if(handle == invalid_socket)
+            throw std::runtime_error{ "failed to connect to " + std::string{ address } };
+        set_socket_options(handle, family);
+        return std::make_shared<socket_stream>(handle);
+    }
+}  // namespace animgui
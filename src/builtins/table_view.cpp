@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: MIT
+
+#include <animgui/builtins/table_view.hpp>
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace animgui {
+    class table_view_impl final : public table_view {
+        struct job final {
+            size_t row_count;
+            uint64_t filter_generation;
+            std::function<bool(size_t)> predicate;
+            std::function<bool(size_t, size_t)> less;
+        };
+
+        // rows handled by a task, large enough to hide the cost of scheduling
+        static constexpr size_t chunk_size = 1 << 15;
+
+        std::unique_ptr<thread_pool> m_thread_pool;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        job m_job;
+        // bumped by every change, so that the worker can abandon a job which is out of date
+        std::atomic<uint64_t> m_generation{ 0 };
+        uint64_t m_finished_generation = 0;
+        std::vector<size_t> m_result;
+        std::exception_ptr m_exception;
+        bool m_stop = false;
+
+        uint64_t m_applied_generation = 0;
+        std::vector<size_t> m_rows;
+
+        // owned by the worker, the filtered rows in data order are reused if only the comparator changes
+        std::vector<size_t> m_filtered;
+        uint64_t m_filtered_generation = 0;
+
+        std::thread m_worker;
+
+        void parallel_for(const size_t size, const std::function<void(size_t)>& task) {
+            if(m_thread_pool)
+                m_thread_pool->parallel_for(size, task);
+            else
+                for(size_t idx = 0; idx < size; ++idx)
+                    task(idx);
+        }
+
+        [[nodiscard]] bool cancelled(const uint64_t generation) const noexcept {
+            return m_generation.load(std::memory_order_relaxed) != generation;
+        }
+
+        bool filter_rows(const job& current, const uint64_t generation) {
+            std::vector<size_t> filtered;
+            if(!current.predicate) {
+                filtered.resize(current.row_count);
+                std::iota(filtered.begin(), filtered.end(), static_cast<size_t>(0));
+            } else {
+                std::vector<std::vector<size_t>> chunks((current.row_count + chunk_size - 1) / chunk_size);
+                parallel_for(chunks.size(), [&](const size_t idx) {
+                    if(cancelled(generation))
+                        return;
+                    const auto end = std::min(current.row_count, (idx + 1) * chunk_size);
+                    for(auto row = idx * chunk_size; row < end; ++row)
+                        if(current.predicate(row))
+                            chunks[idx].push_back(row);
+                });
+                if(cancelled(generation))
+                    return false;
+
+                size_t total = 0;
+                for(auto&& chunk : chunks)
+                    total += chunk.size();
+                filtered.reserve(total);
+                for(auto&& chunk : chunks)
+                    filtered.insert(filtered.end(), chunk.cbegin(), chunk.cend());
+            }
+            m_filtered = std::move(filtered);
+            m_filtered_generation = current.filter_generation;
+            return true;
+        }
+
+        // stable sorts runs of rows in parallel, then merges pairs of neighbouring runs until one run is left
+        bool sort_rows(std::vector<size_t>& rows, const std::function<bool(size_t, size_t)>& less, const uint64_t generation) {
+            const auto run_count = m_thread_pool && rows.size() >= 2 * chunk_size ?
+                std::min(m_thread_pool->concurrency(), rows.size() / chunk_size) :
+                1;
+            std::vector<size_t> bounds(run_count + 1);
+            for(size_t idx = 0; idx <= run_count; ++idx)
+                bounds[idx] = rows.size() * idx / run_count;
+
+            parallel_for(run_count, [&](const size_t idx) {
+                std::stable_sort(rows.begin() + static_cast<ptrdiff_t>(bounds[idx]),
+                                 rows.begin() + static_cast<ptrdiff_t>(bounds[idx + 1]), less);
+            });
+
+            std::vector<size_t> buffer(run_count > 1 ? rows.size() : 0);
+            while(bounds.size() > 2) {
+                if(cancelled(generation))
+                    return false;
+                const auto runs = bounds.size() - 1;
+                parallel_for((runs + 1) / 2, [&](const size_t idx) {
+                    const auto first = rows.begin() + static_cast<ptrdiff_t>(bounds[2 * idx]);
+                    const auto middle = rows.begin() + static_cast<ptrdiff_t>(bounds[std::min(2 * idx + 1, runs)]);
+                    const auto last = rows.begin() + static_cast<ptrdiff_t>(bounds[std::min(2 * idx + 2, runs)]);
+                    std::merge(first, middle, middle, last, buffer.begin() + static_cast<ptrdiff_t>(bounds[2 * idx]), less);
+                });
+
+                std::vector<size_t> merged_bounds;
+                merged_bounds.reserve(runs / 2 + 2);
+                for(size_t idx = 0; idx < runs; idx += 2)
+                    merged_bounds.push_back(bounds[idx]);
+                merged_bounds.push_back(bounds.back());
+                bounds.swap(merged_bounds);
+                rows.swap(buffer);
+            }
+            return !cancelled(generation);
+        }
+
+        void worker() {
+            uint64_t generation = 0;
+            while(true) {
+                job current;
+                {
+                    std::unique_lock<std::mutex> guard{ m_mutex };
+                    m_cv.wait(guard, [&] { return m_stop || m_generation.load() != generation; });
+                    if(m_stop)
+                        return;
+                    generation = m_generation.load();
+                    current = m_job;
+                }
+
+                std::vector<size_t> rows;
+                std::exception_ptr exception;
+                try {
+                    if(current.filter_generation != m_filtered_generation && !filter_rows(current, generation))
+                        continue;
+                    rows = m_filtered;
+                    if(current.less && !sort_rows(rows, current.less, generation))
+                        continue;
+                } catch(...) {
+                    exception = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> guard{ m_mutex };
+                if(cancelled(generation))
+                    continue;
+                m_result = std::move(rows);
+                m_exception = exception;
+                m_finished_generation = generation;
+            }
+        }
+
+        void start() {
+            m_generation.fetch_add(1);
+            m_cv.notify_one();
+        }
+
+    public:
+        table_view_impl(const size_t row_count, const size_t thread_count)
+            : m_thread_pool{ thread_count > 1 ? std::make_unique<thread_pool>(thread_count - 1) : nullptr },
+              m_job{ row_count, 0, {}, {} }, m_rows(row_count), m_worker{ [this] { worker(); } } {
+            std::iota(m_rows.begin(), m_rows.end(), static_cast<size_t>(0));
+            m_filtered = m_rows;
+        }
+        table_view_impl(const table_view_impl&) = delete;
+        table_view_impl(table_view_impl&&) = delete;
+        table_view_impl& operator=(const table_view_impl&) = delete;
+        table_view_impl& operator=(table_view_impl&&) = delete;
+        ~table_view_impl() override {
+            {
+                std::lock_guard<std::mutex> guard{ m_mutex };
+                m_stop = true;
+                // abandon the running job
+                m_generation.fetch_add(1);
+            }
+            m_cv.notify_one();
+            m_worker.join();
+        }
+
+        void reset(const size_t row_count) override {
+            std::lock_guard<std::mutex> guard{ m_mutex };
+            m_job.row_count = row_count;
+            ++m_job.filter_generation;
+            start();
+        }
+        void filter(std::function<bool(size_t)> predicate) override {
+            std::lock_guard<std::mutex> guard{ m_mutex };
+            m_job.predicate = std::move(predicate);
+            ++m_job.filter_generation;
+            start();
+        }
+        void sort(std::function<bool(size_t, size_t)> less) override {
+            std::lock_guard<std::mutex> guard{ m_mutex };
+            m_job.less = std::move(less);
+            start();
+        }
+        bool poll() override {
+            std::lock_guard<std::mutex> guard{ m_mutex };
+            if(m_finished_generation == m_applied_generation)
+                return false;
+            m_applied_generation = m_finished_generation;
+            if(auto exception = std::exchange(m_exception, nullptr))
+                std::rethrow_exception(exception);
+            m_rows.swap(m_result);
+            return true;
+        }
+        [[nodiscard]] bool busy() const noexcept override {
+            return m_applied_generation != m_generation.load();
+        }
+        [[nodiscard]] span<const size_t> rows() const noexcept override {
+            return { m_rows.data(), m_rows.data() + m_rows.size() };
+        }
+    };
+
+    ANIMGUI_API std::shared_ptr<table_view> create_table_view(const size_t row_count, const uint32_t thread_count) {
+        return std::make_shared<table_view_impl>(row_count,
+                                                 thread_count ? thread_count : std::max(1U, std::thread::hardware_concurrency()));
+    }
+}  // namespace animgui
@@ -0,0 +1,9 @@
+// SPDX-License-Identifier: MIT
+
+#include "text_buffer_impl.hpp"
+
+namespace animgui {
+    ANIMGUI_API std::shared_ptr<text_buffer> create_text_buffer(const std::string_view str) {
+        return std::make_shared<text_buffer_impl>(str);
+    }
+}  // namespace animgui
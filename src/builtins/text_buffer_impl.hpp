@@ -0,0 +1,328 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <animgui/builtins/text_buffer.hpp>
+#include <algorithm>
+#include <random>
+#include <string>
+
+namespace animgui {
+    // chunks are split in halves when they grow larger
+    constexpr size_t max_chunk_size = 1024;
+
+    inline bool is_continuation(const char ch) noexcept {
+        return (static_cast<uint8_t>(ch) & 0xC0) == 0x80;
+    }
+
+    inline size_t count_codepoints(const std::string_view str) noexcept {
+        return static_cast<size_t>(std::count_if(str.cbegin(), str.cend(), [](const char ch) { return !is_continuation(ch); }));
+    }
+
+    inline size_t count_lines(const std::string_view str) noexcept {
+        return static_cast<size_t>(std::count(str.cbegin(), str.cend(), '\n'));
+    }
+
+    // the offset in bytes of the codepoint pos
+    inline size_t byte_offset(const std::string_view str, size_t pos) noexcept {
+        size_t offset = 0;
+        for(; offset < str.size(); ++offset)
+            if(!is_continuation(str[offset]) && pos-- == 0)
+                break;
+        return offset;
+    }
+
+    // the offset in bytes of the first codepoint at or after the middle of str
+    inline size_t middle_offset(const std::string_view str) noexcept {
+        auto offset = str.size() / 2;
+        while(offset < str.size() && is_continuation(str[offset]))
+            ++offset;
+        return offset;
+    }
+
+    // A node of a treap ordered by position. Each node holds a chunk, and the counts of its subtree let every query descend
+    // from the root in O(log n).
+    struct rope_node final {
+        std::string text;
+        size_t codepoints = 0;
+        size_t lines = 0;
+        size_t subtree_codepoints = 0;
+        size_t subtree_lines = 0;
+        uint32_t priority = 0;
+        std::unique_ptr<rope_node> left, right;
+
+        void update() noexcept {
+            codepoints = count_codepoints(text);
+            lines = count_lines(text);
+            update_subtree();
+        }
+        void update_subtree() noexcept {
+            subtree_codepoints = codepoints;
+            subtree_lines = lines;
+            for(auto&& child : { left.get(), right.get() })
+                if(child) {
+                    subtree_codepoints += child->subtree_codepoints;
+                    subtree_lines += child->subtree_lines;
+                }
+        }
+        [[nodiscard]] size_t left_codepoints() const noexcept {
+            return left ? left->subtree_codepoints : 0;
+        }
+        [[nodiscard]] size_t left_lines() const noexcept {
+            return left ? left->subtree_lines : 0;
+        }
+    };
+
+    using rope = std::unique_ptr<rope_node>;
+
+    inline rope merge(rope lhs, rope rhs) {
+        if(!lhs)
+            return rhs;
+        if(!rhs)
+            return lhs;
+        if(lhs->priority >= rhs->priority) {
+            lhs->right = merge(std::move(lhs->right), std::move(rhs));
+            lhs->update_subtree();
+            return lhs;
+        }
+        rhs->left = merge(std::move(lhs), std::move(rhs->left));
+        rhs->update_subtree();
+        return rhs;
+    }
+
+    // lifts the right child of node above it
+    inline void rotate_left(rope& node) noexcept {
+        auto child = std::move(node->right);
+        node->right = std::move(child->left);
+        node->update_subtree();
+        child->left = std::move(node);
+        child->update_subtree();
+        node = std::move(child);
+    }
+    // lifts the left child of node above it
+    inline void rotate_right(rope& node) noexcept {
+        auto child = std::move(node->left);
+        node->left = std::move(child->right);
+        node->update_subtree();
+        child->right = std::move(node);
+        child->update_subtree();
+        node = std::move(child);
+    }
+
+    class text_buffer_impl final : public text_buffer {
+        // declared before m_root, which is built with it
+        std::minstd_rand m_random;
+        rope m_root;
+        uint64_t m_version = 0;
+
+        rope make_node(const std::string_view str) {
+            auto node = std::make_unique<rope_node>();
+            node->text = str;
+            node->priority = static_cast<uint32_t>(m_random());
+            node->update();
+            return node;
+        }
+        // a rope of chunks of at most half of max_chunk_size, so that they can grow before they are split
+        rope build(std::string_view str) {
+            rope res;
+            while(!str.empty()) {
+                auto size = std::min(str.size(), max_chunk_size / 2);
+                while(size < str.size() && is_continuation(str[size]))
+                    ++size;
+                res = merge(std::move(res), make_node(str.substr(0, size)));
+                str.remove_prefix(size);
+            }
+            return res;
+        }
+
+        // the first pos codepoints and the rest
+        std::pair<rope, rope> split(rope node, const size_t pos) {
+            if(!node)
+                return {};
+            const auto left = node->left_codepoints();
+            if(pos <= left) {
+                auto [lhs, rhs] = split(std::move(node->left), pos);
+                node->left = std::move(rhs);
+                node->update_subtree();
+                return { std::move(lhs), std::move(node) };
+            }
+            if(pos >= left + node->codepoints) {
+                auto [lhs, rhs] = split(std::move(node->right), pos - left - node->codepoints);
+                node->right = std::move(lhs);
+                node->update_subtree();
+                return { std::move(node), std::move(rhs) };
+            }
+            // the chunk itself is split, the tail gets its own priority and is merged with the chunks after it
+            const auto offset = byte_offset(node->text, pos - left);
+            auto tail = make_node(std::string_view{ node->text }.substr(offset));
+            node->text.erase(offset);
+            auto rhs = merge(std::move(tail), std::move(node->right));
+            node->update();
+            return { std::move(node), std::move(rhs) };
+        }
+
+        // Inserts a short str into the chunk which contains pos. A chunk which grows too large is split in halves, and the
+        // new node is lifted by rotations on the way back until the heap order holds again, as in a treap insertion.
+        void insert_into(rope& node, const size_t pos, const std::string_view str) {
+            const auto left = node->left_codepoints();
+            if(pos < left) {
+                insert_into(node->left, pos, str);
+                node->update_subtree();
+                if(node->left->priority > node->priority)
+                    rotate_right(node);
+            } else if(pos > left + node->codepoints) {
+                insert_into(node->right, pos - left - node->codepoints, str);
+                node->update_subtree();
+                if(node->right->priority > node->priority)
+                    rotate_left(node);
+            } else {
+                node->text.insert(byte_offset(node->text, pos - left), str);
+                if(node->text.size() > max_chunk_size) {
+                    // the tail is the leftmost node of the right subtree, so the merge puts it either there or at its root
+                    const auto offset = middle_offset(node->text);
+                    auto tail = make_node(std::string_view{ node->text }.substr(offset));
+                    node->text.erase(offset);
+                    node->right = merge(std::move(tail), std::move(node->right));
+                }
+                node->update();
+                if(node->right && node->right->priority > node->priority)
+                    rotate_left(node);
+            }
+        }
+
+        // only visits the nodes which intersect [begin, end), and drops the chunks which become empty
+        static void erase_range(rope& node, const size_t begin, const size_t end) {
+            if(!node || begin >= end)
+                return;
+            const auto left = node->left_codepoints();
+            const auto own_end = left + node->codepoints;
+            if(end > own_end)
+                erase_range(node->right, std::max(begin, own_end) - own_end, end - own_end);
+            if(begin < own_end && end > left) {
+                const auto first = byte_offset(node->text, std::max(begin, left) - left);
+                const auto last = byte_offset(node->text, std::min(end, own_end) - left);
+                node->text.erase(first, last - first);
+            }
+            if(begin < left)
+                erase_range(node->left, begin, std::min(end, left));
+
+            if(node->text.empty())
+                node = merge(std::move(node->left), std::move(node->right));
+            else
+                node->update();
+        }
+
+        static void append(const rope_node* node, const size_t begin, const size_t end, std::pmr::string& res) {
+            if(!node || begin >= end)
+                return;
+            const auto left = node->left_codepoints();
+            const auto own_end = left + node->codepoints;
+            if(begin < left)
+                append(node->left.get(), begin, std::min(end, left), res);
+            if(begin < own_end && end > left) {
+                const auto first = byte_offset(node->text, std::max(begin, left) - left);
+                const auto last = byte_offset(node->text, std::min(end, own_end) - left);
+                res.append(node->text, first, last - first);
+            }
+            if(end > own_end)
+                append(node->right.get(), std::max(begin, own_end) - own_end, end - own_end, res);
+        }
+
+    public:
+        explicit text_buffer_impl(const std::string_view str) : m_root{ build(str) } {}
+
+        [[nodiscard]] size_t size() const noexcept override {
+            return m_root ? m_root->subtree_codepoints : 0;
+        }
+        [[nodiscard]] size_t line_count() const noexcept override {
+            return (m_root ? m_root->subtree_lines : 0) + 1;
+        }
+        [[nodiscard]] size_t line_begin(const size_t line) const override {
+            if(line == 0)
+                return 0;
+            if(line >= line_count())
+                return size();
+            // the position after the '\n' which ends the previous line
+            auto remaining = line;
+            size_t pos = 0;
+            auto node = m_root.get();
+            while(true) {
+                if(remaining <= node->left_lines()) {
+                    node = node->left.get();
+                    continue;
+                }
+                remaining -= node->left_lines();
+                pos += node->left_codepoints();
+                if(remaining <= node->lines) {
+                    for(auto&& ch : node->text) {
+                        if(is_continuation(ch))
+                            continue;
+                        ++pos;
+                        if(ch == '\n' && --remaining == 0)
+                            return pos;
+                    }
+                }
+                remaining -= node->lines;
+                pos += node->codepoints;
+                node = node->right.get();
+            }
+        }
+        [[nodiscard]] size_t line_end(const size_t line) const override {
+            return line + 1 < line_count() ? line_begin(line + 1) - 1 : size();
+        }
+        [[nodiscard]] size_t line_of(size_t pos) const override {
+            size_t line = 0;
+            auto node = m_root.get();
+            while(node) {
+                const auto left = node->left_codepoints();
+                if(pos < left) {
+                    node = node->left.get();
+                    continue;
+                }
+                line += node->left_lines();
+                pos -= left;
+                if(pos < node->codepoints) {
+                    const std::string_view text{ node->text };
+                    return line + count_lines(text.substr(0, byte_offset(text, pos)));
+                }
+                line += node->lines;
+                pos -= node->codepoints;
+                node = node->right.get();
+            }
+            return line;
+        }
+        [[nodiscard]] std::pmr::string text(const size_t begin, const size_t end,
+                                            std::pmr::memory_resource* memory_resource) const override {
+            std::pmr::string res{ memory_resource };
+            append(m_root.get(), begin, std::min(end, size()), res);
+            return res;
+        }
+        void insert(size_t pos, const std::string_view str) override {
+            if(str.empty())
+                return;
+            ++m_version;
+            pos = std::min(pos, size());
+            if(m_root && str.size() <= max_chunk_size / 2) {
+                insert_into(m_root, pos, str);
+                return;
+            }
+            auto [lhs, rhs] = split(std::move(m_root), pos);
+            m_root = merge(merge(std::move(lhs), build(str)), std::move(rhs));
+        }
+        void erase(const size_t begin, const size_t end) override {
+            if(begin >= std::min(end, size()))
+                return;
+            ++m_version;
+            erase_range(m_root, begin, std::min(end, size()));
+        }
+        [[nodiscard]] uint64_t version() const noexcept override {
+            return m_version;
+        }
+        // the number of nodes on the longest path from the root, which the tests check to stay logarithmic
+        [[nodiscard]] size_t depth() const noexcept {
+            const auto depth_of = [](const auto& self, const rope_node* node) -> size_t {
+                return node ? 1 + std::max(self(self, node->left.get()), self(self, node->right.get())) : 0;
+            };
+            return depth_of(depth_of, m_root.get());
+        }
+    };
+}  // namespace animgui
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace animgui {
+    // Fixed set of workers running one parallel_for job at a time. Workers claim indices from a shared atomic counter, so a
+    // worker which finishes early keeps taking the remaining items instead of waiting on a static partition.
+    class thread_pool final {
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_job_cv, m_done_cv;
+        const std::function<void(size_t)>* m_job = nullptr;
+        size_t m_job_size = 0;
+        std::atomic<size_t> m_next{ 0 };
+        uint64_t m_generation = 0;
+        size_t m_running = 0;
+        std::exception_ptr m_exception;
+        bool m_stop = false;
+
+        void run_job(const std::function<void(size_t)>& job, const size_t size) {
+            try {
+                for(auto idx = m_next.fetch_add(1, std::memory_order_relaxed); idx < size;
+                    idx = m_next.fetch_add(1, std::memory_order_relaxed))
+                    job(idx);
+            } catch(...) {
+                // skip the remaining items
+                m_next.store(size, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> guard{ m_mutex };
+                if(!m_exception)
+                    m_exception = std::current_exception();
+            }
+        }
+        void worker() {
+            uint64_t generation = 0;
+            while(true) {
+                const std::function<void(size_t)>* job;
+                size_t size;
+                {
+                    std::unique_lock<std::mutex> guard{ m_mutex };
+                    m_job_cv.wait(guard, [&] { return m_stop || m_generation != generation; });
+                    if(m_stop)
+                        return;
+                    generation = m_generation;
+                    job = m_job;
+                    size = m_job_size;
+                }
+                run_job(*job, size);
+                {
+                    std::lock_guard<std::mutex> guard{ m_mutex };
+                    if(--m_running == 0)
+                        m_done_cv.notify_one();
+                }
+            }
+        }
+
+    public:
+        explicit thread_pool(const size_t worker_count) {
+            m_workers.reserve(worker_count);
+            for(size_t idx = 0; idx < worker_count; ++idx)
+                m_workers.emplace_back([this] { worker(); });
+        }
+        thread_pool(const thread_pool&) = delete;
+        thread_pool(thread_pool&&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+        thread_pool& operator=(thread_pool&&) = delete;
+        ~thread_pool() {
+            {
+                std::lock_guard<std::mutex> guard{ m_mutex };
+                m_stop = true;
+            }
+            m_job_cv.notify_all();
+            for(auto&& worker : m_workers)
+                worker.join();
+        }
+
+        [[nodiscard]] size_t concurrency() const noexcept {
+            return m_workers.size() + 1;
+        }
+
+        // Calls job(0) ... job(size - 1) and blocks until all of them have finished. The calling thread takes part in the
+        // work. The first exception thrown by a job is rethrown here.
+        void parallel_for(const size_t size, const std::function<void(size_t)>& job) {
+            if(m_workers.empty() || size <= 1) {
+                for(size_t idx = 0; idx < size; ++idx)
+                    job(idx);
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> guard{ m_mutex };
+                m_job = &job;
+                m_job_size = size;
+                m_next.store(0, std::memory_order_relaxed);
+                m_running = m_workers.size();
+                ++m_generation;
+            }
+            m_job_cv.notify_all();
+            run_job(job, size);
+
+            std::unique_lock<std::mutex> guard{ m_mutex };
+            m_done_cv.wait(guard, [&] { return m_running == 0; });
+            m_job = nullptr;
+            if(auto exception = std::exchange(m_exception, nullptr))
+                std::rethrow_exception(exception);
+        }
+    };
+}  // namespace animgui
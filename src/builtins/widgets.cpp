@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MIT
 
 #include <animgui/builtins/layouts.hpp>
+#include <animgui/builtins/text_buffer.hpp>
 #include <animgui/builtins/widgets.hpp>
 #include <animgui/core/canvas.hpp>
 #include <animgui/core/common.hpp>
@@ -8,6 +9,11 @@
 #include <animgui/core/style.hpp>
 #include <cassert>
 #include <cmath>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <utf8.h>
 
 namespace animgui {
@@ -276,6 +282,17 @@ namespace animgui {
         parent.pop_region();
         return text_modifier{ parent, idx };
     }
+    ANIMGUI_API void paragraph(canvas& parent, const float width, std::pmr::string str, const text_alignment alignment) {
+        paragraph(parent, width, paragraph_text{ std::move(str) }, alignment);
+    }
+    ANIMGUI_API void paragraph(canvas& parent, const float width, paragraph_text str, const text_alignment alignment) {
+        primitive text = canvas_paragraph{ vec2{ 0.0f, 0.0f }, width, std::move(str), parent.global_style().default_font,
+                                           parent.global_style().text.primary, alignment };
+        const auto [w, h] = parent.calculate_bounds(text);
+        parent.push_region(parent.region_sub_uid(), bounds_aabb{ 0.0f, w, 0.0f, h });
+        parent.add_primitive("content"_id, std::move(text));
+        parent.pop_region();
+    }
     ANIMGUI_API bool clicked(canvas& parent, const identifier id, const bool pressed, const bool focused) {
         auto& last_pressed = parent.storage<bool>(id);
         const auto res = last_pressed && !pressed && focused;
@@ -557,7 +574,11 @@ namespace animgui {
                 // ReSharper disable once CppTooWideScope
                 constexpr auto one_second = static_cast<uint64_t>(clock::period::den);
 
-                if(static_cast<uint64_t>(clock::now().time_since_epoch().count()) % one_second > one_second / 2) {
+                const auto now = static_cast<uint64_t>(clock::now().time_since_epoch().count());
+                // redraw when the cursor blinks
+                parent.request_redraw(static_cast<float>(one_second / 2 - now % (one_second / 2)) /
+                                      static_cast<float>(one_second));
+                if(now % one_second > one_second / 2) {
                     cursor_show = true;
                     if(override_mode && std::fabs(start_pos - end_pos) > 0.01f) {
                         rect_cursor = true;
@@ -613,6 +634,270 @@ namespace animgui {
         modifier.set_style(style);
         return modifier;
     }
+    // the x positions of the codepoints of a line, and of its end
+    struct measured_line final {
+        std::string text;
+        std::vector<float> x;
+    };
+
+    // Lines are measured once while they stay in view. The lines of a frame are looked up by their text, so an edit only
+    // measures the edited lines again, even when the lines below move.
+    struct text_editor_cache final {
+        std::unordered_map<uint64_t, measured_line> previous;
+        std::unordered_map<uint64_t, measured_line> current;
+    };
+
+    struct text_editor_state final {
+        bool edit;
+        bool pressed;
+        size_t cursor;
+        // the other end of the selection
+        size_t anchor;
+        vec2 offset;
+        // the x position kept while moving up and down
+        std::optional<float> preferred_x;
+        // on the heap, as the canvas storage may move its objects
+        std::unique_ptr<text_editor_cache> cache;
+    };
+
+    ANIMGUI_API text_edit_status text_editor(canvas& parent, const vec2 size, text_buffer& buffer) {
+        auto&& style = parent.global_style();
+        auto&& font = *style.default_font;
+        const auto line_height = font.line_spacing();
+        const bounds_aabb full_bounds{ 0.0f, size.x, 0.0f, size.y };
+        const vec2 view{ std::fmax(0.0f, size.x - 2.0f * style.padding.x), std::fmax(0.0f, size.y - 2.0f * style.padding.y) };
+
+        const auto uid = parent.push_region(parent.region_sub_uid(), full_bounds).second;
+        auto&& state = parent.storage<text_editor_state>(uid);
+        if(!state.cache)
+            state.cache = std::make_unique<text_editor_cache>();
+        auto&& [previous, current] = *state.cache;
+        // the buffer may have been changed by the application
+        state.cursor = std::min(state.cursor, buffer.size());
+        state.anchor = std::min(state.anchor, buffer.size());
+
+        const auto measure = [&](const size_t line) -> const measured_line& {
+            const auto begin = buffer.line_begin(line);
+            const auto str = buffer.text(begin, buffer.line_end(line), parent.memory_resource());
+            const std::string_view text{ str };
+            const auto key = fnv1a_impl(text.data(), text.size()).id;
+            if(const auto iter = current.find(key); iter != current.cend() && iter->second.text == text)
+                return iter->second;
+            if(const auto iter = previous.find(key); iter != previous.cend() && iter->second.text == text)
+                return current[key] = std::move(iter->second);
+
+            measured_line res{ std::string{ text }, { 0.0f } };
+            glyph_id prev{ 0 };
+            for(auto iter = text.cbegin(); iter != text.cend();) {
+                const auto glyph = font.to_glyph(utf8::next(iter, text.cend()));
+                res.x.push_back(res.x.back() + font.calculate_advance(glyph, prev));
+                prev = glyph;
+            }
+            return current[key] = std::move(res);
+        };
+        const auto x_of = [&](const size_t pos) {
+            const auto line = buffer.line_of(pos);
+            return measure(line).x[pos - buffer.line_begin(line)];
+        };
+        // the nearest position of a line to x
+        const auto position_at = [&](const size_t line, const float x) {
+            const auto& xs = measure(line).x;
+            const auto iter = std::lower_bound(xs.cbegin(), xs.cend(), x);
+            auto col = static_cast<size_t>(iter - xs.cbegin());
+            if(iter == xs.cend() || (iter != xs.cbegin() && x - *std::prev(iter) < *iter - x))
+                --col;
+            return buffer.line_begin(line) + col;
+        };
+        const auto line_at = [&](const float y) {
+            return static_cast<size_t>(std::fmin(std::fmax(0.0f, std::floor(y / line_height)),
+                                                 static_cast<float>(buffer.line_count() - 1)));
+        };
+
+        bool committed = false;
+        bool moved = false;
+        auto& input_backend = parent.input();
+        const auto clicked_pos = [&] {
+            const auto [x, y] = input_backend.get_cursor_pos();
+            const auto offset = parent.region_offset();
+            return position_at(line_at(y - offset.y - style.padding.y + state.offset.y),
+                               x - offset.x - style.padding.x + state.offset.x);
+        };
+
+        if(selected(parent, uid)) {
+            // pressing places the cursor, dragging selects
+            state.cursor = clicked_pos();
+            if(!state.pressed)
+                state.anchor = state.cursor;
+            state.edit = true;
+            state.preferred_x.reset();
+            moved = true;
+        } else if(state.edit && input_backend.action_press()) {
+            committed = true;
+            state.edit = false;
+        }
+        state.pressed = input_backend.action_press();
+
+        if(parent.region_hovered()) {
+            input_backend.set_cursor(cursor::edit);
+            constexpr auto lines_per_step = 3.0f;
+            state.offset.y -= input_backend.scroll().y * input_backend.scroll_factor().y * lines_per_step * line_height;
+        }
+
+        if(state.edit) {
+            const auto shift = input_backend.get_modifier_key(modifier_key::shift);
+            const auto control = input_backend.get_modifier_key(modifier_key::control);
+            const auto selection_begin = std::min(state.cursor, state.anchor);
+            const auto selection_end = std::max(state.cursor, state.anchor);
+
+            const auto move_to = [&](const size_t pos, const bool vertical = false) {
+                state.cursor = pos;
+                if(!shift)
+                    state.anchor = pos;
+                if(!vertical)
+                    state.preferred_x.reset();
+                moved = true;
+            };
+            const auto move_vertical = [&](const ptrdiff_t delta) {
+                const auto line = static_cast<ptrdiff_t>(buffer.line_of(state.cursor));
+                if(!state.preferred_x.has_value())
+                    state.preferred_x = x_of(state.cursor);
+                const auto target = std::clamp(line + delta, ptrdiff_t{ 0 }, static_cast<ptrdiff_t>(buffer.line_count()) - 1);
+                move_to(position_at(static_cast<size_t>(target), *state.preferred_x), true);
+            };
+            const auto erase = [&](const size_t begin, const size_t end) {
+                buffer.erase(begin, end);
+                state.cursor = state.anchor = begin;
+                state.preferred_x.reset();
+                moved = true;
+            };
+            const auto delete_selected = [&] { erase(selection_begin, selection_end); };
+            const auto insert = [&](const std::string_view text) {
+                delete_selected();
+                buffer.insert(state.cursor, text);
+                move_to(state.cursor + static_cast<size_t>(utf8::distance(text.cbegin(), text.cend())));
+            };
+            const auto copy_selected = [&] {
+                input_backend.set_clipboard_text(buffer.text(selection_begin, selection_end, parent.memory_resource()));
+            };
+
+            const auto dir = input_backend.action_direction_pulse_repeated();
+            const auto page = static_cast<ptrdiff_t>(std::fmax(1.0f, std::floor(view.y / line_height)));
+
+            if(input_backend.get_key_pulse(key_code::back, true)) {
+                erase(selection_begin == selection_end && selection_begin ? selection_begin - 1 : selection_begin, selection_end);
+            } else if(input_backend.get_key_pulse(key_code::delete_, true)) {
+                erase(selection_begin, selection_begin == selection_end ? selection_end + 1 : selection_end);
+            } else if(input_backend.get_key_pulse(key_code::enter, true)) {
+                insert("\n");
+            } else if(std::fabs(-1.0f - dir.x) < 1e-3f) {
+                move_to(selection_begin != selection_end && !shift ? selection_begin : state.cursor ? state.cursor - 1 : 0);
+            } else if(std::fabs(1.0f - dir.x) < 1e-3f) {
+                move_to(selection_begin != selection_end && !shift ? selection_end :
+                                                                     std::min(state.cursor + 1, buffer.size()));
+            } else if(std::fabs(-1.0f - dir.y) < 1e-3f) {
+                move_vertical(-1);
+            } else if(std::fabs(1.0f - dir.y) < 1e-3f) {
+                move_vertical(1);
+            } else if(input_backend.get_key_pulse(key_code::page_up, true)) {
+                move_vertical(-page);
+            } else if(input_backend.get_key_pulse(key_code::page_down, true)) {
+                move_vertical(page);
+            } else if(input_backend.get_key_pulse(key_code::home, false)) {
+                move_to(control ? 0 : buffer.line_begin(buffer.line_of(state.cursor)));
+            } else if(input_backend.get_key_pulse(key_code::end, false)) {
+                move_to(control ? buffer.size() : buffer.line_end(buffer.line_of(state.cursor)));
+            } else if(control && input_backend.get_key_pulse(key_code::alpha_a, false)) {
+                state.anchor = 0;
+                state.cursor = buffer.size();
+                moved = true;
+            } else if(control && selection_begin != selection_end && input_backend.get_key_pulse(key_code::alpha_c, false)) {
+                copy_selected();
+            } else if(control && selection_begin != selection_end && input_backend.get_key_pulse(key_code::alpha_x, false)) {
+                copy_selected();
+                delete_selected();
+            } else if(control && input_backend.get_key_pulse(key_code::alpha_v, false)) {
+                insert(input_backend.get_clipboard_text());
+            } else if(const auto seq = input_backend.get_input_characters(); seq.size()) {
+                std::pmr::string text{ parent.memory_resource() };
+                text.resize(seq.size() * 4);
+                auto iter = text.begin();
+                for(auto cp : seq)
+                    iter = utf8::append(cp, iter);
+                insert({ text.data(), static_cast<size_t>(iter - text.begin()) });
+            }
+        }
+
+        const auto cursor_line = buffer.line_of(state.cursor);
+        // keeps the cursor in view after it has moved
+        if(moved) {
+            const auto top = static_cast<float>(cursor_line) * line_height;
+            state.offset.y = std::fmin(state.offset.y, top);
+            state.offset.y = std::fmax(state.offset.y, top + line_height - view.y);
+            const auto x = x_of(state.cursor);
+            state.offset.x = std::fmin(state.offset.x, x);
+            state.offset.x = std::fmax(state.offset.x, x + style.bounds_edge_width - view.x);
+        }
+        const auto content_height = static_cast<float>(buffer.line_count()) * line_height;
+        state.offset.y = std::fmax(0.0f, std::fmin(state.offset.y, content_height - view.y));
+        state.offset.x = std::fmax(0.0f, state.offset.x);
+
+        parent.add_primitive("background"_id,
+                             canvas_stroke_rect{ full_bounds, state.edit ? style.action.selected : style.action.active,
+                                                 style.bounds_edge_width });
+        parent.push_region("text_region"_id,
+                           bounds_aabb{ style.padding.x, style.padding.x + view.x, style.padding.y, style.padding.y + view.y });
+
+        // only the lines in view are read from the buffer and rendered
+        const auto first_line = line_at(state.offset.y);
+        const auto last_line = line_at(state.offset.y + view.y);
+        const auto selection_begin = std::min(state.cursor, state.anchor);
+        const auto selection_end = std::max(state.cursor, state.anchor);
+        for(auto line = first_line; line <= last_line; ++line) {
+            const auto& [text, xs] = measure(line);
+            const auto begin = buffer.line_begin(line);
+            const auto end = begin + xs.size() - 1;
+            const auto top = static_cast<float>(line) * line_height - state.offset.y;
+
+            if(selection_begin < selection_end && selection_begin <= end && selection_end > begin) {
+                const auto left = xs[std::max(selection_begin, begin) - begin];
+                // the selected '\n' is shown as a space
+                const auto right = selection_end > end ? xs.back() + font.standard_width() : xs[selection_end - begin];
+                parent.add_primitive("selected_background"_id,
+                                     canvas_fill_rect{ bounds_aabb{ left - state.offset.x, right - state.offset.x, top,
+                                                                    top + line_height },
+                                                       style.action.selected });
+            }
+            parent.add_primitive("line"_id,
+                                 canvas_text{ { -state.offset.x, top },
+                                              std::pmr::string{ text.data(), text.size(), parent.memory_resource() },
+                                              style.default_font,
+                                              style.text.primary });
+        }
+
+        if(state.edit) {
+            const auto x = x_of(state.cursor) - state.offset.x;
+            const auto top = static_cast<float>(cursor_line) * line_height - state.offset.y;
+
+            using clock = std::chrono::high_resolution_clock;
+            // ReSharper disable once CppTooWideScope
+            constexpr auto one_second = static_cast<uint64_t>(clock::period::den);
+
+            const auto now = static_cast<uint64_t>(clock::now().time_since_epoch().count());
+            // redraw when the cursor blinks
+            parent.request_redraw(static_cast<float>(one_second / 2 - now % (one_second / 2)) / static_cast<float>(one_second));
+            if(now % one_second > one_second / 2)
+                parent.add_primitive("cursor"_id,
+                                     canvas_line{ { x, top }, { x, top + font.height() }, style.text.primary,
+                                                  style.bounds_edge_width });
+            parent.input().set_input_candidate_window(parent.region_offset() + vec2{ x, top + font.height() * 0.5f });
+        }
+        parent.pop_region();
+        parent.pop_region();
+
+        std::swap(previous, current);
+        current.clear();
+        return committed ? text_edit_status::committed : (state.edit ? text_edit_status::active : text_edit_status::inactive);
+    }
     ANIMGUI_API checkbox_modifier checkbox(canvas& parent, std::pmr::string label, bool& state) {
         const auto id = parent.push_region(parent.region_sub_uid()).second;
         const auto focused = parent.region_request_focus() || parent.region_hovered();
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <animgui/core/render_backend.hpp>
+#include "fallback_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace animgui {
+    // Expands the primitives which the render backend does not support into indexed triangles. Used by the context and by
+    // frame players, whose backend may differ from the one of the captured context.
+    class command_fallback_translator final {
+        primitive_type m_supported_primitive;
+
+        static uint32_t line_count(const primitive_type type, const uint32_t vertices_count) noexcept {
+            switch(type) {
+                case primitive_type::lines:
+                    return vertices_count / 2;
+                case primitive_type::line_strip:
+                    return vertices_count < 2 ? 0 : vertices_count - 1;
+                case primitive_type::line_loop:
+                    return vertices_count < 2 ? 0 : vertices_count;
+                case primitive_type::points:
+                case primitive_type::triangles:
+                case primitive_type::triangle_fan:
+                case primitive_type::triangle_strip:
+                case primitive_type::quads:
+                case primitive_type::quad_instances:
+                    return 0;
+            }
+            return 0;
+        }
+        // the size of the output of a fallback path: (vertices, indices)
+        static std::pair<uint32_t, uint32_t> fallback_size(const primitive_type type, const uint32_t vertices_count) noexcept {
+            switch(type) {
+                case primitive_type::points:
+                    return { vertices_count * 4, vertices_count * 6 };
+                case primitive_type::lines:
+                case primitive_type::line_strip:
+                case primitive_type::line_loop: {
+                    const auto count = line_count(type, vertices_count);
+                    return { count * 4, count * 6 };
+                }
+                case primitive_type::quads:
+                    return { vertices_count / 4 * 4, vertices_count / 4 * 6 };
+                case primitive_type::triangle_fan:
+                case primitive_type::triangle_strip:
+                    return { vertices_count, vertices_count < 3 ? 0 : (vertices_count - 2) * 3 };
+                case primitive_type::triangles:
+                case primitive_type::quad_instances:
+                    return { vertices_count, 0 };
+            }
+            return { vertices_count, 0 };
+        }
+
+        // all fallback paths generate indexed triangles, indices are relative to the first vertex of the command
+        static void fallback_lines(const span<const vertex>& input, vertex* output, uint32_t* indices, const primitive_type type,
+                                   const float line_width) {
+            const auto count = line_count(type, static_cast<uint32_t>(input.size()));
+            if(type == primitive_type::line_loop && count) {
+                fallback_kernels::expand_lines(input.begin(), count - 1, 1, line_width, output);
+                fallback_kernels::expand_line(input[input.size() - 1], input[0], line_width, output + 4 * (count - 1));
+            } else
+                fallback_kernels::expand_lines(input.begin(), count, type == primitive_type::lines ? 2 : 1, line_width,
+                                               output);
+            fallback_kernels::quad_indices(0, count, indices);
+        }
+        static void fallback_points(const span<const vertex>& input, vertex* output, uint32_t* indices, const float point_size) {
+            fallback_kernels::expand_points(input.begin(), input.size(), point_size, output);
+            fallback_kernels::quad_indices(0, input.size(), indices);
+        }
+        static void fallback_quads(const span<const vertex>& input, vertex* output, uint32_t* indices) {
+            const auto count = input.size() / 4;
+            std::copy_n(input.begin(), count * 4, output);
+            fallback_kernels::quad_indices(0, count, indices);
+        }
+        static void fallback_triangle_strip(const span<const vertex>& input, vertex* output, uint32_t* indices) {
+            std::copy(input.begin(), input.end(), output);
+            for(uint32_t i = 2; i < input.size(); ++i, indices += 3) {
+                indices[0] = i;
+                indices[1] = i & 1 ? i - 1 : i - 2;
+                indices[2] = i & 1 ? i - 2 : i - 1;
+            }
+        }
+        static void fallback_triangle_fan(const span<const vertex>& input, vertex* output, uint32_t* indices) {
+            std::copy(input.begin(), input.end(), output);
+            for(uint32_t i = 2; i < input.size(); ++i, indices += 3) {
+                indices[0] = 0;
+                indices[1] = i - 1;
+                indices[2] = i;
+            }
+        }
+        static void fallback_quad_instances(const span<const quad_instance>& input, vertex* output, uint32_t* indices) {
+            for(auto&& [rect, tex_min, tex_max, color] : input) {
+                *output++ = { { rect.left, rect.top }, tex_min, color };
+                *output++ = { { rect.left, rect.bottom }, { tex_min.s, tex_max.t }, color };
+                *output++ = { { rect.right, rect.top }, { tex_max.s, tex_min.t }, color };
+                *output++ = { { rect.right, rect.bottom }, tex_max, color };
+            }
+            fallback_kernels::quad_indices(0, input.size(), indices);
+        }
+
+        // Adjacent instanced quads with the same texture and clip rect are drawn by a single call. Their instances are
+        // contiguous already, so only the commands are merged.
+        static void merge_instances(std::pmr::vector<command>& commands) {
+            const auto same_clip = [](const std::optional<bounds_aabb>& lhs, const std::optional<bounds_aabb>& rhs) {
+                if(!lhs.has_value() || !rhs.has_value())
+                    return lhs.has_value() == rhs.has_value();
+                return lhs->left == rhs->left && lhs->right == rhs->right && lhs->top == rhs->top && lhs->bottom == rhs->bottom;
+            };
+
+            auto last = commands.begin();
+            for(auto iter = commands.begin(); iter != commands.end(); ++iter) {
+                if(last != iter) {
+                    const auto prev = std::get_if<primitives>(&last->desc);
+                    if(const auto cur = std::get_if<primitives>(&iter->desc); prev && cur &&
+                       prev->type == primitive_type::quad_instances && cur->type == primitive_type::quad_instances &&
+                       prev->tex == cur->tex && same_clip(last->clip, iter->clip)) {
+                        prev->instances_count += cur->instances_count;
+                        auto& bounds = last->bounds;
+                        bounds = { std::fmin(bounds.left, iter->bounds.left), std::fmax(bounds.right, iter->bounds.right),
+                                   std::fmin(bounds.top, iter->bounds.top), std::fmax(bounds.bottom, iter->bounds.bottom) };
+                        continue;
+                    }
+                    if(++last != iter)
+                        *last = std::move(*iter);
+                }
+            }
+            if(!commands.empty())
+                commands.erase(last + 1, commands.end());
+        }
+
+    public:
+        explicit command_fallback_translator(const primitive_type supported_primitive)
+            : m_supported_primitive{ supported_primitive } {
+            if(!support_primitive(m_supported_primitive, primitive_type::triangles))
+                throw std::logic_error{ "Unsupported render backend" };
+        }
+
+        void transform(command_queue& command_list) const {
+            const auto memory_resource = command_list.vertices.get_allocator().resource();
+            const auto instancing = support_primitive(m_supported_primitive, primitive_type::quad_instances);
+            if(instancing)
+                merge_instances(command_list.commands);
+
+            // the output size is known before any primitive is expanded
+            size_t output_size = 0, output_indices_size = 0;
+            bool fallback = false;
+            for(auto& [bounds, clip, desc] : command_list.commands)
+                if(const auto primitive = std::get_if<primitives>(&desc)) {
+                    if(primitive->type == primitive_type::quad_instances) {
+                        if(!instancing) {
+                            output_size += primitive->instances_count * 4;
+                            output_indices_size += primitive->instances_count * 6;
+                            fallback = true;
+                        }
+                    } else if(support_primitive(m_supported_primitive, primitive->type)) {
+                        output_size += primitive->vertices_count;
+                        output_indices_size += primitive->indices_count;
+                    } else {
+                        const auto [vertices_count, indices_count] = fallback_size(
+                            primitive->type, primitive->indices_count ? primitive->indices_count : primitive->vertices_count);
+                        output_size += vertices_count;
+                        output_indices_size += indices_count;
+                        fallback = true;
+                    }
+                }
+            if(!fallback)
+                return;
+
+            std::pmr::vector<vertex> output{ output_size, memory_resource };
+            std::pmr::vector<uint32_t> output_indices{ output_indices_size, memory_resource };
+            std::pmr::vector<vertex> expanded{ memory_resource };
+            uint32_t vertices_offset = 0, indices_offset = 0, instances_offset = 0;
+            auto vertices_out = output.data();
+            auto indices_out = output_indices.data();
+
+            for(auto& [bounds, clip, desc] : command_list.commands)
+                if(desc.index() == 1) {
+                    // ReSharper disable once CppTooWideScope
+                    auto&& [type, vertices_count, _, point_line_size, indices_count, instances_count] =
+                        std::get<primitives>(desc);
+                    span<const vertex> old{ command_list.vertices.data() + vertices_offset,
+                                            command_list.vertices.data() + vertices_offset + vertices_count };
+                    const span<const uint32_t> old_indices{ command_list.indices.data() + indices_offset,
+                                                            command_list.indices.data() + indices_offset + indices_count };
+                    vertices_offset += vertices_count;
+                    indices_offset += indices_count;
+
+                    if(type == primitive_type::quad_instances) {
+                        const span<const quad_instance> old_instances{
+                            command_list.instances.data() + instances_offset,
+                            command_list.instances.data() + instances_offset + instances_count
+                        };
+                        instances_offset += instances_count;
+                        if(!instancing) {
+                            fallback_quad_instances(old_instances, vertices_out, indices_out);
+                            vertices_count = instances_count * 4;
+                            indices_count = instances_count * 6;
+                            instances_count = 0;
+                            type = primitive_type::triangles;
+                        }
+                    } else if(!support_primitive(m_supported_primitive, type)) {
+                        if(indices_count) {
+                            expanded.clear();
+                            for(auto idx : old_indices)
+                                expanded.push_back(old[idx]);
+                            old = { expanded.data(), expanded.data() + expanded.size() };
+                        }
+
+                        switch(type) {
+                            case primitive_type::points:
+                                fallback_points(old, vertices_out, indices_out, point_line_size);
+                                break;
+                            case primitive_type::lines:
+                            case primitive_type::line_strip:
+                            case primitive_type::line_loop:
+                                fallback_lines(old, vertices_out, indices_out, type, point_line_size);
+                                break;
+                            case primitive_type::triangle_fan:
+                                fallback_triangle_fan(old, vertices_out, indices_out);
+                                break;
+                            case primitive_type::triangle_strip:
+                                fallback_triangle_strip(old, vertices_out, indices_out);
+                                break;
+                            case primitive_type::quads:
+                                fallback_quads(old, vertices_out, indices_out);
+                                break;
+                            // triangles are always supported and instances are expanded above
+                            case primitive_type::triangles:
+                            case primitive_type::quad_instances:
+                                break;
+                        }
+                        std::tie(vertices_count, indices_count) = fallback_size(type, static_cast<uint32_t>(old.size()));
+                        type = primitive_type::triangles;
+                    } else {
+                        std::copy(old.begin(), old.end(), vertices_out);
+                        std::copy(old_indices.begin(), old_indices.end(), indices_out);
+                    }
+                    vertices_out += vertices_count;
+                    indices_out += indices_count;
+                }
+            command_list.vertices = std::move(output);
+            command_list.indices = std::move(output_indices);
+            if(!instancing)
+                command_list.instances.clear();
+        }
+    };
+}  // namespace animgui
@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: MIT
 
+#include <algorithm>
 #include <animgui/builtins/styles.hpp>
 #include <animgui/core/animator.hpp>
 #include <animgui/core/canvas.hpp>
@@ -10,13 +11,19 @@
 #include <animgui/core/input_backend.hpp>
 #include <animgui/core/statistics.hpp>
 #include <animgui/core/style.hpp>
+#include "command_fallback.hpp"
+#include "overdraw_eliminator.hpp"
 #include <cmath>
 #include <cstring>
 #include <list>
+#include <mutex>
 #include <optional>
 #include <random>
 #include <set>
+#include <shared_mutex>
 #include <stack>
+#include <thread>
+#include <tuple>
 
 namespace animgui {
     class state_manager final {
@@ -109,6 +116,110 @@ namespace animgui {
                     std::forward_as_tuple(m_state_storage.get_allocator().resource(), size, alignment, ctor, dtor));
         }
     };
+    // Keeps every animated value as a channel of 1 (float), 2 (vec2) or 4 (color) consecutive slots in flat arrays. The handle
+    // of a channel is the index of its first slot, so the animator advances all channels in one pass per frame.
+    // Only the channels stepped in the last frame are kept in the arrays, with the moving ones packed in front, so a frame
+    // costs O(live channels) and the animator only visits the moving ones. A channel which was not stepped in the last frame
+    // is retired and starts again at its destination.
+    class animation_engine final {
+        struct channel final {
+            uint32_t handle;  // offset of the values in the arrays
+            uint32_t components;
+            uint64_t last_frame;  // the last frame which stepped the channel
+        };
+        const animator& m_animator;
+        std::pmr::unordered_map<identifier, channel, identifier_hasher> m_channels;
+        // channels stepped in the current frame, in order of first use
+        std::pmr::vector<channel*> m_referenced;
+        std::pmr::vector<float> m_current, m_previous, m_destination;
+        std::pmr::vector<float> m_packed_current, m_packed_destination;
+        uint64_t m_frame;
+        float m_delta_t;
+
+        void pack(const bool moving) {
+            for(const auto item : m_referenced) {
+                const auto current = m_current.data() + item->handle, destination = m_destination.data() + item->handle;
+                if(std::equal(current, current + item->components, destination) == moving)
+                    continue;
+                item->handle = static_cast<uint32_t>(m_packed_current.size());
+                m_packed_current.insert(m_packed_current.end(), current, current + item->components);
+                m_packed_destination.insert(m_packed_destination.end(), destination, destination + item->components);
+            }
+        }
+
+    public:
+        animation_engine(const animator& animator, std::pmr::memory_resource* memory_resource)
+            : m_animator{ animator }, m_channels{ memory_resource }, m_referenced{ memory_resource },
+              m_current{ memory_resource }, m_previous{ memory_resource }, m_destination{ memory_resource },
+              m_packed_current{ memory_resource }, m_packed_destination{ memory_resource }, m_frame{ 0 }, m_delta_t{ 0.0f } {}
+        void reset() {
+            m_channels.clear();
+            m_referenced.clear();
+            m_current.clear();
+            m_previous.clear();
+            m_destination.clear();
+        }
+        void advance(const float delta_t) {
+            m_delta_t = delta_t;
+            m_packed_current.clear();
+            m_packed_destination.clear();
+            pack(true);
+            const auto moving = m_packed_current.size();
+            pack(false);
+            m_current.swap(m_packed_current);
+            m_destination.swap(m_packed_destination);
+            m_previous = m_current;
+            const auto live = m_referenced.size();
+            m_referenced.clear();
+            ++m_frame;
+
+            // retired channels are erased once they outnumber the live ones, so erasing is amortized over the frames
+            if(m_channels.size() > 2 * live + 256) {
+                for(auto iter = m_channels.begin(); iter != m_channels.end();) {
+                    if(iter->second.last_frame + 1 < m_frame)
+                        iter = m_channels.erase(iter);
+                    else
+                        ++iter;
+                }
+            }
+
+            m_animator.step(delta_t, { m_current.data(), m_current.data() + moving },
+                            { m_destination.data(), m_destination.data() + moving });
+        }
+        // Replaces the destination in values with the current value of the channel and returns whether the channel is still
+        // moving. A new destination redoes the step of this frame from the value of the last frame, so the batched pass does
+        // not delay the reaction by one frame.
+        bool step(const identifier uid, float* values, const uint32_t components) {
+            const auto [iter, inserted] = m_channels.emplace(uid, channel{ 0, components, m_frame });
+            auto& item = iter->second;
+            if(!inserted && item.components != components)
+                throw std::logic_error("animation channel size mismatch");
+            if(inserted || item.last_frame + 1 < m_frame) {
+                item.handle = static_cast<uint32_t>(m_current.size());
+                item.last_frame = m_frame;
+                m_referenced.push_back(&item);
+                m_current.insert(m_current.end(), values, values + components);
+                m_previous.insert(m_previous.end(), values, values + components);
+                m_destination.insert(m_destination.end(), values, values + components);
+                return false;
+            }
+            if(item.last_frame != m_frame) {
+                item.last_frame = m_frame;
+                m_referenced.push_back(&item);
+            }
+            const auto handle = item.handle;
+
+            const auto current = m_current.data() + handle;
+            const auto destination = m_destination.data() + handle;
+            if(!std::equal(values, values + components, destination)) {
+                std::copy_n(values, components, destination);
+                std::copy_n(m_previous.data() + handle, components, current);
+                m_animator.step(m_delta_t, { current, current + components }, { destination, destination + components });
+            }
+            std::copy_n(current, components, values);
+            return !std::equal(current, current + components, destination);
+        }
+    };
     struct region_info final {
         size_t push_command_idx;
         identifier uid;
@@ -119,35 +230,46 @@ namespace animgui {
         region_info() = delete;
     };
 
+    // Emits the operations and renders them into target (replaced if it is too small). It is empty if the render backend does
+    // not support offscreen rendering.
+    using offscreen_callback =
+        std::function<texture_region(vec2, std::shared_ptr<texture>, span<operation>, span<const operation_segment>)>;
+
     class canvas_impl final : public canvas {
         context& m_context;
         vec2 m_size;
         float m_delta_t;
         input_backend& m_input_backend;
-        step_function m_step_function;
+        animation_engine& m_animation_engine;
         emitter& m_emitter;
         state_manager& m_state_manager;
+        const offscreen_callback& m_offscreen_callback;
         std::pmr::memory_resource* m_memory_resource;
         input_mode m_input_mode;
         std::pmr::vector<operation> m_commands;
+        // the segments passed to reorder, and the range of each call in them
+        std::pmr::vector<operation_segment> m_reorder_segments;
+        std::pmr::vector<std::pair<size_t, size_t>> m_reorders;
         std::pmr::deque<region_info> m_region_stack;
-        size_t m_animation_state_hash;
         std::pmr::vector<std::pair<identifier, vec2>> m_focusable_region;
+        uint64_t m_redraw_deadline;
+        // the canvas which renders this one as an offscreen layer
+        canvas_impl* m_parent;
 
     public:
-        canvas_impl(context& context, const vec2 size, const float delta_t, input_backend& input, animator& animator,
-                    emitter& emitter, state_manager& state_manager, std::pmr::memory_resource* memory_resource)
+        canvas_impl(context& context, const vec2 size, const float delta_t, input_backend& input,
+                    animation_engine& animation_engine, emitter& emitter, state_manager& state_manager,
+                    const offscreen_callback& offscreen_callback, std::pmr::memory_resource* memory_resource,
+                    const identifier root_uid = identifier{ 0 }, canvas_impl* parent = nullptr)
             : m_context{ context }, m_size{ size }, m_delta_t{ delta_t }, m_input_backend{ input },
-              m_step_function{ animator.step(delta_t) }, m_emitter{ emitter }, m_state_manager{ state_manager },
-              m_memory_resource{ memory_resource }, m_input_mode{ m_input_backend.get_input_mode() },
-              m_commands{ m_memory_resource }, m_region_stack{ m_memory_resource }, m_animation_state_hash{ 0 },
-              m_focusable_region{ memory_resource } {
-            const auto [hash, state_size, alignment] = animator.state_storage();
-            m_animation_state_hash = hash;
-            m_state_manager.register_type(
-                hash, state_size, alignment, [](void*, size_t) {}, [](void*, size_t) {});
+              m_animation_engine{ animation_engine }, m_emitter{ emitter }, m_state_manager{ state_manager },
+              m_offscreen_callback{ offscreen_callback }, m_memory_resource{ memory_resource },
+              m_input_mode{ m_input_backend.get_input_mode() },
+              m_commands{ m_memory_resource }, m_reorder_segments{ m_memory_resource }, m_reorders{ m_memory_resource },
+              m_region_stack{ m_memory_resource }, m_focusable_region{ memory_resource },
+              m_redraw_deadline{ std::numeric_limits<uint64_t>::max() }, m_parent{ parent } {
             m_region_stack.push_back({ std::numeric_limits<size_t>::max(),
-                                       identifier{ 0 },
+                                       root_uid,
                                        std::minstd_rand{},  // NOLINT(cert-msc51-cpp)
                                        bounds_aabb{ 0.0f, size.x, 0.0f, size.y },
                                        { 0.0f, 0.0f } });
@@ -161,6 +283,72 @@ namespace animgui {
         span<operation> commands() noexcept override {
             return { m_commands.data(), m_commands.data() + m_commands.size() };
         }
+        void reorder(const span<const operation_segment> order) override {
+            m_reorders.emplace_back(m_reorder_segments.size(), order.size());
+            m_reorder_segments.insert(m_reorder_segments.cend(), order.begin(), order.end());
+        }
+        // The segments in which the operations are emitted. Enclosing reorders are applied first, then a nested one replaces
+        // its range in the segment holding it, so the cost only depends on the number of segments.
+        [[nodiscard]] std::pmr::vector<operation_segment> operation_order() const {
+            std::pmr::vector<operation_segment> order{ { operation_segment{ 0, m_commands.size() } }, m_memory_resource };
+            if(m_reorders.empty())
+                return order;
+
+            // the range covered by each reorder call
+            std::pmr::vector<std::tuple<size_t, size_t, size_t>> ranges{ m_memory_resource };
+            for(size_t idx = 0; idx < m_reorders.size(); ++idx) {
+                const auto [first, count] = m_reorders[idx];
+                auto begin = std::numeric_limits<size_t>::max();
+                size_t end = 0;
+                for(auto segment = first; segment < first + count; ++segment) {
+                    begin = std::min(begin, m_reorder_segments[segment].begin);
+                    end = std::max(end, m_reorder_segments[segment].end);
+                }
+                if(begin < end)
+                    ranges.emplace_back(begin, end, idx);
+            }
+            std::sort(ranges.begin(), ranges.end(), [](const auto& lhs, const auto& rhs) {
+                return std::get<0>(lhs) < std::get<0>(rhs) ||
+                    (std::get<0>(lhs) == std::get<0>(rhs) && std::get<1>(lhs) > std::get<1>(rhs));
+            });
+
+            std::pmr::vector<operation_segment> next{ m_memory_resource };
+            for(auto&& range : ranges) {
+                const auto begin = std::get<0>(range), end = std::get<1>(range);
+                const auto iter = std::find_if(order.cbegin(), order.cend(), [&](const operation_segment& segment) {
+                    return segment.begin <= begin && end <= segment.end;
+                });
+                // the range crosses segments, so it is not nested in the enclosing reorder
+                if(iter == order.cend())
+                    continue;
+                const auto [first, count] = m_reorders[std::get<2>(range)];
+                const auto segment = *iter;
+                next.assign(order.cbegin(), iter);
+                if(segment.begin < begin)
+                    next.push_back({ segment.begin, begin });
+                next.insert(next.cend(), m_reorder_segments.cbegin() + static_cast<ptrdiff_t>(first),
+                            m_reorder_segments.cbegin() + static_cast<ptrdiff_t>(first + count));
+                if(end < segment.end)
+                    next.push_back({ end, segment.end });
+                next.insert(next.cend(), std::next(iter), order.cend());
+                order.swap(next);
+            }
+            return order;
+        }
+        texture_region render_offscreen(const vec2 size, std::shared_ptr<texture> target,
+                                        const std::function<void(canvas&)>& render_function) override {
+            if(!m_offscreen_callback)
+                return {};
+            // the layer continues the uid chain of the current region, so the content keeps its states when it is moved into
+            // or out of a layer
+            canvas_impl layer{ m_context,       size,           m_delta_t,          m_input_backend,   m_animation_engine,
+                               m_emitter,       m_state_manager, m_offscreen_callback, m_memory_resource, current_region_uid(),
+                               this };
+            render_function(layer);
+            layer.finish();
+            const auto order = layer.operation_order();
+            return m_offscreen_callback(size, std::move(target), layer.commands(), { order.data(), order.data() + order.size() });
+        }
         [[nodiscard]] vec2 reserved_size() const noexcept override {
             for(auto iter = m_region_stack.rbegin(); iter != m_region_stack.rend(); ++iter) {
                 const auto idx = iter->push_command_idx;
@@ -192,8 +380,8 @@ namespace animgui {
         }
         std::pair<size_t, identifier> push_region(const identifier uid, const std::optional<bounds_aabb>& bounds) override {
             const auto idx = m_commands.size();
-            m_commands.push_back(op_push_region{ bounds.value_or(bounds_aabb{ 0.0f, 0.0f, 0.0f, 0.0f }) });
             const auto mixed = mix(current_region_uid(), uid);
+            m_commands.push_back(op_push_region{ bounds.value_or(bounds_aabb{ 0.0f, 0.0f, 0.0f, 0.0f }), mixed });
             auto last_bounds = storage<bounds_aabb>(mix(mixed, "last_bounds"_id));
             const auto& parent = m_region_stack.back();
             const vec2 offset{ last_bounds.left, last_bounds.top };
@@ -221,7 +409,32 @@ namespace animgui {
             return m_memory_resource;
         }
         [[nodiscard]] float step(const identifier id, const float dest) override {
-            return m_step_function(dest, m_animation_state_hash ? raw_storage(m_animation_state_hash, id) : nullptr);
+            auto value = dest;
+            step_channel(id, &value, 1);
+            return value;
+        }
+        [[nodiscard]] vec2 step(const identifier id, const vec2 dest) override {
+            float values[] = { dest.x, dest.y };
+            step_channel(id, values, 2);
+            return { values[0], values[1] };
+        }
+        [[nodiscard]] color_rgba step(const identifier id, const color_rgba& dest) override {
+            float values[] = { dest.r, dest.g, dest.b, dest.a };
+            step_channel(id, values, 4);
+            return { values[0], values[1], values[2], values[3] };
+        }
+        void step_channel(const identifier id, float* values, const uint32_t components) {
+            if(m_animation_engine.step(id, values, components))
+                request_redraw(0.0f);
+        }
+        void request_redraw(const float delay) override {
+            const auto deadline =
+                current_time() + static_cast<uint64_t>(std::fmax(0.0f, delay) * static_cast<float>(clocks_per_second()));
+            m_redraw_deadline = std::min(m_redraw_deadline, deadline);
+        }
+        // the time point when the next frame is needed without any input
+        [[nodiscard]] uint64_t redraw_deadline() const noexcept {
+            return m_redraw_deadline;
         }
         [[nodiscard]] vec2 calculate_bounds(const primitive& primitive) const override {
             return m_emitter.calculate_bounds(primitive, m_context.global_style());
@@ -250,6 +463,15 @@ namespace animgui {
             return last_focus == current;
         }
         void finish() {
+            if(m_parent) {
+                // The layer is drawn at the current region of its parent, so its focusable regions join the focus
+                // navigation of the parent instead of moving the global focus on their own.
+                const auto& bounds = m_parent->m_region_stack.back().absolute_bounds;
+                for(auto&& [id, pos] : m_focusable_region)
+                    m_parent->m_focusable_region.push_back({ id, pos + vec2{ bounds.left, bounds.top } });
+                m_parent->m_redraw_deadline = std::min(m_parent->m_redraw_deadline, m_redraw_deadline);
+                return;
+            }
             // TODO: mode switching
             auto& last_focus = storage<identifier>("glabal_focus"_id);
             if(m_input_mode != input_mode::game_pad || m_focusable_region.empty()) {
@@ -308,9 +530,13 @@ namespace animgui {
     };
 
     // TODO: improve performance
+    // Lookups are safe to run concurrently. Missing glyphs are only rendered on the owner thread (the thread which calls
+    // new_frame, since it owns the render backend), other threads get an empty texture region for them.
     class codepoint_locator final {
         std::pmr::unordered_map<font*, std::pmr::unordered_map<uint32_t, texture_region>> m_lut;
         image_compactor& m_image_compactor;
+        std::shared_mutex m_mutex;
+        std::thread::id m_owner;
 
         std::pmr::unordered_map<uint32_t, texture_region>& locate(font& font_ref) {
             const auto iter = m_lut.find(&font_ref);
@@ -323,11 +549,26 @@ namespace animgui {
 
     public:
         explicit codepoint_locator(image_compactor& image_compactor, std::pmr::memory_resource* memory_resource)
-            : m_lut{ memory_resource }, m_image_compactor{ image_compactor } {}
+            : m_lut{ memory_resource }, m_image_compactor{ image_compactor }, m_owner{ std::this_thread::get_id() } {}
         void reset() {
+            std::unique_lock<std::shared_mutex> guard{ m_mutex };
             m_lut.clear();
         }
+        void set_owner(const std::thread::id owner) noexcept {
+            m_owner = owner;
+        }
         texture_region locate(font& font_ref, const glyph_id glyph) {
+            {
+                std::shared_lock<std::shared_mutex> guard{ m_mutex };
+                if(const auto lut = m_lut.find(&font_ref); lut != m_lut.cend()) {
+                    if(const auto iter = lut->second.find(glyph.idx); iter != lut->second.cend())
+                        return iter->second;
+                }
+            }
+            if(std::this_thread::get_id() != m_owner)
+                return {};
+
+            std::unique_lock<std::shared_mutex> guard{ m_mutex };
             auto&& lut = locate(font_ref);
             const auto iter = lut.find(glyph.idx);
             if(iter == lut.cend()) {
@@ -342,161 +583,6 @@ namespace animgui {
         }
     };
 
-    class command_fallback_translator final {
-        primitive_type m_supported_primitive;
-        primitive_type m_fallback_primitive;
-        void (*m_quad_emitter)(std::pmr::vector<vertex>&, const vertex&, const vertex&, const vertex&, const vertex&);
-
-        // CCW
-        static void emit_triangle(std::pmr::vector<vertex>& vertices, const vertex& p1, const vertex& p2, const vertex& p3) {
-            vertices.push_back(p1);
-            vertices.push_back(p2);
-            vertices.push_back(p3);
-        }
-        static void emit_quad_triangle_strip(std::pmr::vector<vertex>& vertices, const vertex& p1, const vertex& p2,
-                                             const vertex& p3, const vertex& p4) {
-            vertices.push_back(p1);
-            vertices.push_back(p2);
-            vertices.push_back(p4);
-            vertices.push_back(p3);
-        }
-        static void emit_quad_triangles(std::pmr::vector<vertex>& vertices, const vertex& p1, const vertex& p2, const vertex& p3,
-                                        const vertex& p4) {
-            vertices.push_back(p1);
-            vertices.push_back(p2);
-            vertices.push_back(p3);
-            vertices.push_back(p1);
-            vertices.push_back(p3);
-            vertices.push_back(p4);
-        }
-        void emit_line(std::pmr::vector<vertex>& vertices, const vertex& p1, const vertex& p2, const float width) const {
-            auto dx = p1.pos.x - p2.pos.x, dy = p1.pos.y - p2.pos.y;
-            const auto dist = std::hypotf(dx, dy);
-            if(dist < 0.1f)
-                return;
-            const auto scale = 0.5f * width / dist;
-            dx *= scale;
-            dy *= -scale;
-            std::swap(dx, dy);
-            vertex p11 = p1, p12 = p1, p21 = p2, p22 = p2;
-            p11.pos.x += dx;
-            p11.pos.y += dy;
-            p12.pos.x -= dx;
-            p12.pos.y -= dy;
-            p21.pos.x += dx;
-            p21.pos.y += dy;
-            p22.pos.x -= dx;
-            p22.pos.y -= dy;
-            m_quad_emitter(vertices, p11, p21, p22, p12);
-        }
-
-        void fallback_lines_adj(const span<const vertex>& input, std::pmr::vector<vertex>& output, const float line_width,
-                                const bool make_loop) const {
-            for(size_t i = 1; i < input.size(); ++i)
-                emit_line(output, input[i - 1], input[i], line_width);
-            if(make_loop)
-                emit_line(output, input[input.size() - 1], input[0], line_width);
-        }
-        void fallback_lines(const span<const vertex>& input, std::pmr::vector<vertex>& output, const float line_width) const {
-            for(size_t i = 1; i < input.size(); i += 2)
-                emit_line(output, input[i - 1], input[i], line_width);
-        }
-        void fallback_points(const span<const vertex>& input, std::pmr::vector<vertex>& output, const float point_size) const {
-            const auto offset = point_size * 0.5f;
-            for(auto&& p0 : input) {
-                vertex p1 = p0, p2 = p0, p3 = p0, p4 = p0;
-                p1.pos.x -= offset;
-                p1.pos.y -= offset;
-                p2.pos.x -= offset;
-                p2.pos.y += offset;
-                p3.pos.x += offset;
-                p3.pos.y += offset;
-                p4.pos.x += offset;
-                p4.pos.y -= offset;
-                m_quad_emitter(output, p1, p2, p3, p4);
-            }
-        }
-        void fallback_quads(const span<const vertex>& input, std::pmr::vector<vertex>& output) const {
-            for(size_t base = 0; base < input.size(); base += 4)
-                m_quad_emitter(output, input[base], input[base + 1], input[base + 2], input[base + 3]);
-        }
-
-        static void fallback_triangle_strip(const span<const vertex>& input, std::pmr::vector<vertex>& output) {
-            for(size_t i = 2; i < input.size(); ++i) {
-                if(i & 1)
-                    emit_triangle(output, input[i], input[i - 1], input[i - 2]);
-                else
-                    emit_triangle(output, input[i], input[i - 2], input[i - 1]);
-            }
-        }
-
-        static void fallback_triangle_fan(const span<const vertex>& input, std::pmr::vector<vertex>& output) {
-            for(size_t i = 2; i < input.size(); ++i)
-                emit_triangle(output, input[0], input[i - 1], input[i]);
-        }
-
-    public:
-        explicit command_fallback_translator(const primitive_type supported_primitive)
-            : m_supported_primitive{ supported_primitive },
-              m_fallback_primitive{ support_primitive(supported_primitive, primitive_type::triangle_strip) ?
-                                        primitive_type::triangle_strip :
-                                        primitive_type::triangles },
-              m_quad_emitter{ support_primitive(supported_primitive, primitive_type::triangle_strip) ? emit_quad_triangle_strip :
-                                                                                                       emit_quad_triangles } {
-            if(!support_primitive(m_supported_primitive, primitive_type::triangles))
-                throw std::logic_error{ "Unsupported render backend" };
-        }
-
-        void transform(command_queue& command_list) const {
-            uint32_t vertices_offset = 0;
-            std::pmr::vector<vertex> output{ command_list.vertices.get_allocator().resource() };
-            output.reserve(command_list.vertices.size());
-
-            for(auto& [bounds, clip, desc] : command_list.commands)
-                if(desc.index() == 1) {
-                    // ReSharper disable once CppTooWideScope
-                    auto&& [type, vertices_count, _, point_line_size] = std::get<primitives>(desc);
-                    span<const vertex> old{ command_list.vertices.data() + vertices_offset,
-                                            command_list.vertices.data() + vertices_offset + vertices_count };
-                    vertices_offset += vertices_count;
-
-                    if(!support_primitive(m_supported_primitive, type)) {
-                        const auto old_size = output.size();
-
-                        // ReSharper disable once CppDefaultCaseNotHandledInSwitchStatement CppIncompleteSwitchStatement
-                        switch(type) {  // NOLINT(clang-diagnostic-switch)
-                            case primitive_type::points:
-                                fallback_points(old, output, point_line_size);
-                                break;
-                            case primitive_type::lines:
-                                fallback_lines(old, output, point_line_size);
-                                break;
-                            case primitive_type::line_strip:
-                                fallback_lines_adj(old, output, point_line_size, false);
-                                break;
-                            case primitive_type::line_loop:
-                                fallback_lines_adj(old, output, point_line_size, true);
-                                break;
-                            case primitive_type::triangle_fan:
-                                fallback_triangle_fan(old, output);
-                                break;
-                            case primitive_type::triangle_strip:
-                                fallback_triangle_strip(old, output);
-                                break;
-                            case primitive_type::quads:
-                                fallback_quads(old, output);
-                                break;
-                        }
-                        type = m_fallback_primitive;
-                        vertices_count = static_cast<uint32_t>(output.size() - old_size);
-                    } else {
-                        output.insert(output.end(), old.begin(), old.end());
-                    }
-                }
-            command_list.vertices = std::move(output);
-        }
-    };
-
     class smooth_profiler final {
         std::pmr::deque<uint64_t> m_samples;
         uint64_t m_sum;
@@ -519,44 +605,130 @@ namespace animgui {
         }
     };
 
+    // Keeps the last samples sorted to report percentiles.
+    // The samples of the window are also kept sorted. A new sample and the one it evicts are inserted into and erased from
+    // the sorted samples by binary search, rather than sorting the window again in every frame.
+    class latency_distribution final {
+        std::pmr::deque<uint64_t> m_samples;
+        std::pmr::vector<uint64_t> m_sorted;
+
+    public:
+        explicit latency_distribution(std::pmr::memory_resource* memory_resource)
+            : m_samples{ memory_resource }, m_sorted{ memory_resource } {}
+
+        void add_sample(const uint64_t sample) {
+            m_samples.push_back(sample);
+            m_sorted.insert(std::upper_bound(m_sorted.cbegin(), m_sorted.cend(), sample), sample);
+            while(m_samples.size() > 600) {
+                m_sorted.erase(std::lower_bound(m_sorted.cbegin(), m_sorted.cend(), m_samples.front()));
+                m_samples.pop_front();
+            }
+        }
+        // unit: us
+        [[nodiscard]] uint32_t percentile(const double ratio) const {
+            if(m_sorted.empty())
+                return 0;
+            const auto idx =
+                std::min(m_sorted.size() - 1, static_cast<size_t>(ratio * static_cast<double>(m_sorted.size())));
+            return static_cast<uint32_t>(
+                static_cast<double>(m_sorted[idx]) /
+                static_cast<double>(clocks_per_second() / 1'000'000));  // NOLINT(bugprone-integer-division)
+        }
+    };
+
     class context_impl final : public context {
         input_backend& m_input_backend;
         render_backend& m_render_backend;
         font_backend& m_font_backend;
         emitter& m_emitter;
-        animator& m_animator;
         command_optimizer& m_command_optimizer;
         image_compactor& m_image_compactor;
 
         state_manager m_state_manager;
+        animation_engine m_animation_engine;
         codepoint_locator m_codepoint_locator;
+        overdraw_eliminator m_overdraw_eliminator;
         command_fallback_translator m_command_fallback_translator;
         std::pmr::memory_resource* m_memory_resource;
         style m_style;
         pipeline_statistics m_statistics;
         std::pmr::deque<uint64_t> m_frame_time_points;
-        smooth_profiler profiler[7];
+        smooth_profiler profiler[11];
+        latency_distribution m_latency_distribution;
+        offscreen_callback m_offscreen_callback;
+        uint64_t m_redraw_deadline;
+        // the frame whose latency has not been recorded yet
+        uint64_t m_frame_begin, m_frame_event_time, m_last_event_time;
+
+        void record_latency(const uint64_t frame_end) {
+            if(!m_frame_event_time || frame_end < m_frame_begin)
+                return;
+            const auto input_latency = m_frame_begin - std::min(m_frame_event_time, m_frame_begin);
+            const auto render_latency = frame_end - m_frame_begin;
+            m_frame_event_time = 0;
+
+            m_statistics.input_latency = profiler[9].add_sample(input_latency);
+            m_statistics.render_latency = profiler[10].add_sample(render_latency);
+            m_latency_distribution.add_sample(input_latency + render_latency);
+            m_statistics.latency_p50 = m_latency_distribution.percentile(0.5);
+            m_statistics.latency_p90 = m_latency_distribution.percentile(0.9);
+            m_statistics.latency_p99 = m_latency_distribution.percentile(0.99);
+            m_statistics.latency_max = m_latency_distribution.percentile(1.0);
+        }
+        texture_region render_offscreen(const vec2 size, std::shared_ptr<texture> target, const span<operation> operations,
+                                        const span<const operation_segment> order) {
+            const uvec2 pixel_size{ static_cast<uint32_t>(std::ceil(size.x)), static_cast<uint32_t>(std::ceil(size.y)) };
+            if(pixel_size.x == 0 || pixel_size.y == 0)
+                return {};
+            if(!target || target->texture_size().x < pixel_size.x || target->texture_size().y < pixel_size.y)
+                target = m_render_backend.create_texture(pixel_size, channel::rgba);
+
+            auto commands_queue = m_emitter.transform(size, operations, order, m_style,
+                                                      [&](font& font_ref, const glyph_id glyph) -> texture_region {
+                                                          return m_codepoint_locator.locate(font_ref, glyph);
+                                                      });
+            // the same passes as the frame, so layer content looks and costs the same as when it is drawn directly
+            m_overdraw_eliminator.transform(commands_queue);
+            m_command_fallback_translator.transform(commands_queue);
+            m_render_backend.render_to_texture(*target, pixel_size,
+                                               m_command_optimizer.optimize(pixel_size, std::move(commands_queue)));
+
+            const auto [width, height] = target->texture_size();
+            return { std::move(target),
+                     { 0.0f, size.x / static_cast<float>(width), 0.0f, size.y / static_cast<float>(height) } };
+        }
 
     public:
         context_impl(input_backend& input_backend, render_backend& render_backend, font_backend& font_backend, emitter& emitter,
                      animator& animator, command_optimizer& command_optimizer, image_compactor& image_compactor,
                      std::pmr::memory_resource* memory_resource)
             : m_input_backend{ input_backend }, m_render_backend{ render_backend }, m_font_backend{ font_backend },
-              m_emitter{ emitter }, m_animator{ animator }, m_command_optimizer{ command_optimizer },
-              m_image_compactor{ image_compactor }, m_state_manager{ memory_resource }, m_codepoint_locator{ image_compactor,
-                                                                                                             memory_resource },
+              m_emitter{ emitter }, m_command_optimizer{ command_optimizer }, m_image_compactor{ image_compactor },
+              m_state_manager{ memory_resource }, m_animation_engine{ animator, memory_resource },
+              m_codepoint_locator{ image_compactor, memory_resource },
+              m_overdraw_eliminator{},
               m_command_fallback_translator{ render_backend.supported_primitives() & command_optimizer.supported_primitives() },
               m_memory_resource{ memory_resource }, m_style{}, m_statistics{}, m_frame_time_points{ memory_resource }, profiler{
                   smooth_profiler{ memory_resource }, smooth_profiler{ memory_resource }, smooth_profiler{ memory_resource },
                   smooth_profiler{ memory_resource }, smooth_profiler{ memory_resource }, smooth_profiler{ memory_resource },
-                  smooth_profiler{ memory_resource }
-              } {
+                  smooth_profiler{ memory_resource }, smooth_profiler{ memory_resource }, smooth_profiler{ memory_resource },
+                  smooth_profiler{ memory_resource }, smooth_profiler{ memory_resource }
+              },
+              m_latency_distribution{ memory_resource }, m_redraw_deadline{ 0 }, m_frame_begin{ 0 }, m_frame_event_time{ 0 },
+              m_last_event_time{ 0 } {
             set_classic_style(*this);
+            if(m_render_backend.offscreen_supported())
+                m_offscreen_callback = [this](const vec2 size, std::shared_ptr<texture> target, const span<operation> operations,
+                                              const span<const operation_segment> order) {
+                    return render_offscreen(size, std::move(target), operations, order);
+                };
         }
         void reset_cache() override {
             m_state_manager.reset();
+            m_animation_engine.reset();
             m_codepoint_locator.reset();
             m_image_compactor.reset();
+            m_emitter.reset_cache();
         }
         style& global_style() noexcept override {
             return m_style;
@@ -566,6 +738,13 @@ namespace animgui {
             std::pmr::monotonic_buffer_resource arena{ 1 << 15, m_memory_resource };
 
             const auto tp1 = current_time();
+            // the last frame was not presented, so its latency ends with emit
+            record_latency(m_render_backend.emit_finish_time());
+            m_frame_begin = tp1;
+            // a frame drawn without a new input frame (e.g. by the redraw callback of the input backend) has handled no event
+            const auto event_time = m_input_backend.oldest_event_time();
+            m_frame_event_time = event_time != m_last_event_time ? event_time : 0;
+            m_last_event_time = event_time;
             m_frame_time_points.push_back(tp1);
             while(m_frame_time_points.size() > 600)
                 m_frame_time_points.pop_front();
@@ -577,17 +756,28 @@ namespace animgui {
             } else
                 m_statistics.smooth_fps = 0;
 
-            canvas_impl canvas_root{ *this,           vec2{ static_cast<float>(width), static_cast<float>(height) },
-                                     delta_t,         m_input_backend,
-                                     m_animator,      m_emitter,
-                                     m_state_manager, &arena };
+            m_codepoint_locator.set_owner(std::this_thread::get_id());
+            m_animation_engine.advance(delta_t);
+            m_emitter.new_frame();
+            canvas_impl canvas_root{ *this,
+                                     vec2{ static_cast<float>(width), static_cast<float>(height) },
+                                     delta_t,
+                                     m_input_backend,
+                                     m_animation_engine,
+                                     m_emitter,
+                                     m_state_manager,
+                                     m_offscreen_callback,
+                                     &arena };
             render_function(canvas_root);
             canvas_root.finish();
+            m_redraw_deadline = canvas_root.redraw_deadline();
             const auto tp2 = current_time();
             m_statistics.draw_time = profiler[0].add_sample(tp2 - tp1);
             m_statistics.generated_operation = static_cast<uint32_t>(canvas_root.commands().size());
 
-            auto commands_queue = m_emitter.transform(canvas_root.reserved_size(), canvas_root.commands(), m_style,
+            const auto order = canvas_root.operation_order();
+            auto commands_queue = m_emitter.transform(canvas_root.reserved_size(), canvas_root.commands(),
+                                                      { order.data(), order.data() + order.size() }, m_style,
                                                       [&](font& font_ref, const glyph_id glyph) -> texture_region {
                                                           return m_codepoint_locator.locate(font_ref, glyph);
                                                       });
@@ -595,9 +785,13 @@ namespace animgui {
             m_statistics.emit_time = profiler[1].add_sample(tp3 - tp2);
             m_statistics.emitted_draw_call = static_cast<uint32_t>(commands_queue.commands.size());
 
+            std::tie(m_statistics.culled_vertex, m_statistics.culled_pixel) = m_overdraw_eliminator.transform(commands_queue);
+            const auto tp31 = current_time();
+            m_statistics.cull_time = profiler[7].add_sample(tp31 - tp3);
+
             m_command_fallback_translator.transform(commands_queue);
             const auto tp4 = current_time();
-            m_statistics.fallback_time = profiler[2].add_sample(tp4 - tp3);
+            m_statistics.fallback_time = profiler[2].add_sample(tp4 - tp31);
             m_statistics.transformed_draw_call = static_cast<uint32_t>(commands_queue.commands.size());
 
             auto optimized_commands = m_command_optimizer.optimize({ width, height }, std::move(commands_queue));
@@ -607,11 +801,28 @@ namespace animgui {
 
             m_render_backend.update_command_list({ width, height }, std::move(optimized_commands));
 
-            m_statistics.frame_time =
-                profiler[4].add_sample(tp5 - tp1 + m_render_backend.render_time() + m_input_backend.input_time());
+            m_statistics.frame_time = profiler[4].add_sample(tp5 - tp1 + m_render_backend.render_time() +
+                                                             m_render_backend.upload_time() + m_input_backend.input_time());
             m_statistics.render_time = profiler[5].add_sample(m_render_backend.render_time());
+            m_statistics.upload_time = profiler[8].add_sample(m_render_backend.upload_time());
             m_statistics.input_time = profiler[6].add_sample(m_input_backend.input_time());
         }
+        [[nodiscard]] bool needs_redraw() const override {
+            return m_input_backend.events_arrived() || current_time() >= m_redraw_deadline;
+        }
+        bool wait_for_work(const double timeout) override {
+            if(needs_redraw())
+                return true;
+            const auto now = current_time();
+            const auto remaining = now < m_redraw_deadline ?
+                static_cast<double>(m_redraw_deadline - now) / static_cast<double>(clocks_per_second()) :
+                0.0;
+            m_input_backend.wait_events(std::fmin(timeout, remaining));
+            return needs_redraw();
+        }
+        void frame_presented() override {
+            record_latency(current_time());
+        }
         texture_region load_image(const image_desc& image, const float max_scale) override {
             return m_image_compactor.compact(image, max_scale);
         }
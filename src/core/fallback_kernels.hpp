@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <animgui/core/render_backend.hpp>
+#include <cmath>
+#include <cstring>
+
+// Batch kernels used by command_fallback_translator. Define ANIMGUI_NO_SIMD to use the scalar reference implementation.
+#if !defined(ANIMGUI_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ANIMGUI_SIMD_SSE2
+#include <emmintrin.h>
+#elif !defined(ANIMGUI_NO_SIMD) && (defined(__aarch64__) || defined(_M_ARM64))
+#define ANIMGUI_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace animgui::fallback_kernels {
+    // A vertex is exactly one 128-bit register: (pos.x, pos.y, tex_coord, color). Only the first two lanes are ever
+    // modified, the packed attributes are passed through bitwise.
+    static_assert(sizeof(vertex) == 4 * sizeof(float));
+
+#if defined(ANIMGUI_SIMD_SSE2)
+    using f32x4 = __m128;
+    using u32x4 = __m128i;
+
+    inline f32x4 load(const vertex& v) noexcept {
+        return _mm_loadu_ps(reinterpret_cast<const float*>(&v));
+    }
+    inline void store(vertex* ptr, const f32x4 v) noexcept {
+        _mm_storeu_ps(reinterpret_cast<float*>(ptr), v);
+    }
+    inline f32x4 set(const float x, const float y, const float z, const float w) noexcept {
+        return _mm_setr_ps(x, y, z, w);
+    }
+    inline f32x4 splat(const float v) noexcept {
+        return _mm_set1_ps(v);
+    }
+    inline f32x4 add(const f32x4 lhs, const f32x4 rhs) noexcept {
+        return _mm_add_ps(lhs, rhs);
+    }
+    inline f32x4 sub(const f32x4 lhs, const f32x4 rhs) noexcept {
+        return _mm_sub_ps(lhs, rhs);
+    }
+    inline f32x4 mul(const f32x4 lhs, const f32x4 rhs) noexcept {
+        return _mm_mul_ps(lhs, rhs);
+    }
+    inline f32x4 div(const f32x4 lhs, const f32x4 rhs) noexcept {
+        return _mm_div_ps(lhs, rhs);
+    }
+    inline f32x4 max(const f32x4 lhs, const f32x4 rhs) noexcept {
+        return _mm_max_ps(lhs, rhs);
+    }
+    inline f32x4 sqrt(const f32x4 v) noexcept {
+        return _mm_sqrt_ps(v);
+    }
+    // lhs < rhs ? a : b
+    inline f32x4 select_less(const f32x4 lhs, const f32x4 rhs, const f32x4 a, const f32x4 b) noexcept {
+        const auto mask = _mm_cmplt_ps(lhs, rhs);
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+    // (v.x + delta.x, v.y + delta.y, v.z, v.w)
+    inline f32x4 offset_pos(const f32x4 v, const f32x4 delta) noexcept {
+        return _mm_shuffle_ps(_mm_add_ps(v, delta), v, _MM_SHUFFLE(3, 2, 1, 0));
+    }
+    inline void transpose(f32x4& r0, f32x4& r1, f32x4& r2, f32x4& r3) noexcept {
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    }
+    inline u32x4 set_u32(const uint32_t x, const uint32_t y, const uint32_t z, const uint32_t w) noexcept {
+        return _mm_setr_epi32(static_cast<int>(x), static_cast<int>(y), static_cast<int>(z), static_cast<int>(w));
+    }
+    inline u32x4 splat_u32(const uint32_t v) noexcept {
+        return _mm_set1_epi32(static_cast<int>(v));
+    }
+    inline u32x4 add_u32(const u32x4 lhs, const u32x4 rhs) noexcept {
+        return _mm_add_epi32(lhs, rhs);
+    }
+    inline void store_u32(uint32_t* ptr, const u32x4 v) noexcept {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), v);
+    }
+#elif defined(ANIMGUI_SIMD_NEON)
+    using f32x4 = float32x4_t;
+    using u32x4 = uint32x4_t;
+
+    inline f32x4 load(const vertex& v) noexcept {
+        return vld1q_f32(reinterpret_cast<const float*>(&v));
+    }
+    inline void store(vertex* ptr, const f32x4 v) noexcept {
+        vst1q_f32(reinterpret_cast<float*>(ptr), v);
+    }
+    inline f32x4 set(const float x, const float y, const float z, const float w) noexcept {
+        const float data[4] = { x, y, z, w };
+        return vld1q_f32(data);
+    }
+    inline f32x4 splat(const float v) noexcept {
+        return vdupq_n_f32(v);
+    }
+    inline f32x4 add(const f32x4 lhs, const f32x4 rhs) noexcept {
+        return vaddq_f32(lhs, rhs);
+    }
+    inline f32x4 sub(const f32x4 lhs, const f32x4 rhs) noexcept {
+        return vsubq_f32(lhs, rhs);
+    }
+    inline f32x4 mul(const f32x4 lhs, const f32x4 rhs) noexcept {
+        return vmulq_f32(lhs, rhs);
+    }
+    inline f32x4 div(const f32x4 lhs, const f32x4 rhs) noexcept {
+        return vdivq_f32(lhs, rhs);
+    }
+    inline f32x4 max(const f32x4 lhs, const f32x4 rhs) noexcept {
+        return vmaxq_f32(lhs, rhs);
+    }
+    inline f32x4 sqrt(const f32x4 v) noexcept {
+        return vsqrtq_f32(v);
+    }
+    inline f32x4 select_less(const f32x4 lhs, const f32x4 rhs, const f32x4 a, const f32x4 b) noexcept {
+        return vbslq_f32(vcltq_f32(lhs, rhs), a, b);
+    }
+    inline f32x4 offset_pos(const f32x4 v, const f32x4 delta) noexcept {
+        return vcombine_f32(vadd_f32(vget_low_f32(v), vget_low_f32(delta)), vget_high_f32(v));
+    }
+    inline void transpose(f32x4& r0, f32x4& r1, f32x4& r2, f32x4& r3) noexcept {
+        const auto t0 = vzipq_f32(r0, r2), t1 = vzipq_f32(r1, r3);
+        const auto u0 = vzipq_f32(t0.val[0], t1.val[0]), u1 = vzipq_f32(t0.val[1], t1.val[1]);
+        r0 = u0.val[0];
+        r1 = u0.val[1];
+        r2 = u1.val[0];
+        r3 = u1.val[1];
+    }
+    inline u32x4 set_u32(const uint32_t x, const uint32_t y, const uint32_t z, const uint32_t w) noexcept {
+        const uint32_t data[4] = { x, y, z, w };
+        return vld1q_u32(data);
+    }
+    inline u32x4 splat_u32(const uint32_t v) noexcept {
+        return vdupq_n_u32(v);
+    }
+    inline u32x4 add_u32(const u32x4 lhs, const u32x4 rhs) noexcept {
+        return vaddq_u32(lhs, rhs);
+    }
+    inline void store_u32(uint32_t* ptr, const u32x4 v) noexcept {
+        vst1q_u32(ptr, v);
+    }
+#endif
+
+    // lines shorter than this are emitted as zero-area quads, so that the output size only depends on the input size
+    constexpr float min_line_length = 0.1f;
+
+    // scalar reference, writes 4 vertices (CCW)
+    inline void expand_line(const vertex& p1, const vertex& p2, const float line_width, vertex* output) noexcept {
+        const auto dx = p1.pos.x - p2.pos.x, dy = p1.pos.y - p2.pos.y;
+        const auto dist = std::sqrt(dx * dx + dy * dy);
+        const auto scale = dist < min_line_length ? 0.0f : 0.5f * line_width / dist;
+        const auto ox = -dy * scale, oy = dx * scale;
+        output[0] = output[3] = p1;
+        output[1] = output[2] = p2;
+        output[0].pos = { p1.pos.x + ox, p1.pos.y + oy };
+        output[1].pos = { p2.pos.x + ox, p2.pos.y + oy };
+        output[2].pos = { p2.pos.x - ox, p2.pos.y - oy };
+        output[3].pos = { p1.pos.x - ox, p1.pos.y - oy };
+    }
+
+    // segment i is (input[i * stride], input[i * stride + 1]), writes 4 vertices per segment
+    inline void expand_lines(const vertex* input, const size_t count, const size_t stride, const float line_width,
+                             vertex* output) noexcept {
+        size_t i = 0;
+#if defined(ANIMGUI_SIMD_SSE2) || defined(ANIMGUI_SIMD_NEON)
+        const auto half_width = splat(0.5f * line_width), min_length = splat(min_line_length), zero = splat(0.0f);
+        for(; i + 4 <= count; i += 4, output += 16) {
+            const auto* seg = input + i * stride;
+            f32x4 a[4], b[4];
+            for(size_t k = 0; k < 4; ++k) {
+                a[k] = load(seg[k * stride]);
+                b[k] = load(seg[k * stride + 1]);
+            }
+            // SoA: (x1, y1), (x2, y2) of 4 segments
+            auto x1 = a[0], y1 = a[1], z1 = a[2], w1 = a[3];
+            transpose(x1, y1, z1, w1);
+            auto x2 = b[0], y2 = b[1], z2 = b[2], w2 = b[3];
+            transpose(x2, y2, z2, w2);
+
+            const auto dx = sub(x1, x2), dy = sub(y1, y2);
+            const auto dist = sqrt(add(mul(dx, dx), mul(dy, dy)));
+            const auto scale = select_less(dist, min_length, zero, div(half_width, max(dist, min_length)));
+            // back to AoS: delta k is (ox, oy, 0, 0) of segment k
+            auto ox = sub(zero, mul(dy, scale)), oy = mul(dx, scale), oz = zero, ow = zero;
+            transpose(ox, oy, oz, ow);
+            const f32x4 delta[4] = { ox, oy, oz, ow };
+
+            for(size_t k = 0; k < 4; ++k) {
+                const auto neg = sub(zero, delta[k]);
+                store(output + 4 * k, offset_pos(a[k], delta[k]));
+                store(output + 4 * k + 1, offset_pos(b[k], delta[k]));
+                store(output + 4 * k + 2, offset_pos(b[k], neg));
+                store(output + 4 * k + 3, offset_pos(a[k], neg));
+            }
+        }
+#endif
+        for(; i < count; ++i, output += 4)
+            expand_line(input[i * stride], input[i * stride + 1], line_width, output);
+    }
+
+    // writes 4 vertices (CCW) per point
+    inline void expand_points(const vertex* input, const size_t count, const float point_size, vertex* output) noexcept {
+        const auto offset = point_size * 0.5f;
+#if defined(ANIMGUI_SIMD_SSE2) || defined(ANIMGUI_SIMD_NEON)
+        const f32x4 delta[4] = { set(-offset, -offset, 0.0f, 0.0f), set(-offset, offset, 0.0f, 0.0f),
+                                 set(offset, offset, 0.0f, 0.0f), set(offset, -offset, 0.0f, 0.0f) };
+        for(size_t i = 0; i < count; ++i, output += 4) {
+            const auto v = load(input[i]);
+            for(size_t k = 0; k < 4; ++k)
+                store(output + k, offset_pos(v, delta[k]));
+        }
+#else
+        const vec2 delta[4] = { { -offset, -offset }, { -offset, offset }, { offset, offset }, { offset, -offset } };
+        for(size_t i = 0; i < count; ++i, output += 4) {
+            for(size_t k = 0; k < 4; ++k) {
+                output[k] = input[i];
+                output[k].pos = input[i].pos + delta[k];
+            }
+        }
+#endif
+    }
+
+    // writes 6 indices (b, b + 1, b + 2, b, b + 2, b + 3) per quad, where b = first + 4 * i
+    inline void quad_indices(uint32_t first, const size_t count, uint32_t* output) noexcept {
+        size_t i = 0;
+#if defined(ANIMGUI_SIMD_SSE2) || defined(ANIMGUI_SIMD_NEON)
+        // two quads per iteration: (0, 1, 2, 0), (2, 3, 4, 5), (6, 4, 6, 7)
+        const u32x4 pattern[3] = { set_u32(0, 1, 2, 0), set_u32(2, 3, 4, 5), set_u32(6, 4, 6, 7) };
+        for(; i + 2 <= count; i += 2, first += 8, output += 12) {
+            const auto base = splat_u32(first);
+            store_u32(output, add_u32(base, pattern[0]));
+            store_u32(output + 4, add_u32(base, pattern[1]));
+            store_u32(output + 8, add_u32(base, pattern[2]));
+        }
+#endif
+        for(; i < count; ++i, first += 4, output += 6) {
+            output[0] = output[3] = first;
+            output[1] = first + 1;
+            output[2] = output[4] = first + 2;
+            output[5] = first + 3;
+        }
+    }
+}  // namespace animgui::fallback_kernels
@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <animgui/core/render_backend.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory_resource>
+#include <tuple>
+#include <vector>
+
+namespace animgui {
+    // Drops or trims commands which are hidden behind later opaque, untextured and axis-aligned rectangles.
+    class overdraw_eliminator final {
+        static bool contains(const bounds_aabb& outer, const bounds_aabb& inner) noexcept {
+            return outer.left <= inner.left && outer.right >= inner.right && outer.top <= inner.top &&
+                outer.bottom >= inner.bottom;
+        }
+        static float area(const bounds_aabb& bounds) noexcept {
+            return (bounds.right - bounds.left) * (bounds.bottom - bounds.top);
+        }
+        // quads generated by the emitter: a single quad instance covering the bounds of the command
+        static bool is_rect(const primitives& desc, const bounds_aabb& bounds, const quad_instance* instances) noexcept {
+            if(desc.type != primitive_type::quad_instances || desc.instances_count != 1)
+                return false;
+            return instances->rect.left == bounds.left && instances->rect.right == bounds.right &&
+                instances->rect.top == bounds.top && instances->rect.bottom == bounds.bottom;
+        }
+        static bool is_opaque(const primitives& desc, const quad_instance* instances) noexcept {
+            return !desc.tex && instances->color.a == std::numeric_limits<uint8_t>::max();
+        }
+        // quad instances count as four vertices
+        static uint32_t vertices_of(const primitives& desc) noexcept {
+            return desc.vertices_count + desc.instances_count * 4;
+        }
+        // shrink the rect to the part which is not covered by the occluder
+        static bool trim(bounds_aabb& rect, const bounds_aabb& occluder) noexcept {
+            if(occluder.left <= rect.left && occluder.right >= rect.right) {
+                if(occluder.top <= rect.top && occluder.bottom > rect.top) {
+                    rect.top = occluder.bottom;
+                    return true;
+                }
+                if(occluder.bottom >= rect.bottom && occluder.top < rect.bottom) {
+                    rect.bottom = occluder.top;
+                    return true;
+                }
+            }
+            if(occluder.top <= rect.top && occluder.bottom >= rect.bottom) {
+                if(occluder.left <= rect.left && occluder.right > rect.left) {
+                    rect.left = occluder.right;
+                    return true;
+                }
+                if(occluder.right >= rect.right && occluder.left < rect.right) {
+                    rect.right = occluder.left;
+                    return true;
+                }
+            }
+            return false;
+        }
+        static void update_rect(quad_instance& instance, const bounds_aabb& new_rect) noexcept {
+            const auto& old_rect = instance.rect;
+            const auto base = unpack_tex_coord(instance.tex_min), end = unpack_tex_coord(instance.tex_max);
+            const auto scale_s = (end.x - base.x) / (old_rect.right - old_rect.left);
+            const auto scale_t = (end.y - base.y) / (old_rect.bottom - old_rect.top);
+            const auto s0 = base.x + (new_rect.left - old_rect.left) * scale_s,
+                       s1 = base.x + (new_rect.right - old_rect.left) * scale_s,
+                       t0 = base.y + (new_rect.top - old_rect.top) * scale_t,
+                       t1 = base.y + (new_rect.bottom - old_rect.top) * scale_t;
+            instance.tex_min = pack_tex_coord({ s0, t0 });
+            instance.tex_max = pack_tex_coord({ s1, t1 });
+            instance.rect = new_rect;
+        }
+
+        // Occluders bucketed into a uniform grid over the bounds of the frame. A rect only tests the occluders of the cells
+        // it overlaps rather than every occluder, and containment only needs the cell of its top-left corner, which every
+        // occluder containing the rect also covers.
+        class occluder_grid final {
+            static constexpr size_t grid_size = 32;
+            bounds_aabb m_extent;
+            vec2 m_cells_per_unit;
+            std::pmr::vector<bounds_aabb> m_occluders;
+            std::pmr::vector<std::pmr::vector<uint32_t>> m_cells;
+            // the query which last visited an occluder, so that occluders spanning several cells are visited once
+            std::pmr::vector<uint32_t> m_visited;
+            uint32_t m_query = 0;
+
+            static float cells_per_unit(const float length) noexcept {
+                return length > 0.0f && std::isfinite(length) ? static_cast<float>(grid_size) / length : 0.0f;
+            }
+            // NaN and infinite coordinates are clamped into the border cells
+            static size_t cell_of(const float pos, const float base, const float scale) noexcept {
+                const auto idx = std::fmin(std::fmax((pos - base) * scale, 0.0f), static_cast<float>(grid_size - 1));
+                return static_cast<size_t>(idx);
+            }
+            [[nodiscard]] std::tuple<size_t, size_t, size_t, size_t> cell_range(const bounds_aabb& rect) const noexcept {
+                return { cell_of(rect.left, m_extent.left, m_cells_per_unit.x),
+                         cell_of(rect.right, m_extent.left, m_cells_per_unit.x),
+                         cell_of(rect.top, m_extent.top, m_cells_per_unit.y),
+                         cell_of(rect.bottom, m_extent.top, m_cells_per_unit.y) };
+            }
+
+        public:
+            occluder_grid(const bounds_aabb& extent, std::pmr::memory_resource* memory_resource)
+                : m_extent{ extent }, m_cells_per_unit{ cells_per_unit(extent.right - extent.left),
+                                                        cells_per_unit(extent.bottom - extent.top) },
+                  m_occluders{ memory_resource }, m_cells(grid_size * grid_size, memory_resource),
+                  m_visited{ memory_resource } {}
+
+            void clear() {
+                if(m_occluders.empty())
+                    return;
+                m_occluders.clear();
+                m_visited.clear();
+                for(auto&& cell : m_cells)
+                    cell.clear();
+            }
+            void add(const bounds_aabb& rect) {
+                const auto idx = static_cast<uint32_t>(m_occluders.size());
+                m_occluders.push_back(rect);
+                m_visited.push_back(m_query);
+                const auto [x0, x1, y0, y1] = cell_range(rect);
+                for(auto y = y0; y <= y1; ++y)
+                    for(auto x = x0; x <= x1; ++x)
+                        m_cells[y * grid_size + x].push_back(idx);
+            }
+            [[nodiscard]] bool covers(const bounds_aabb& rect) const noexcept {
+                const auto range = cell_range(rect);
+                const auto& cell = m_cells[std::get<2>(range) * grid_size + std::get<0>(range)];
+                return std::any_of(cell.cbegin(), cell.cend(),
+                                   [&](const uint32_t idx) { return contains(m_occluders[idx], rect); });
+            }
+            // Calls func for each occluder which may overlap rect until it returns true.
+            template <typename Callable>
+            bool any_overlapping(const bounds_aabb& rect, Callable&& func) {
+                ++m_query;
+                const auto [x0, x1, y0, y1] = cell_range(rect);
+                for(auto y = y0; y <= y1; ++y)
+                    for(auto x = x0; x <= x1; ++x)
+                        for(const auto idx : m_cells[y * grid_size + x]) {
+                            if(m_visited[idx] == m_query)
+                                continue;
+                            m_visited[idx] = m_query;
+                            if(func(m_occluders[idx]))
+                                return true;
+                        }
+                return false;
+            }
+        };
+
+    public:
+        // returns (culled vertices, culled pixels)
+        std::pair<uint32_t, uint32_t> transform(command_queue& command_list) const {
+            const auto memory_resource = command_list.vertices.get_allocator().resource();
+            const auto size = command_list.commands.size();
+
+            // (vertices, indices, instances)
+            std::pmr::vector<std::tuple<uint32_t, uint32_t, uint32_t>> offsets{ memory_resource };
+            offsets.reserve(size);
+            uint32_t vertices_offset = 0, indices_offset = 0, instances_offset = 0;
+            bounds_aabb extent{ std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(),
+                                std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest() };
+            for(auto& [bounds, clip, desc] : command_list.commands) {
+                offsets.emplace_back(vertices_offset, indices_offset, instances_offset);
+                if(std::isfinite(bounds.left) && std::isfinite(bounds.right) && std::isfinite(bounds.top) &&
+                   std::isfinite(bounds.bottom)) {
+                    extent.left = std::fmin(extent.left, bounds.left);
+                    extent.right = std::fmax(extent.right, bounds.right);
+                    extent.top = std::fmin(extent.top, bounds.top);
+                    extent.bottom = std::fmax(extent.bottom, bounds.bottom);
+                }
+                if(const auto primitive = std::get_if<primitives>(&desc)) {
+                    vertices_offset += primitive->vertices_count;
+                    indices_offset += primitive->indices_count;
+                    instances_offset += primitive->instances_count;
+                }
+            }
+
+            std::pmr::vector<bool> culled(size, false, memory_resource);
+            occluder_grid occluders{ extent, memory_resource };
+            size_t culled_commands = 0;
+            uint32_t culled_vertices = 0;
+            double culled_pixels = 0.0;
+
+            for(auto idx = size; idx-- > 0;) {
+                auto& [bounds, clip, desc] = command_list.commands[idx];
+                const auto primitive = std::get_if<primitives>(&desc);
+                if(!primitive) {
+                    // native callbacks may draw anything or change the render state
+                    occluders.clear();
+                    continue;
+                }
+
+                const auto instances = command_list.instances.data() + std::get<2>(offsets[idx]);
+                auto visible = bounds;
+                if(clip.has_value() && !clip_bounds(visible, { 0.0f, 0.0f }, clip.value())) {
+                    culled[idx] = true;
+                    ++culled_commands;
+                    culled_vertices += vertices_of(*primitive);
+                    continue;
+                }
+
+                if(occluders.covers(visible)) {
+                    culled[idx] = true;
+                    ++culled_commands;
+                    culled_vertices += vertices_of(*primitive);
+                    culled_pixels += area(visible);
+                    continue;
+                }
+
+                if(!is_rect(*primitive, bounds, instances))
+                    continue;
+
+                if(!clip.has_value()) {
+                    auto rect = bounds;
+                    bool covered = false;
+                    for(bool trimmed = true; trimmed && !covered;) {
+                        trimmed = false;
+                        covered = occluders.any_overlapping(rect, [&](const bounds_aabb& occluder) {
+                            if(contains(occluder, rect))
+                                return true;
+                            trimmed |= trim(rect, occluder);
+                            return false;
+                        });
+                    }
+                    if(covered) {
+                        culled[idx] = true;
+                        ++culled_commands;
+                        culled_vertices += vertices_of(*primitive);
+                        culled_pixels += area(bounds);
+                        continue;
+                    }
+                    if(rect.left != bounds.left || rect.right != bounds.right || rect.top != bounds.top ||
+                       rect.bottom != bounds.bottom) {
+                        culled_pixels += area(bounds) - area(rect);
+                        update_rect(*instances, rect);
+                        bounds = visible = rect;
+                    }
+                }
+
+                if(is_opaque(*primitive, instances) && !occluders.covers(visible))
+                    occluders.add(visible);
+            }
+
+            if(culled_commands == 0)
+                return { 0, static_cast<uint32_t>(culled_pixels) };
+
+            std::pmr::vector<vertex> vertices{ memory_resource };
+            vertices.reserve(command_list.vertices.size());
+            std::pmr::vector<uint32_t> indices{ memory_resource };
+            indices.reserve(command_list.indices.size());
+            std::pmr::vector<quad_instance> instances{ memory_resource };
+            instances.reserve(command_list.instances.size());
+            std::pmr::vector<command> commands{ memory_resource };
+            commands.reserve(size - culled_commands);
+
+            for(size_t idx = 0; idx < size; ++idx) {
+                if(culled[idx])
+                    continue;
+                auto& cmd = command_list.commands[idx];
+                if(const auto primitive = std::get_if<primitives>(&cmd.desc)) {
+                    const auto [vertices_offset, indices_offset, instances_offset] = offsets[idx];
+                    const auto beg = command_list.vertices.cbegin() + vertices_offset;
+                    vertices.insert(vertices.cend(), beg, beg + primitive->vertices_count);
+                    const auto beg_indices = command_list.indices.cbegin() + indices_offset;
+                    indices.insert(indices.cend(), beg_indices, beg_indices + primitive->indices_count);
+                    const auto beg_instances = command_list.instances.cbegin() + instances_offset;
+                    instances.insert(instances.cend(), beg_instances, beg_instances + primitive->instances_count);
+                }
+                commands.push_back(std::move(cmd));
+            }
+
+            command_list.vertices = std::move(vertices);
+            command_list.indices = std::move(indices);
+            command_list.instances = std::move(instances);
+            command_list.commands = std::move(commands);
+            return { culled_vertices, static_cast<uint32_t>(culled_pixels) };
+        }
+    };
+}  // namespace animgui
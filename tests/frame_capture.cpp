@@ -0,0 +1,228 @@
+// SPDX-License-Identifier: MIT
+
+// Captures random command lists which change a little from frame to frame, replays them and checks that every frame comes
+// back unchanged. Inserting or removing a command in a long command list must not resend the commands after it.
+
+#include <animgui/builtins/command_optimizers.hpp>
+#include <animgui/builtins/frame_capture.hpp>
+#include <animgui/core/command_optimizer.hpp>
+#include <animgui/core/render_backend.hpp>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+using namespace animgui;
+
+namespace {
+    class sized_texture final : public texture {
+        uvec2 m_size;
+
+    public:
+        explicit sized_texture(const uvec2 size) : m_size{ size } {}
+        void update_texture(uvec2, const image_desc&) override {}
+        void generate_mipmap() override {}
+        [[nodiscard]] uvec2 texture_size() const noexcept override {
+            return m_size;
+        }
+        [[nodiscard]] channel channels() const noexcept override {
+            return channel::rgba;
+        }
+        [[nodiscard]] uint64_t native_handle() const noexcept override {
+            return 0;
+        }
+    };
+
+    // Keeps the last command list.
+    class recording_backend final : public render_backend {
+    public:
+        command_queue last;
+
+        void update_command_list(uvec2, command_queue command_list) override {
+            last = std::move(command_list);
+        }
+        std::shared_ptr<texture> create_texture(const uvec2 size, channel) override {
+            return std::make_shared<sized_texture>(size);
+        }
+        std::shared_ptr<texture> create_texture_from_native_handle(uint64_t, const uvec2 size, channel) override {
+            return std::make_shared<sized_texture>(size);
+        }
+        void emit(uvec2) override {}
+        [[nodiscard]] uint64_t render_time() const noexcept override {
+            return 0;
+        }
+        [[nodiscard]] primitive_type supported_primitives() const noexcept override {
+            return primitive_type::points | primitive_type::lines | primitive_type::line_strip | primitive_type::line_loop |
+                primitive_type::triangles | primitive_type::triangle_fan | primitive_type::triangle_strip |
+                primitive_type::quads | primitive_type::quad_instances;
+        }
+    };
+
+    // A command with the vertices, indices and instances it draws.
+    struct element final {
+        command cmd;
+        std::vector<vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<quad_instance> instances;
+    };
+
+    float random_float(std::mt19937& rng) {
+        return std::uniform_real_distribution<float>{ 0.0f, 1000.0f }(rng);
+    }
+
+    element random_element(std::mt19937& rng, const std::vector<std::shared_ptr<texture>>& textures) {
+        const auto kind = rng() % 8;
+        const bounds_aabb bounds{ random_float(rng), random_float(rng), random_float(rng), random_float(rng) };
+        if(kind == 0)
+            return { command{ bounds, std::nullopt, native_callback{ [] {} } }, {}, {}, {} };
+        const auto tex = rng() % 3 == 0 ? textures[rng() % textures.size()] : nullptr;
+        if(kind < 4) {
+            // the replay merges adjacent instances with the same texture and clip rect, so each command has its own clip
+            element res{ command{ bounds, bounds, primitives{ primitive_type::quad_instances, 0, tex, 0.0f, 0, 0 } },
+                         {},
+                         {},
+                         {} };
+            const auto count = 1 + rng() % 4;
+            for(uint32_t idx = 0; idx < count; ++idx)
+                res.instances.push_back({ bounds, { static_cast<uint16_t>(rng()), 0 }, { 0, 0 },
+                                          { 0, 0, 0, static_cast<uint8_t>(rng()) } });
+            std::get<primitives>(res.cmd.desc).instances_count = count;
+            return res;
+        }
+        std::optional<bounds_aabb> clip;
+        if(rng() % 2)
+            clip = bounds;
+        element res{ command{ bounds, clip, primitives{ primitive_type::triangles, 0, tex, 0.0f, 0, 0 } }, {}, {}, {} };
+        const auto count = 3 * (1 + rng() % 10);
+        for(uint32_t idx = 0; idx < count; ++idx)
+            res.vertices.push_back({ { random_float(rng), random_float(rng) }, {}, { 0, 0, 0, 255 } });
+        auto& desc = std::get<primitives>(res.cmd.desc);
+        desc.vertices_count = count;
+        if(rng() % 2) {
+            for(uint32_t idx = 0; idx < count; ++idx)
+                res.indices.push_back(count - 1 - idx);
+            desc.indices_count = count;
+        }
+        return res;
+    }
+
+    command_queue build_queue(const std::vector<element>& elements) {
+        const auto memory_resource = std::pmr::get_default_resource();
+        command_queue queue{ std::pmr::vector<vertex>{ memory_resource }, std::pmr::vector<command>{ memory_resource },
+                             std::pmr::vector<uint32_t>{ memory_resource },
+                             std::pmr::vector<quad_instance>{ memory_resource } };
+        for(auto&& [cmd, vertices, indices, instances] : elements) {
+            queue.commands.push_back(cmd);
+            queue.vertices.insert(queue.vertices.cend(), vertices.cbegin(), vertices.cend());
+            queue.indices.insert(queue.indices.cend(), indices.cbegin(), indices.cend());
+            queue.instances.insert(queue.instances.cend(), instances.cbegin(), instances.cend());
+        }
+        return queue;
+    }
+
+    template <typename T>
+    bool same_buffer(const std::pmr::vector<T>& lhs, const std::pmr::vector<T>& rhs) {
+        return lhs.size() == rhs.size() && (lhs.empty() || std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0);
+    }
+
+    // Textures are told apart by their sizes.
+    bool same_queue(const command_queue& lhs, const command_queue& rhs) {
+        if(!same_buffer(lhs.vertices, rhs.vertices) || !same_buffer(lhs.indices, rhs.indices) ||
+           !same_buffer(lhs.instances, rhs.instances) || lhs.commands.size() != rhs.commands.size())
+            return false;
+        for(size_t idx = 0; idx < lhs.commands.size(); ++idx) {
+            auto &&lhs_cmd = lhs.commands[idx], &&rhs_cmd = rhs.commands[idx];
+            if(std::memcmp(&lhs_cmd.bounds, &rhs_cmd.bounds, sizeof(bounds_aabb)) != 0 ||
+               lhs_cmd.clip.has_value() != rhs_cmd.clip.has_value() ||
+               (lhs_cmd.clip.has_value() && std::memcmp(&*lhs_cmd.clip, &*rhs_cmd.clip, sizeof(bounds_aabb)) != 0) ||
+               lhs_cmd.desc.index() != rhs_cmd.desc.index())
+                return false;
+            const auto lhs_desc = std::get_if<primitives>(&lhs_cmd.desc);
+            const auto rhs_desc = std::get_if<primitives>(&rhs_cmd.desc);
+            if(!lhs_desc)
+                continue;
+            if(lhs_desc->type != rhs_desc->type || lhs_desc->vertices_count != rhs_desc->vertices_count ||
+               lhs_desc->indices_count != rhs_desc->indices_count || lhs_desc->instances_count != rhs_desc->instances_count ||
+               lhs_desc->point_line_size != rhs_desc->point_line_size || !lhs_desc->tex != !rhs_desc->tex)
+                return false;
+            if(lhs_desc->tex && lhs_desc->tex->texture_size() != rhs_desc->tex->texture_size())
+                return false;
+        }
+        return true;
+    }
+}  // namespace
+
+int main() {
+    std::mt19937 rng{ 20211 };  // NOLINT(cert-msc51-cpp)
+    std::stringstream stream{ std::ios::in | std::ios::out | std::ios::binary };
+    recording_backend capture_target;
+    std::vector<command_queue> frames;
+    {
+        const auto capture_backend = create_capture_render_backend(capture_target, stream);
+        std::vector<std::shared_ptr<texture>> textures;
+        for(uint32_t size = 1; size <= 3; ++size)
+            textures.push_back(capture_backend->create_texture({ size, size }, channel::rgba));
+
+        std::vector<element> elements;
+        for(int frame = 0; frame < 500; ++frame) {
+            for(auto changes = rng() % 4; changes > 0; --changes) {
+                const auto op = rng() % 5;
+                if(op == 0 || elements.size() < 10)
+                    elements.insert(elements.begin() + static_cast<std::ptrdiff_t>(rng() % (elements.size() + 1)),
+                                    random_element(rng, textures));
+                else if(op == 1)
+                    elements.erase(elements.begin() + static_cast<std::ptrdiff_t>(rng() % elements.size()));
+                else if(op == 2)
+                    std::swap(elements[rng() % elements.size()], elements[rng() % elements.size()]);
+                else if(op == 3)
+                    elements[rng() % elements.size()] = random_element(rng, textures);
+                else if(auto& vertices = elements[rng() % elements.size()].vertices; !vertices.empty())
+                    vertices[rng() % vertices.size()].pos.x += 1.0f;
+            }
+            frames.push_back(build_queue(elements));
+            capture_backend->update_command_list({ 800, 600 }, build_queue(elements));
+            capture_backend->emit({ 800, 600 });
+        }
+
+        // one command inserted before and removed after a thousand unchanged ones
+        elements.clear();
+        for(int idx = 0; idx < 1000; ++idx)
+            elements.push_back(random_element(rng, textures));
+        size_t sizes[3];
+        for(auto& size : sizes) {
+            const auto begin = stream.tellp();
+            frames.push_back(build_queue(elements));
+            capture_backend->update_command_list({ 800, 600 }, build_queue(elements));
+            capture_backend->emit({ 800, 600 });
+            size = static_cast<size_t>(stream.tellp() - begin);
+            if(elements.size() == 1000)
+                elements.insert(elements.begin(), random_element(rng, textures));
+            else
+                elements.erase(elements.begin());
+        }
+        std::printf("frame sizes: %zu, %zu after an insertion, %zu after a removal\n", sizes[0], sizes[1], sizes[2]);
+        if(sizes[1] > 1024 || sizes[2] > 1024) {
+            std::puts("unchanged commands are resent");
+            return 1;
+        }
+    }
+
+    recording_backend replay_target;
+    const auto command_optimizer = create_noop_command_optimizer();
+    const auto frame_player = create_frame_player(stream, replay_target, *command_optimizer);
+    for(size_t idx = 0; idx < frames.size(); ++idx) {
+        if(!frame_player->replay_frame()) {
+            std::printf("frame %zu is missing\n", idx);
+            return 1;
+        }
+        if(!same_queue(frames[idx], replay_target.last)) {
+            std::printf("frame %zu changed\n", idx);
+            return 1;
+        }
+    }
+    if(frame_player->replay_frame()) {
+        std::puts("unexpected frame");
+        return 1;
+    }
+    return 0;
+}
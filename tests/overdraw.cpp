@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: MIT
+
+// Rasterizes random frames before and after overdraw elimination and checks that every pixel is unchanged, including
+// under clip rects, translucent and textured commands and native callbacks.
+
+#include "../src/core/overdraw_eliminator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace animgui;
+
+namespace {
+    constexpr int frame_size = 128;
+
+    class dummy_texture final : public texture {
+    public:
+        void update_texture(uvec2, const image_desc&) override {}
+        void generate_mipmap() override {}
+        [[nodiscard]] uvec2 texture_size() const noexcept override {
+            return { 1, 1 };
+        }
+        [[nodiscard]] channel channels() const noexcept override {
+            return channel::rgba;
+        }
+        [[nodiscard]] uint64_t native_handle() const noexcept override {
+            return 0;
+        }
+    };
+
+    struct pixel final {
+        float r, g, b, a;
+    };
+
+    // Commands are drawn as their bounds, which is exact for the rects generated below. Textured rects sample their
+    // texture coordinates, so trimming a rect must keep the coordinates of its remaining pixels, and textures are
+    // translucent, so they never hide anything.
+    std::vector<pixel> rasterize(const command_queue& queue) {
+        std::vector<pixel> frame(frame_size * frame_size, pixel{ 0.0f, 0.0f, 0.0f, 0.0f });
+        size_t vertices_offset = 0, instances_offset = 0;
+        for(auto&& [bounds, clip, desc] : queue.commands) {
+            const auto primitive = std::get_if<primitives>(&desc);
+            if(!primitive)
+                continue;
+            const auto draw = [&](const bounds_aabb& rect, const packed_color color, const quad_instance* instance) {
+                for(int y = 0; y < frame_size; ++y)
+                    for(int x = 0; x < frame_size; ++x) {
+                        const auto px = static_cast<float>(x) + 0.5f, py = static_cast<float>(y) + 0.5f;
+                        if(px < rect.left || px >= rect.right || py < rect.top || py >= rect.bottom)
+                            continue;
+                        if(clip.has_value() && (px < clip->left || px >= clip->right || py < clip->top || py >= clip->bottom))
+                            continue;
+                        pixel src{ color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f };
+                        if(primitive->tex && instance) {
+                            const auto base = unpack_tex_coord(instance->tex_min), end = unpack_tex_coord(instance->tex_max);
+                            src.r *= base.x + (end.x - base.x) * (px - rect.left) / (rect.right - rect.left);
+                            src.g *= base.y + (end.y - base.y) * (py - rect.top) / (rect.bottom - rect.top);
+                            src.a *= 0.75f;
+                        }
+                        auto& dst = frame[y * frame_size + x];
+                        dst = { src.r * src.a + dst.r * (1.0f - src.a), src.g * src.a + dst.g * (1.0f - src.a),
+                                src.b * src.a + dst.b * (1.0f - src.a), src.a + dst.a * (1.0f - src.a) };
+                    }
+            };
+            if(primitive->type == primitive_type::quad_instances) {
+                for(uint32_t idx = 0; idx < primitive->instances_count; ++idx) {
+                    auto&& instance = queue.instances[instances_offset + idx];
+                    draw(instance.rect, instance.color, &instance);
+                }
+            } else
+                draw(bounds, queue.vertices[vertices_offset].color, nullptr);
+            vertices_offset += primitive->vertices_count;
+            instances_offset += primitive->instances_count;
+        }
+        return frame;
+    }
+
+    command_queue random_frame(std::mt19937& rng, const std::vector<std::shared_ptr<texture>>& textures, const size_t count) {
+        const auto memory_resource = std::pmr::get_default_resource();
+        command_queue queue{ std::pmr::vector<vertex>{ memory_resource }, std::pmr::vector<command>{ memory_resource },
+                             std::pmr::vector<uint32_t>{ memory_resource },
+                             std::pmr::vector<quad_instance>{ memory_resource } };
+        const auto coord = [&] { return static_cast<float>(std::uniform_int_distribution<int>{ -16, frame_size + 16 }(rng)); };
+        const auto random_rect = [&] {
+            auto x0 = coord(), x1 = coord(), y0 = coord(), y1 = coord();
+            if(x0 > x1)
+                std::swap(x0, x1);
+            if(y0 > y1)
+                std::swap(y0, y1);
+            return bounds_aabb{ x0, x1 + 1.0f, y0, y1 + 1.0f };
+        };
+        const auto random_color = [&] {
+            const auto channel = [&] { return static_cast<uint8_t>(rng() % 256); };
+            return packed_color{ channel(), channel(), channel(), rng() % 2 ? uint8_t{ 255 } : channel() };
+        };
+
+        for(size_t idx = 0; idx < count; ++idx) {
+            const auto kind = rng() % 20;
+            if(kind == 0) {
+                queue.commands.push_back(command{ { 0.0f, 0.0f, 0.0f, 0.0f }, std::nullopt, native_callback{ [] {} } });
+                continue;
+            }
+            std::optional<bounds_aabb> clip;
+            if(rng() % 4 == 0)
+                clip = random_rect();
+            const auto tex = rng() % 4 == 0 ? textures[rng() % textures.size()] : nullptr;
+            if(kind < 4) {
+                // two triangles covering the bounds
+                const auto rect = random_rect();
+                const auto color = random_color();
+                for(auto [x, y] : { std::pair{ rect.left, rect.top }, std::pair{ rect.right, rect.top },
+                                    std::pair{ rect.left, rect.bottom }, std::pair{ rect.right, rect.top },
+                                    std::pair{ rect.right, rect.bottom }, std::pair{ rect.left, rect.bottom } })
+                    queue.vertices.push_back({ { x, y }, { 0, 0 }, color });
+                queue.commands.push_back(command{ rect, clip, primitives{ primitive_type::triangles, 6, nullptr, 0.0f } });
+                continue;
+            }
+            // a single rect, which may be trimmed, or several which are only culled as a whole
+            const uint32_t instances_count = kind < 6 ? 2 : 1;
+            bounds_aabb bounds{ std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(),
+                                std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest() };
+            for(uint32_t i = 0; i < instances_count; ++i) {
+                const auto rect = random_rect();
+                queue.instances.push_back(
+                    { rect, pack_tex_coord({ 0.1f, 0.2f }), pack_tex_coord({ 0.9f, 0.7f }), random_color() });
+                bounds = { std::fmin(bounds.left, rect.left), std::fmax(bounds.right, rect.right),
+                           std::fmin(bounds.top, rect.top), std::fmax(bounds.bottom, rect.bottom) };
+            }
+            queue.commands.push_back(
+                command{ bounds, clip, primitives{ primitive_type::quad_instances, 0, tex, 0.0f, 0, instances_count } });
+        }
+        return queue;
+    }
+}  // namespace
+
+int main() {
+    std::mt19937 rng{ 20211 };  // NOLINT(cert-msc51-cpp)
+    const std::vector<std::shared_ptr<texture>> textures{ std::make_shared<dummy_texture>(),
+                                                          std::make_shared<dummy_texture>() };
+    const overdraw_eliminator eliminator;
+    uint32_t culled_vertices = 0, culled_pixels = 0;
+    for(int round = 0; round < 300; ++round) {
+        auto queue = random_frame(rng, textures, 1 + rng() % 64);
+        const auto expected = rasterize(queue);
+        const auto [vertices, pixels] = eliminator.transform(queue);
+        culled_vertices += vertices;
+        culled_pixels += pixels;
+        const auto actual = rasterize(queue);
+        for(size_t idx = 0; idx < expected.size(); ++idx) {
+            const auto &lhs = expected[idx], &rhs = actual[idx];
+            if(std::fabs(lhs.r - rhs.r) > 1e-3f || std::fabs(lhs.g - rhs.g) > 1e-3f || std::fabs(lhs.b - rhs.b) > 1e-3f ||
+               std::fabs(lhs.a - rhs.a) > 1e-3f) {
+                std::printf("round %d: pixel (%d, %d) changed\n", round, static_cast<int>(idx % frame_size),
+                            static_cast<int>(idx / frame_size));
+                return 1;
+            }
+        }
+    }
+    if(culled_vertices == 0 || culled_pixels == 0) {
+        std::puts("nothing was culled");
+        return 1;
+    }
+
+    // A frame of many small opaque rects must not cost commands * occluders.
+    auto queue = random_frame(rng, textures, 0);
+    for(uint32_t idx = 0; idx < 50000; ++idx) {
+        const auto x = static_cast<float>(idx % 250 * 8), y = static_cast<float>(idx / 250 * 8);
+        queue.instances.push_back({ { x, x + 6.0f, y, y + 6.0f }, {}, {}, { 255, 255, 255, 255 } });
+        queue.commands.push_back(command{ queue.instances.back().rect, std::nullopt,
+                                          primitives{ primitive_type::quad_instances, 0, nullptr, 0.0f, 0, 1 } });
+    }
+    const auto start = std::chrono::steady_clock::now();
+    (void)eliminator.transform(queue);
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu commands: %.2f ms\n", queue.commands.size(), elapsed * 1000.0);
+    if(elapsed > 1.0) {
+        std::puts("overdraw elimination is too slow");
+        return 1;
+    }
+    return 0;
+}
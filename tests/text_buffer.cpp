@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: MIT
+
+// Applies random edits to a text buffer and to a plain string and compares every query. The treap must stay balanced,
+// both when a large document is loaded and when typing splits the same chunk over and over.
+
+#include "../src/builtins/text_buffer_impl.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace animgui;
+
+namespace {
+    // the byte offset of codepoint pos
+    size_t model_offset(const std::string& str, size_t pos) {
+        size_t offset = 0;
+        for(; offset < str.size(); ++offset)
+            if(!is_continuation(str[offset]) && pos-- == 0)
+                break;
+        return offset;
+    }
+
+    std::string random_text(std::mt19937& rng, const size_t count) {
+        static const char* const pieces[] = { "a", "b", " ", "\n", "\xC3\xA9", "\xE4\xB8\xAD", "\xF0\x9F\x98\x80" };
+        std::string res;
+        for(size_t idx = 0; idx < count; ++idx)
+            res += pieces[rng() % std::size(pieces)];
+        return res;
+    }
+
+    bool check(const text_buffer_impl& buffer, const std::string& model, std::mt19937& rng, const bool full) {
+        const auto size = count_codepoints(model);
+        const auto lines = count_lines(model) + 1;
+        if(buffer.size() != size || buffer.line_count() != lines)
+            return false;
+        for(int round = 0; round < 2; ++round) {
+            const auto line = rng() % (lines + 1);
+            size_t begin = 0;
+            for(size_t idx = 0, pos = 0, found = 0; found < line && idx < model.size(); ++idx) {
+                if(is_continuation(model[idx]))
+                    continue;
+                ++pos;
+                if(model[idx] == '\n' && ++found == line)
+                    begin = pos;
+            }
+            if(line >= lines)
+                begin = size;
+            if(buffer.line_begin(line) != begin)
+                return false;
+            const auto pos = rng() % (size + 1);
+            if(buffer.line_of(pos) != count_lines(std::string_view{ model }.substr(0, model_offset(model, pos))))
+                return false;
+            const auto first = rng() % (size + 1), last = first + rng() % 64;
+            const auto begin_offset = model_offset(model, first);
+            const auto expected = std::string_view{ model }.substr(begin_offset, model_offset(model, last) - begin_offset);
+            if(std::string_view{ buffer.text(first, last, std::pmr::get_default_resource()) } != expected)
+                return false;
+        }
+        return !full || std::string_view{ buffer.text(0, size, std::pmr::get_default_resource()) } == model;
+    }
+}  // namespace
+
+int main() {
+    std::mt19937 rng{ 20211 };  // NOLINT(cert-msc51-cpp)
+    {
+        std::string model = random_text(rng, 3000);
+        text_buffer_impl buffer{ model };
+        for(int round = 0; round < 5000; ++round) {
+            const auto size = count_codepoints(model);
+            const auto version = buffer.version();
+            if(rng() % 3 != 0) {
+                const auto pos = rng() % (size + 1);
+                // mostly typing, sometimes a paste larger than a chunk
+                const auto str = random_text(rng, rng() % 50 == 0 ? 800 : 1 + rng() % 8);
+                buffer.insert(pos, str);
+                model.insert(model_offset(model, pos), str);
+            } else {
+                const auto begin = rng() % (size + 1);
+                const auto end = begin + (rng() % 20 == 0 ? rng() % 2000 : rng() % 16);
+                const auto first = model_offset(model, begin);
+                buffer.erase(begin, end);
+                model.erase(first, model_offset(model, end) - first);
+            }
+            if(buffer.version() == version && count_codepoints(model) != size) {
+                std::printf("round %d: the version was not bumped\n", round);
+                return 1;
+            }
+            if(!check(buffer, model, rng, round % 100 == 0)) {
+                std::printf("round %d: the buffer differs from the model\n", round);
+                return 1;
+            }
+        }
+    }
+
+    // A chain would be as deep as the number of chunks, a treap is about three times log2 of it.
+    const auto max_depth = [](const size_t chunks) {
+        return static_cast<size_t>(4.0 * std::log2(static_cast<double>(chunks) + 1.0)) + 4;
+    };
+    {
+        const std::string document(8 << 20, 'x');
+        const text_buffer_impl buffer{ document };
+        const auto chunks = document.size() / (max_chunk_size / 2);
+        std::printf("loaded %zu chunks, depth %zu\n", chunks, buffer.depth());
+        if(buffer.depth() > max_depth(chunks)) {
+            std::puts("loading a document unbalances the treap");
+            return 1;
+        }
+    }
+    {
+        text_buffer_impl buffer{ "" };
+        // every max_chunk_size / 2 characters split the chunk under the cursor
+        for(size_t idx = 0; idx < (1 << 18); ++idx)
+            buffer.insert(idx % 7 == 0 ? idx / 2 : idx, "y");
+        const auto chunks = buffer.size() / (max_chunk_size / 2);
+        std::printf("typed %zu chunks, depth %zu\n", chunks, buffer.depth());
+        if(buffer.depth() > max_depth(chunks)) {
+            std::puts("typing unbalances the treap");
+            return 1;
+        }
+    }
+    return 0;
+}